@@ -1,10 +1,10 @@
 set(wxWEAVER_INCLUDE_FILES
     external/stacktrace/stack.hpp
-    external/md5/md5.hh
     src/codegen/codegen.h
     src/codegen/codeparser.h
     src/codegen/codewriter.h
     src/codegen/cppcg.h
+    src/codegen/dependencies.h
     src/codegen/luacg.h
     src/codegen/phpcg.h
     src/codegen/pythoncg.h
@@ -43,29 +43,35 @@ set(wxWEAVER_INCLUDE_FILES
     src/gui/mainframe.h
     src/rtti/database.h
     src/rtti/objectbase.h
+    src/rtti/snapshot.h
     src/rtti/types.h
     src/utils/debug.h
     src/utils/defs.h
     src/utils/exception.h
     src/utils/filetocarray.h
+    src/utils/fileutils.h
     src/utils/ipc.h
     src/utils/stringutils.h
     src/utils/typeconv.h
     src/appdata.h
+    src/benchmark.h
     src/cmdproc.h
+    src/converter.h
     src/dataobject.h
     src/event.h
+    src/generator.h
     src/manager.h
     src/settings.h
+    src/watcher.h
     src/xrcloader.h
 )
 set(wxWEAVER_SOURCE_FILES
     external/stacktrace/stack.cpp
-    external/md5/md5.cc
     src/codegen/codegen.cpp
     src/codegen/codeparser.cpp
     src/codegen/codewriter.cpp
     src/codegen/cppcg.cpp
+    src/codegen/dependencies.cpp
     src/codegen/luacg.cpp
     src/codegen/phpcg.cpp
     src/codegen/pythoncg.cpp
@@ -102,18 +108,24 @@ set(wxWEAVER_SOURCE_FILES
     src/gui/mainframe.cpp
     src/rtti/database.cpp
     src/rtti/objectbase.cpp
+    src/rtti/snapshot.cpp
     src/rtti/types.cpp
     src/utils/filetocarray.cpp
+    src/utils/fileutils.cpp
     src/utils/ipc.cpp
     src/utils/m_wxweaver.cpp
     src/utils/stringutils.cpp
     src/utils/typeconv.cpp
     src/appdata.cpp
+    src/benchmark.cpp
     src/cmdproc.cpp
+    src/converter.cpp
     src/dataobject.cpp
     src/event.cpp
+    src/generator.cpp
     src/manager.cpp
     src/settings.cpp
+    src/watcher.cpp
     src/wxweaver.cpp
     src/xrcloader.cpp
 )
@@ -194,8 +206,20 @@ if(UNIX AND NOT APPLE)
     target_link_libraries(${CMAKE_PROJECT_NAME} dl)
 endif()
 
+if(wxWEAVER_BENCHMARK_ALLOCATIONS)
+    target_compile_definitions(${CMAKE_PROJECT_NAME} PRIVATE wxWEAVER_BENCHMARK_ALLOCATIONS)
+endif()
+
 target_copy_translation(${CMAKE_PROJECT_NAME} "it")
 
+# Code generation benchmark: cmake --build <build dir> --target benchmark
+add_custom_target(benchmark
+    COMMAND ${CMAKE_PROJECT_NAME} --benchmark
+        $<$<BOOL:${wxWEAVER_BENCHMARK_SIZE}>:--benchmark-size=${wxWEAVER_BENCHMARK_SIZE}>
+    USES_TERMINAL
+)
+add_dependencies(benchmark ${CMAKE_PROJECT_NAME} ${wxWeaverPlugins})
+
 # Installation
 if (UNIX AND NOT APPLE)
     include(GNUInstallDirs)
@@ -0,0 +1,59 @@
+# Tests: cmake -DwxWEAVER_BUILD_TESTS=ON, then ctest --test-dir <build dir>
+set(wxWEAVER_TEST_FILES
+    tests/codeparser.cpp
+    tests/main.cpp
+    tests/savefile.cpp
+    tests/snapshot.cpp
+    tests/templates.cpp
+    tests/testing.h
+    tests/typeconv.cpp
+)
+# The tests run on the application sources, without its entry point
+set(wxWEAVER_TESTED_FILES ${wxWEAVER_SOURCE_FILES})
+list(REMOVE_ITEM wxWEAVER_TESTED_FILES src/wxweaver.cpp)
+
+add_executable(wxweaver_tests
+    ${wxWEAVER_INCLUDE_FILES}
+    ${wxWEAVER_TESTED_FILES}
+    ${wxWEAVER_TEST_FILES}
+)
+set_target_properties(wxweaver_tests PROPERTIES
+    RUNTIME_OUTPUT_DIRECTORY "${CMAKE_BINARY_DIR}/bin"
+)
+target_include_directories(wxweaver_tests PRIVATE
+    "external"
+    "sdk/plugin_interface"
+    "src"
+    "tests"
+)
+target_link_libraries(wxweaver_tests
+    ${wxWidgets_LIBRARIES}
+    sdk::ticpp
+    sdk::plugin_interface
+)
+if(UNIX AND NOT APPLE)
+    target_link_libraries(wxweaver_tests dl)
+endif()
+add_dependencies(wxweaver_tests ${wxWeaverPlugins})
+
+if(UNIX AND NOT APPLE)
+    set(wxWEAVER_TEST_DATA_DIR "${CMAKE_BINARY_DIR}/share/wxweaver")
+else()
+    set(wxWEAVER_TEST_DATA_DIR "${CMAKE_CURRENT_SOURCE_DIR}/resources/application")
+endif()
+
+# Every test runs in its own process: wxweaver_tests <test> <data dir> <source dir>
+set(wxWEAVER_TESTS
+    CodeParserMatchesLegacy
+    CodeParserProgress
+    FontCodeNames
+    SaveFileByteIdentical
+    SnapshotRoundTrip
+    TemplateNested
+    WriteFileAtomically
+)
+foreach(test ${wxWEAVER_TESTS})
+    add_test(NAME ${test}
+        COMMAND wxweaver_tests ${test} "${wxWEAVER_TEST_DATA_DIR}" "${CMAKE_CURRENT_SOURCE_DIR}"
+    )
+endforeach()
@@ -30,9 +30,11 @@
 #include "codegen/phpcg.h"
 #include "codegen/pythoncg.h"
 #include "rtti/objectbase.h"
+#include "rtti/snapshot.h"
 #include "utils/stringutils.h"
 #include "utils/typeconv.h"
 #include "utils/exception.h"
+#include "utils/fileutils.h"
 #include "utils/ipc.h"
 #include "dataobject.h"
 #include "gui/dialogs/xrcpreview.h"
@@ -51,6 +53,9 @@
 #include <wx/richmsgdlg.h>
 #include <wx/tokenzr.h>
 
+#include <chrono>
+#include <mutex>
+
 using namespace TypeConv;
 
 const char* const VERSION = "0.1.0"; // TODO: Move this to CMake
@@ -390,6 +395,9 @@ void ReparentObjectCmd::DoRestore()
 }
 
 ApplicationData* ApplicationData::s_instance = nullptr;
+thread_local PObjectBase ApplicationData::s_threadProject;
+thread_local wxString ApplicationData::s_threadProjectFile;
+thread_local wxString ApplicationData::s_threadProjectPath;
 
 ApplicationData* ApplicationData::Get(const wxString& rootdir)
 {
@@ -407,10 +415,12 @@ void ApplicationData::Destroy()
     s_instance = nullptr;
 }
 
-void ApplicationData::Initialize()
+void ApplicationData::Initialize(bool headless)
 {
     ApplicationData* appData = ApplicationData::Get();
-    appData->LoadApp();
+    appData->LoadApp(headless);
+    if (headless)
+        return;
     /*
         Use the color of a dominant text to determine if dark mode should be used.
         TODO: Depending on the used theme it is not clear which color that is,
@@ -427,6 +437,10 @@ ApplicationData::ApplicationData(const wxString& rootdir)
     , m_objDb(new ObjectDatabase())
     , m_manager(new wxWeaverManager)
     , m_ipc(new wxWeaverIPC)
+    , m_autosaveBusy(false)
+    , m_changeCount(0)
+    , m_autosaveCount(0)
+    , m_savedHash(0)
 #ifdef wxWEAVER_DEBUG
     , m_log(nullptr)
     , m_debug(nullptr)
@@ -456,15 +470,22 @@ ApplicationData::ApplicationData(const wxString& rootdir)
 
 ApplicationData::~ApplicationData()
 {
+    if (m_autosaveThread.joinable())
+        m_autosaveThread.join();
+
 #ifdef wxWEAVER_DEBUG
     delete wxLog::SetActiveTarget(m_log);
 #endif
 }
 
-void ApplicationData::LoadApp()
+void ApplicationData::LoadApp(bool headless)
 {
-    wxString bitmapPath = m_objDb->GetXmlPath() + "icons.xml";
-    AppBitmaps::LoadBitmaps(bitmapPath, m_objDb->GetIconPath());
+    if (headless) {
+        m_objDb->SetLoadIcons(false);
+    } else {
+        wxString bitmapPath = m_objDb->GetXmlPath() + "icons.xml";
+        AppBitmaps::LoadBitmaps(bitmapPath, m_objDb->GetIconPath());
+    }
     m_objDb->LoadObjectTypes();
     m_objDb->LoadPlugins(m_manager);
 }
@@ -511,9 +532,33 @@ PObjectBase ApplicationData::GetSelectedForm()
 
 PObjectBase ApplicationData::GetProjectData()
 {
+    if (s_threadProject)
+        return s_threadProject;
+
     return m_project;
 }
 
+const wxString& ApplicationData::GetProjectPath()
+{
+    if (s_threadProject)
+        return s_threadProjectPath;
+
+    return m_projectPath;
+}
+
+void ApplicationData::SetThreadProject(PObjectBase project, const wxString& file)
+{
+    s_threadProject = project;
+    s_threadProjectFile = project ? file.Clone() : wxString();
+    s_threadProjectPath = project ? ::wxPathOnly(file) : wxString();
+}
+
+PObjectBase ApplicationData::GetThreadProject(wxString* file)
+{
+    *file = s_threadProjectFile.Clone();
+    return s_threadProject;
+}
+
 void ApplicationData::BuildNameSet(PObjectBase obj, PObjectBase top,
                                    std::set<wxString>& nameSet)
 {
@@ -1079,10 +1124,34 @@ void ApplicationData::SaveProject(const wxString& filename)
         return;
     }
     try {
-        ticpp::Document doc;
-        m_project->Serialize(&doc);
-        doc.SaveFile(std::string(filename.mb_str(wxConvFile)));
+        const bool binary = ProjectSnapshot::HasSnapshotExtension(filename);
+        std::string data;
+        if (binary) {
+            data = ProjectSnapshot::Serialize(m_project);
+        } else {
+            ticpp::Document doc;
+            m_project->Serialize(&doc);
+            data = XMLUtils::PrintDocument(doc);
+        }
+        // Saving an unchanged project must not touch the file,
+        // file watchers and build steps depend on its timestamp
+        const uint64_t hash = FileUtils::Hash(data);
+        const wxULongLong size = wxFileName::GetSize(filename);
+        const bool unchanged = (hash == m_savedHash && filename == m_savedFile
+                                && size != wxInvalidSize && size == data.size());
+        if (!unchanged) {
+            if (!FileUtils::WriteFileAtomically(data, filename)) {
+                m_savedFile.clear();
+                wxWEAVER_THROW_EX("Unable to save the project " << filename)
+            }
+            // Not fatal, the next load will just read the XML file
+            if (!binary && !ProjectSnapshot::SaveCache(m_project, filename))
+                LogDebug("Unable to write the project cache for %s", filename);
+        }
+        m_savedFile = filename;
+        m_savedHash = hash;
 
+        DiscardRecoveryFile();
         m_projectFile = filename;
         SetProjectPath(::wxPathOnly(filename));
         m_modFlag = false;
@@ -1106,6 +1175,53 @@ bool ApplicationData::LoadProject(const wxString& file, bool justGenerate)
     if (!justGenerate) {
         if (!m_ipc->VerifySingleInstance(file))
             return false;
+
+        // The recovery copy of the current project is only discarded once the
+        // new one is loaded, a pending autosave of the same file finishes first
+        if (m_autosaveThread.joinable())
+            m_autosaveThread.join();
+
+        const wxString recoveryFile = GetRecoveryFileName(file);
+        if (wxFileName::FileExists(recoveryFile)) {
+            const wxDateTime recoveryTime = wxFileName(recoveryFile).GetModificationTime();
+            const wxDateTime projectTime = wxFileName(file).GetModificationTime();
+            if (recoveryTime.IsLaterThan(projectTime)
+                && wxMessageBox(
+                       _("An autosaved copy of this project, newer than the project file, "
+                         "has been found.\n"
+                         "It was probably left by a crash or a forced termination.\n\n"
+                         "Would you like to recover it?"),
+                       _("Recover Project"), wxICON_QUESTION | wxYES_NO)
+                    == wxYES) {
+                m_objDb->ResetObjectCounters();
+                try {
+                    // Mark as modified, the recovered data is not in the project file yet
+                    if (SetLoadedProject(ProjectSnapshot::Load(m_objDb, recoveryFile), file, true,
+                                         justGenerate))
+                        return true;
+                } catch (wxWeaverException& ex) {
+                    wxLogError(ex.what());
+                }
+            }
+            wxRemoveFile(recoveryFile);
+        }
+    }
+    if (ProjectSnapshot::IsSnapshotFile(file)) {
+        m_objDb->ResetObjectCounters();
+        try {
+            SetLoadedProject(ProjectSnapshot::Load(m_objDb, file), file, false, justGenerate);
+        } catch (wxWeaverException& ex) {
+            wxLogError(ex.what());
+            return false;
+        }
+        return true;
+    }
+    // Prefer the binary cache written along with the XML file, if up to date
+    m_objDb->ResetObjectCounters();
+    PObjectBase cached = ProjectSnapshot::LoadCache(m_objDb, file);
+    if (cached) {
+        SetLoadedProject(cached, file, false, justGenerate);
+        return true;
     }
     try {
         ticpp::Document doc;
@@ -1177,18 +1293,11 @@ bool ApplicationData::LoadProject(const wxString& file, bool justGenerate)
             wxLogError(ex.what());
             return false;
         }
-        if (proj && proj->GetTypeName() == "project") {
-            PObjectBase old_proj = m_project;
-            m_project = proj;
-            m_selObj = m_project;
-            // Set the modification to true if the project was older and has been converted
-            m_modFlag = older;
-            m_cmdProc.Reset();
-            m_projectFile = file;
-            SetProjectPath(::wxPathOnly(file));
-            NotifyProjectLoaded();
-            NotifyProjectRefresh();
-        }
+        // Set the modification to true if the project was older and has been converted.
+        // Code generation runs don't write next to the project, e.g. in a read only tree
+        if (SetLoadedProject(proj, file, older, justGenerate) && !older && !justGenerate)
+            ProjectSnapshot::SaveCache(m_project, file);
+
     } catch (ticpp::Exception& ex) {
         wxLogError(wxString(ex.m_details));
         return false;
@@ -1196,15 +1305,41 @@ bool ApplicationData::LoadProject(const wxString& file, bool justGenerate)
     return true;
 }
 
+bool ApplicationData::SetLoadedProject(PObjectBase proj, const wxString& file,
+                                       bool modified, bool justGenerate)
+{
+    if (!proj || proj->GetTypeName() != "project")
+        return false;
+
+    // The previous project is closed now, its recovery copy is no longer needed.
+    // The copy of the same file has been handled by LoadProject(), and code
+    // generation runs leave the recovery files to the GUI instances
+    if (!justGenerate && file != m_projectFile)
+        DiscardRecoveryFile();
+
+    m_project = proj;
+    m_selObj = m_project;
+    m_modFlag = modified;
+    m_autosaveCount = m_changeCount;
+    m_cmdProc.Reset();
+    m_projectFile = file;
+    m_savedFile.clear();
+    SetProjectPath(::wxPathOnly(file));
+    NotifyProjectLoaded();
+    NotifyProjectRefresh();
+    return true;
+}
+
 bool ApplicationData::ConvertProject(ticpp::Document& doc, const wxString& path,
-                                     int fileMajor, int fileMinor)
+                                     int fileMajor, int fileMinor, bool interactive)
 {
     try {
-        XMLUtils::LoadXMLFile(doc, false, path);
+        if (interactive)
+            XMLUtils::LoadXMLFile(doc, false, path);
 
         ticpp::Element* root = doc.FirstChildElement();
         if (root->Value() == std::string("object")) {
-            ConvertProjectProperties(root, path, fileMajor, fileMinor);
+            ConvertProjectProperties(root, path, fileMajor, fileMinor, interactive);
             ConvertObject(root, fileMajor, fileMinor);
 
             // Create a clone of now-converted object tree, so it can be linked
@@ -1232,7 +1367,7 @@ bool ApplicationData::ConvertProject(ticpp::Document& doc, const wxString& path,
         } else {
             // Handle project separately because it only occurs once
             ticpp::Element* project = root->FirstChildElement("object");
-            ConvertProjectProperties(project, path, fileMajor, fileMinor);
+            ConvertProjectProperties(project, path, fileMajor, fileMinor, interactive);
             ConvertObject(project, fileMajor, fileMinor);
             ticpp::Element* fileVersion = root->FirstChildElement("FileVersion");
             fileVersion->SetAttribute("major", m_fbpVerMajor);
@@ -1247,7 +1382,8 @@ bool ApplicationData::ConvertProject(ticpp::Document& doc, const wxString& path,
 
 void ApplicationData::ConvertProjectProperties(ticpp::Element* project,
                                                const wxString& path,
-                                               int fileMajor, int fileMinor)
+                                               int fileMajor, int fileMinor,
+                                               bool interactive)
 
 {
     // Ensure that this is the "project" element
@@ -1271,7 +1407,22 @@ void ApplicationData::ConvertProjectProperties(ticpp::Element* project,
             user_headers = (*newProps.begin())->GetText(false);
             project->RemoveChild(*newProps.begin());
         }
-        if (!user_headers.empty()) {
+        if (!user_headers.empty() && !interactive) {
+            // Nobody to ask, keep the value next to the project file
+            wxString name;
+            wxFileName::SplitPath(path, nullptr, nullptr, &name, nullptr);
+            wxString filename = ::wxPathOnly(path) + wxFILE_SEP_PATH + name + "_user_headers.txt";
+            wxFFile output(filename, "w");
+            if (output.IsOpened() && output.Write(wxString(user_headers))) {
+                wxLogMessage(
+                    "The \"user_headers\" property has been removed, "
+                    "its value has been saved to %s", filename);
+            } else {
+                wxLogError(
+                    "Unable to open %s for writing.\nUser Headers:\n%s",
+                    filename, wxString(user_headers));
+            }
+        } else if (!user_headers.empty()) {
             wxString msg = _("The \"user_headers\" property has been removed.\n");
             msg += _("Its purpose was to provide a place to include precompiled headers or\n");
             msg += _("headers for subclasses.\n");
@@ -1653,8 +1804,7 @@ void ApplicationData::ConvertObject(ticpp::Element* parent, int fileMajor, int f
             parent->SetAttribute("class", objClass);
             classUpdated = true;
         }
-        if (m_warnOnAdditionsUpdate && classUpdated) {
-            m_warnOnAdditionsUpdate = false;
+        if (classUpdated && m_warnOnAdditionsUpdate.exchange(false)) {
             wxLogWarning(
                 "Updated classes from wxAdditions. "
                 "You must use the latest version of wxAdditions to continue.\n"
@@ -1665,10 +1815,13 @@ void ApplicationData::ConvertObject(ticpp::Element* parent, int fileMajor, int f
         typedef std::map<std::string, std::set<std::string>> PropertiesToRemove;
 
         static std::set<std::string> propertyRemovalWarnings;
+        static std::mutex propertyRemovalWarningsMutex;
         const PropertiesToRemove& propertiesToRemove = GetPropertiesToRemove_v1_12();
         PropertiesToRemove::const_iterator it = propertiesToRemove.find(objClass);
         if (it != propertiesToRemove.end()) {
             RemoveProperties(parent, it->second);
+
+            std::lock_guard<std::mutex> lock(propertyRemovalWarningsMutex);
             if (!propertyRemovalWarnings.count(objClass)) {
                 std::stringstream ss;
                 std::ostream_iterator<std::string> out_it(ss, ", ");
@@ -1913,13 +2066,13 @@ void ApplicationData::ConvertObject(ticpp::Element* parent, int fileMajor, int f
     }
     // The file is now at least version 1.15
     if (fileMajor < 1 || (fileMajor == 1 && fileMinor < 16)) {
-        static bool showRemovalWarnings = true;
+        // Shared by the conversion workers, warn only once
+        static std::atomic<bool> showRemovalWarnings(true);
         if (objClass == "wxMenuBar") {
             RemoveProperties(parent, std::set<std::string> { "label" });
-            if (showRemovalWarnings) {
+            if (showRemovalWarnings.exchange(false)) {
                 wxLogMessage(
                     "Removed property label for class wxMenuBar because it is no longer used");
-                showRemovalWarnings = false;
             }
         }
     }
@@ -2028,16 +2181,71 @@ void ApplicationData::TransferOptionList(ticpp::Element* prop,
 void ApplicationData::NewProject()
 
 {
+    DiscardRecoveryFile();
+
     m_project = m_objDb->CreateObject("Project");
     m_selObj = m_project;
     m_modFlag = false;
     m_cmdProc.Reset();
     m_projectFile = "";
+    m_savedFile.clear();
     SetProjectPath("");
     m_ipc->Reset();
     NotifyProjectRefresh();
 }
 
+void ApplicationData::AutosaveProject()
+{
+    // Untitled projects are not autosaved, recovery is offered by LoadProject
+    if (!m_project || m_projectFile.empty() || !m_modFlag
+        || m_autosaveCount == m_changeCount || m_autosaveBusy)
+        return;
+
+    if (m_autosaveThread.joinable())
+        m_autosaveThread.join();
+
+    // The clone shares nothing mutable with the live project,
+    // see CodeGenBenchmark for its cost on large projects
+    const auto start = std::chrono::steady_clock::now();
+    PObjectBase snapshot = m_project->Clone();
+    const std::chrono::duration<double, std::milli> elapsed
+        = std::chrono::steady_clock::now() - start;
+    LogDebug("Autosave snapshot taken in %.2f ms", elapsed.count());
+    wxUnusedVar(elapsed);
+
+    m_autosaveCount = m_changeCount;
+    m_autosaveBusy = true;
+    m_autosaveThread = std::thread(
+        [this](PObjectBase project, wxString file) {
+            if (!ProjectSnapshot::WriteFile(ProjectSnapshot::Serialize(project), file))
+                wxLogWarning("Unable to write the recovery file %s", file);
+
+            m_autosaveBusy = false;
+        },
+        std::move(snapshot), GetRecoveryFileName(m_projectFile).Clone());
+}
+
+void ApplicationData::DiscardRecoveryFile()
+{
+    if (m_autosaveThread.joinable())
+        m_autosaveThread.join();
+
+    m_autosaveCount = m_changeCount;
+    if (m_projectFile.empty())
+        return;
+
+    const wxString recoveryFile = GetRecoveryFileName(m_projectFile);
+    if (wxFileName::FileExists(recoveryFile))
+        wxRemoveFile(recoveryFile);
+}
+
+wxString ApplicationData::GetRecoveryFileName(const wxString& projectFile)
+{
+    wxFileName recoveryFile(projectFile);
+    recoveryFile.SetExt("fbpr");
+    return recoveryFile.GetFullPath();
+}
+
 void ApplicationData::GenerateCode(bool panelOnly, bool noDelayed)
 {
     NotifyCodeGeneration(panelOnly, !noDelayed);
@@ -2080,7 +2288,10 @@ void ApplicationData::GenerateInheritedClass(PObjectBase form, wxString classNam
                          file.c_str(), path.c_str());
             return;
         }
-        const wxString& genFileValue = project->GetPropertyAsString("file");
+        // Forms written to their own files are named after their class
+        const wxString genFileValue = project->GetPropertyAsInteger("split_forms")
+            ? form->GetPropertyAsString("name")
+            : project->GetPropertyAsString("file");
         wxFileName genFile(genFileValue);
         if (!genFile.MakeAbsolute(path)) {
             wxLogWarning("Unable to make \"%s\" absolute to \"%s\"",
@@ -2118,6 +2329,7 @@ void ApplicationData::GenerateInheritedClass(PObjectBase form, wxString classNam
 
         PProperty pCodeGen = project->GetProperty("code_generation");
         if (pCodeGen && TypeConv::FlagSet("C++", pCodeGen->GetValueAsString())) {
+            FileCodeWriter::Batch batch;
             CppCodeGenerator codegen;
             const wxString& fullPath = inherFile.GetFullPath();
             codegen.ParseFiles(fullPath + ".h", fullPath + ".cpp");
@@ -2228,6 +2440,7 @@ void ApplicationData::MoveHierarchy(PObjectBase obj, bool up)
 
 void ApplicationData::Undo()
 {
+    m_changeCount++;
     m_cmdProc.Undo();
     m_modFlag = !m_cmdProc.IsAtSavePoint();
     NotifyProjectRefresh();
@@ -2237,6 +2450,7 @@ void ApplicationData::Undo()
 
 void ApplicationData::Redo()
 {
+    m_changeCount++;
     m_cmdProc.Redo();
     m_modFlag = !m_cmdProc.IsAtSavePoint();
     NotifyProjectRefresh();
@@ -2525,6 +2739,7 @@ bool ApplicationData::IsDarkMode() const
 void ApplicationData::Execute(PCommand cmd)
 {
     m_modFlag = true;
+    m_changeCount++;
     m_cmdProc.Execute(cmd);
 }
 
@@ -2632,9 +2847,11 @@ bool ApplicationData::VerifySingleInstance(const wxString& file, bool switchTo)
     return m_ipc->VerifySingleInstance(file, switchTo);
 }
 
-wxString ApplicationData::GetPathProperty(const wxString& pathName)
+wxString ApplicationData::GetPathProperty(const wxString& pathName, PObjectBase project)
 {
-    PObjectBase project = GetProjectData();
+    if (!project)
+        project = GetProjectData();
+
     wxFileName path;
     // Get the output path
     PProperty ppath = project->GetProperty(pathName);
@@ -2673,20 +2890,22 @@ wxString ApplicationData::GetPathProperty(const wxString& pathName)
     return path.GetPath(wxPATH_GET_VOLUME | wxPATH_GET_SEPARATOR);
 }
 
-wxString ApplicationData::GetOutputPath()
+wxString ApplicationData::GetOutputPath(PObjectBase project)
 {
-    return GetPathProperty("path");
+    return GetPathProperty("path", project);
 }
 
-wxString ApplicationData::GetEmbeddedFilesOutputPath()
+wxString ApplicationData::GetEmbeddedFilesOutputPath(PObjectBase project)
 {
-    return GetPathProperty("embedded_files_path");
+    return GetPathProperty("embedded_files_path", project);
 }
 
 ApplicationData::PropertiesToRemove& ApplicationData::GetPropertiesToRemove_v1_12() const
 {
     static PropertiesToRemove propertiesToRemove;
-    if (propertiesToRemove.empty()) {
+    static std::once_flag initialized;
+    // May be called concurrently by headless project conversions
+    std::call_once(initialized, []() {
         propertiesToRemove["Dialog"].insert("BottomDockable");
         propertiesToRemove["Dialog"].insert("LeftDockable");
         propertiesToRemove["Dialog"].insert("RightDockable");
@@ -2755,6 +2974,6 @@ ApplicationData::PropertiesToRemove& ApplicationData::GetPropertiesToRemove_v1_1
 
         propertiesToRemove["wxadditions::wxTreeListCtrl"].insert("validator_style");
         propertiesToRemove["wxadditions::wxTreeListCtrl"].insert("validator_type");
-    }
+    });
     return propertiesToRemove;
 }
@@ -23,6 +23,9 @@
 #include "rtti/database.h"
 #include "cmdproc.h"
 
+#include <atomic>
+#include <thread>
+
 namespace ticpp {
 class Document;
 class Node;
@@ -38,6 +41,7 @@ class wxWeaverIPC;
 #define AppData() (ApplicationData::Get())
 #define AppDataCreate(path) (ApplicationData::Get(path))
 #define AppDataInit() (ApplicationData::Initialize())
+#define AppDataInitHeadless() (ApplicationData::Initialize(true))
 #define AppDataDestroy() (ApplicationData::Destroy())
 
 extern const char* const VERSION;
@@ -59,10 +63,15 @@ public:
     ApplicationData(ApplicationData&&) = delete;
     ApplicationData& operator=(ApplicationData&&) = delete;
 
-    static void Initialize(); // Forces the static AppData instance to Init()
+    /** Forces the static AppData instance to Init().
+
+        A @a headless instance skips the bitmaps, icons and system colours,
+        so it can be used to generate code without a display.
+    */
+    static void Initialize(bool headless = false);
     static void Destroy();
 
-    void LoadApp(); // Initialize application
+    void LoadApp(bool headless = false); // Initialize application
 
     PwxWeaverManager GetManager(); // Hold a pointer to the wxWeaverManager
 
@@ -74,16 +83,38 @@ public:
     void SaveProject(const wxString& filename);
     void NewProject();
 
+    /** Writes a recovery copy of the current project, if it has been
+        modified since the last save or autosave.
+
+        Only a structural copy of the project tree is taken here, a worker
+        thread serializes it and writes the file without ever touching the
+        live project.
+    */
+    void AutosaveProject();
+
+    /** Removes the recovery copy of the current project, if any.
+    */
+    void DiscardRecoveryFile();
+
+    /** Gets the name of the recovery file written by AutosaveProject().
+    */
+    static wxString GetRecoveryFileName(const wxString& projectFile);
+
     /** Convert a project from an older version.
 
+        This can be called concurrently from worker threads when
+        @a interactive is @false.
+
         @param path The path to the project file
         @param fileMajor The major revision of the file
         @param fileMinor The minor revision of the file
+        @param interactive If @false, @a doc must be already loaded and the
+        user will not be prompted for anything
 
         @return true if successful, false otherwise
     */
     bool ConvertProject(ticpp::Document& doc, const wxString& path,
-                        int fileMajor, int fileMinor);
+                        int fileMajor, int fileMinor, bool interactive = true);
 
     /** Recursive function used to convert the object tree in the project file
         to the latest version.
@@ -193,15 +224,31 @@ public:
 
     /** Path to the fbp file that is opened.
     */
-    const wxString& GetProjectPath() { return m_projectPath; }
+    const wxString& GetProjectPath();
+
+    /** Makes @a project, loaded from @a file, the current project of the
+        calling thread only, so several projects can be generated at once.
 
-    /** Path where the files will be generated.
+        GetProjectData() and GetProjectPath() return it until an empty
+        project is set, which restores the shared current project.
     */
-    wxString GetOutputPath();
+    static void SetThreadProject(PObjectBase project, const wxString& file);
 
-    /** Path where the embedded bitmap files will be generated.
+    /** Gets the project set for the calling thread, if any, so that the
+        worker threads it starts can use the same one.
     */
-    wxString GetEmbeddedFilesOutputPath();
+    static PObjectBase GetThreadProject(wxString* file);
+
+    /** Path where the files of @a project will be generated.
+
+        @a project defaults to the current project, worker threads have to
+        pass their own copy.
+    */
+    wxString GetOutputPath(PObjectBase project = PObjectBase());
+
+    /** Path where the embedded bitmap files of @a project will be generated.
+    */
+    wxString GetEmbeddedFilesOutputPath(PObjectBase project = PObjectBase());
 
     void SetProjectPath(const wxString& path) { m_projectPath = path; }
 
@@ -220,6 +267,19 @@ public:
 private:
     void NotifyEvent(wxWeaverEvent& event, bool forcedelayed = false);
 
+    /** Makes @a proj the current project, if it is a valid project object.
+
+        @param proj The loaded project object.
+        @param file The file the project has been loaded from.
+        @param modified Whether the project needs to be saved, e.g. when converted.
+        @param justGenerate Whether the project is only loaded to generate its code,
+               the recovery file of the previous project is then kept.
+
+        @return true if the project has been set, false otherwise.
+    */
+    bool SetLoadedProject(PObjectBase proj, const wxString& file, bool modified,
+                          bool justGenerate);
+
     // Notifican a cada observador el evento correspondiente
     void NotifyProjectLoaded();
 
@@ -301,9 +361,10 @@ private:
         @param path The path to the project file.
         @param fileMajor The major revision of the file.
         @param fileMinor The minor revision of the file.
+        @param interactive Whether the user can be prompted.
     */
     void ConvertProjectProperties(ticpp::Element* project, const wxString& path,
-                                  int fileMajor, int fileMinor);
+                                  int fileMajor, int fileMinor, bool interactive);
 
     /** Iterates through 'property' element children of @a parent.
 
@@ -341,9 +402,12 @@ private:
 
     /** Helper for GetOutputPath and GetEmbeddedFilesOutputPath
     */
-    wxString GetPathProperty(const wxString& pathName);
+    wxString GetPathProperty(const wxString& pathName, PObjectBase project);
 
     static ApplicationData* s_instance;
+    static thread_local PObjectBase s_threadProject;
+    static thread_local wxString s_threadProjectFile;
+    static thread_local wxString s_threadProjectPath;
 
     typedef std::map<std::string, std::set<std::string>> PropertiesToRemove;
     PropertiesToRemove& GetPropertiesToRemove_v1_12() const;
@@ -358,6 +422,14 @@ private:
     PwxWeaverManager m_manager;
     std::shared_ptr<wxWeaverIPC> m_ipc; // Prevents more than one instance of a project
 
+    std::thread m_autosaveThread;
+    std::atomic<bool> m_autosaveBusy;
+    size_t m_changeCount;   // Incremented on each executed, undone or redone command
+    size_t m_autosaveCount; // Value of m_changeCount at the last autosave
+
+    wxString m_savedFile;  // File written by the last SaveProject()
+    uint64_t m_savedHash;  // Hash of the data written to m_savedFile
+
     typedef std::vector<wxEvtHandler*> HandlerVector;
     HandlerVector m_handlers;
 
@@ -370,6 +442,6 @@ private:
     wxString m_rootDir;           // directorio raíz (mismo que el ejecutable)
     bool m_copyOnPaste;           // flag que indica si hay que copiar el objeto al pegar
     bool m_modFlag;               // flag de proyecto modificado
-    bool m_warnOnAdditionsUpdate; // flag to warn on additions update / class renames
+    std::atomic<bool> m_warnOnAdditionsUpdate; // flag to warn on additions update / class renames
     bool m_darkMode;
 };
@@ -0,0 +1,483 @@
+/*
+    wxWeaver - A GUI Designer Editor for wxWidgets.
+    Copyright (C) 2021 Andrea Zanellato <redtid3@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include "benchmark.h"
+
+#include "codegen/codewriter.h"
+#include "codegen/cppcg.h"
+#include "codegen/luacg.h"
+#include "codegen/phpcg.h"
+#include "codegen/pythoncg.h"
+#include "codegen/xrccg.h"
+#include "rtti/database.h"
+#include "rtti/objectbase.h"
+#include "rtti/snapshot.h"
+#include "utils/exception.h"
+#include "appdata.h"
+
+#include <wx/filename.h>
+#include <wx/log.h>
+#include <wx/tokenzr.h>
+#include <wx/utils.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <vector>
+
+#ifdef wxWEAVER_BENCHMARK_ALLOCATIONS
+namespace {
+std::atomic<unsigned long long> s_allocations(0);
+} // namespace
+
+/*
+    Counting replacements of the global allocation functions,
+    the array and nothrow forms call these ones.
+*/
+void* operator new(size_t size)
+{
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+#endif
+
+namespace {
+unsigned long long GetAllocationCount()
+{
+#ifdef wxWEAVER_BENCHMARK_ALLOCATIONS
+    return s_allocations.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+typedef std::function<PCodeWriter(const wxString& extension)> WriterFactory;
+typedef std::unique_ptr<CodeGenerator> (*GeneratorFactory)(const WriterFactory& createWriter,
+                                                           const wxString& path);
+
+std::unique_ptr<CodeGenerator> CreateCpp(const WriterFactory& createWriter, const wxString& path)
+{
+    std::unique_ptr<CppCodeGenerator> codegen(new CppCodeGenerator);
+    codegen->UseRelativePath(false, path);
+    codegen->SetGenerateEmbeddedFiles(false);
+    codegen->SetHeaderWriter(createWriter(".h"));
+    codegen->SetSourceWriter(createWriter(".cpp"));
+    return codegen;
+}
+
+std::unique_ptr<CodeGenerator> CreatePython(const WriterFactory& createWriter,
+                                            const wxString& path)
+{
+    std::unique_ptr<PythonCodeGenerator> codegen(new PythonCodeGenerator);
+    codegen->UseRelativePath(false, path);
+    codegen->SetSourceWriter(createWriter(".py"));
+    return codegen;
+}
+
+std::unique_ptr<CodeGenerator> CreatePHP(const WriterFactory& createWriter, const wxString& path)
+{
+    std::unique_ptr<PHPCodeGenerator> codegen(new PHPCodeGenerator);
+    codegen->UseRelativePath(false, path);
+    codegen->SetSourceWriter(createWriter(".php"));
+    return codegen;
+}
+
+std::unique_ptr<CodeGenerator> CreateLua(const WriterFactory& createWriter, const wxString& path)
+{
+    std::unique_ptr<LuaCodeGenerator> codegen(new LuaCodeGenerator);
+    codegen->UseRelativePath(false, path);
+    codegen->SetSourceWriter(createWriter(".lua"));
+    return codegen;
+}
+
+std::unique_ptr<CodeGenerator> CreateXrc(const WriterFactory& createWriter, const wxString&)
+{
+    std::unique_ptr<XrcCodeGenerator> codegen(new XrcCodeGenerator);
+    codegen->SetWriter(createWriter(".xrc"));
+    return codegen;
+}
+
+const std::pair<const char*, GeneratorFactory> s_generators[] = {
+    { "C++", CreateCpp },
+    { "Python", CreatePython },
+    { "PHP", CreatePHP },
+    { "Lua", CreateLua },
+    { "XRC", CreateXrc },
+};
+
+/** Runs a generator with the writers returned by @a createWriter.
+
+    @return The elapsed milliseconds, including the flush of the writers.
+*/
+double RunGenerator(GeneratorFactory create, PObjectBase project, const wxString& path,
+                    const WriterFactory& createWriter, bool* success)
+{
+    const auto start = std::chrono::steady_clock::now();
+    {
+        // The output manifests are written as the generation ends, within the time
+        FileCodeWriter::Batch batch;
+        std::unique_ptr<CodeGenerator> codegen = create(createWriter, path);
+        try {
+            *success = codegen->GenerateCode(project) && *success;
+        } catch (wxWeaverException& ex) {
+            wxLogError(ex.what());
+            *success = false;
+        }
+    }
+    const std::chrono::duration<double, std::milli> elapsed
+        = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+double Median(std::vector<double> values)
+{
+    if (values.empty())
+        return 0;
+
+    std::sort(values.begin(), values.end());
+    const size_t middle = values.size() / 2;
+    if (values.size() % 2)
+        return values[middle];
+
+    return (values[middle - 1] + values[middle]) / 2;
+}
+
+size_t CountObjects(PObjectBase object)
+{
+    size_t count = 1;
+    for (size_t i = 0; i < object->GetChildCount(); ++i)
+        count += CountObjects(object->GetChild(i));
+
+    return count;
+}
+
+/** Builds the benchmark project out of the components of the object database.
+
+    The project only depends on the settings and on the registered
+    components, so the same build always produces the same project.
+*/
+class ProjectSynthesizer {
+public:
+    explicit ProjectSynthesizer(const CodeGenBenchmark::Settings& settings)
+        : m_settings(settings)
+        , m_db(AppData()->GetObjectDatabase())
+        , m_bitmapCount(0)
+        , m_eventCount(0)
+    {
+    }
+
+    /** @throw wxWeaverException If no widget component is registered.
+    */
+    PObjectBase Create(const wxString& path);
+
+private:
+    PObjectBase Add(const wxString& className, PObjectBase parent);
+    void AddSizers(PObjectBase parent, unsigned depth, std::vector<PObjectBase>* leaves);
+    void Decorate(PObjectBase widget);
+
+    /** Spreads a percentage evenly, without a random generator.
+    */
+    static bool Pick(unsigned percent, unsigned* count);
+
+    const CodeGenBenchmark::Settings& m_settings;
+    PObjectDatabase m_db;
+    std::vector<wxString> m_widgets;
+    unsigned m_bitmapCount;
+    unsigned m_eventCount;
+};
+
+PObjectBase ProjectSynthesizer::Create(const wxString& path)
+{
+    for (size_t i = 0; i < m_db->GetPackageCount(); ++i) {
+        PObjectPackage package = m_db->GetPackage(i);
+        for (size_t j = 0; j < package->GetObjectCount(); ++j) {
+            PObjectInfo info = package->GetObjectInfo(j);
+            if (info->GetTypeName() == "widget")
+                m_widgets.push_back(info->GetClassName());
+        }
+    }
+    if (m_widgets.empty()) {
+        wxWEAVER_THROW_EX("No widget components are registered")
+    }
+    std::sort(m_widgets.begin(), m_widgets.end());
+
+    m_db->ResetObjectCounters();
+    PObjectBase project = m_db->CreateObject("Project");
+    project->GetProperty("name")->SetValue("benchmark");
+    project->GetProperty("file")->SetValue("benchmark");
+    project->GetProperty("path")->SetValue(path);
+
+    static const char* const forms[] = { "Frame", "Panel", "Dialog" };
+    size_t widget = 0;
+    for (unsigned i = 0; i < m_settings.forms; ++i) {
+        PObjectBase form = Add(forms[i % WXSIZEOF(forms)], project);
+        if (!form) {
+            wxWEAVER_THROW_EX("Unable to create the form " << forms[i % WXSIZEOF(forms)])
+        }
+        std::vector<PObjectBase> leaves;
+        AddSizers(form, std::max(1u, m_settings.depth), &leaves);
+
+        // Widgets that can't be placed in a sizer are just skipped
+        for (unsigned j = 0; j < m_settings.widgets; ++j) {
+            PObjectBase sizer = leaves[j % leaves.size()];
+            for (size_t tries = 0; tries < m_widgets.size(); ++tries) {
+                PObjectBase object = Add(m_widgets[widget++ % m_widgets.size()], sizer);
+                if (object) {
+                    Decorate(object);
+                    break;
+                }
+            }
+        }
+    }
+    return project;
+}
+
+PObjectBase ProjectSynthesizer::Add(const wxString& className, PObjectBase parent)
+{
+    PObjectBase object;
+    try {
+        object = m_db->CreateObject(className.ToStdString(), parent);
+    } catch (wxWeaverException&) {
+        return PObjectBase();
+    }
+    if (!object || !parent->AddChild(object))
+        return PObjectBase();
+
+    object->SetParent(parent);
+
+    // Sizer items and the like wrap the created object
+    if (object->GetObjectInfo()->GetType()->IsItem() && object->GetChildCount())
+        object = object->GetChild(0);
+
+    return object;
+}
+
+void ProjectSynthesizer::AddSizers(PObjectBase parent, unsigned depth,
+                                   std::vector<PObjectBase>* leaves)
+{
+    PObjectBase sizer = Add("wxBoxSizer", parent);
+    if (!sizer) {
+        wxWEAVER_THROW_EX("Unable to create a wxBoxSizer in " << parent->GetClassName())
+    }
+    if (depth == 1) {
+        leaves->push_back(sizer);
+        return;
+    }
+    for (int i = 0; i < 2; ++i)
+        AddSizers(sizer, depth - 1, leaves);
+}
+
+void ProjectSynthesizer::Decorate(PObjectBase widget)
+{
+    for (size_t i = 0; i < widget->GetPropertyCount(); ++i) {
+        PProperty property = widget->GetProperty(i);
+        if (property->GetType() == PT_BITMAP && Pick(m_settings.bitmaps, &m_bitmapCount))
+            property->SetValue("Load From Art Provider; wxART_INFORMATION; wxART_BUTTON");
+    }
+    for (size_t i = 0; i < widget->GetEventCount(); ++i) {
+        PEvent event = widget->GetEvent(i);
+        if (Pick(m_settings.events, &m_eventCount))
+            event->SetValue(event->GetName());
+    }
+}
+
+bool ProjectSynthesizer::Pick(unsigned percent, unsigned* count)
+{
+    *count += std::min(percent, 100u);
+    if (*count < 100)
+        return false;
+
+    *count -= 100;
+    return true;
+}
+} // namespace
+
+bool CodeGenBenchmark::ParseSettings(const wxString& text, Settings* settings)
+{
+    const std::pair<const char*, unsigned*> keys[] = {
+        { "forms", &settings->forms },
+        { "widgets", &settings->widgets },
+        { "depth", &settings->depth },
+        { "bitmaps", &settings->bitmaps },
+        { "events", &settings->events },
+        { "iterations", &settings->iterations },
+    };
+    wxStringTokenizer tokenizer(text, ",", wxTOKEN_STRTOK);
+    while (tokenizer.HasMoreTokens()) {
+        const wxString token = tokenizer.GetNextToken().Trim().Trim(false);
+        const wxString key = token.BeforeFirst('=').Trim();
+        unsigned long value = 0;
+        if (!token.AfterFirst('=').Trim(false).ToULong(&value)) {
+            wxLogError("Invalid benchmark setting: %s", token);
+            return false;
+        }
+        bool found = false;
+        for (const auto& entry : keys) {
+            if (key == entry.first) {
+                *entry.second = static_cast<unsigned>(value);
+                found = true;
+            }
+        }
+        if (!found) {
+            wxLogError("Unknown benchmark setting: %s", key);
+            return false;
+        }
+    }
+    settings->iterations = std::max(1u, settings->iterations);
+    return true;
+}
+
+bool CodeGenBenchmark::Run(const Settings& settings)
+{
+    const wxString path = wxFileName::GetTempDir() + wxFILE_SEP_PATH
+        + wxString::Format("wxweaver-benchmark-%lu", wxGetProcessId()) + wxFILE_SEP_PATH;
+    if (!wxFileName::Mkdir(path, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL)) {
+        wxLogError("Unable to create the output directory %s", path);
+        return false;
+    }
+    PObjectBase project;
+    const auto start = std::chrono::steady_clock::now();
+    try {
+        ProjectSynthesizer synthesizer(settings);
+        project = synthesizer.Create(path);
+    } catch (wxWeaverException& ex) {
+        wxLogError(ex.what());
+        wxFileName::Rmdir(path, wxPATH_RMDIR_RECURSIVE);
+        return false;
+    }
+    const std::chrono::duration<double, std::milli> synthesis
+        = std::chrono::steady_clock::now() - start;
+    const size_t objects = CountObjects(project);
+
+    // The generators look up some settings through the current project
+    ApplicationData::SetThreadProject(project, path + "benchmark.fbp");
+
+    std::cout << wxString::Format(
+                     "%u forms x %u widgets, sizer depth %u, %u%% bitmaps, %u%% events: "
+                     "%zu objects synthesised in %.1f ms, %u iterations\n\n",
+                     settings.forms, settings.widgets, settings.depth, settings.bitmaps,
+                     settings.events, objects, synthesis.count(), settings.iterations)
+                     .utf8_str();
+    std::cout << wxString::Format("%-8s %10s %10s %10s %10s %12s %14s\n", "", "cold ms",
+                                  "memory ms", "files ms", "lines", "lines/s",
+                                  "allocs/object")
+                     .utf8_str();
+
+    bool success = true;
+    for (const auto& generator : s_generators) {
+        bool generated = true;
+
+        // First run: compiles the templates of the generator
+        std::vector<PStringCodeWriter> outputs;
+        auto createStringWriter = [&outputs](const wxString&) {
+            PStringCodeWriter writer(new StringCodeWriter);
+            outputs.push_back(writer);
+            return PCodeWriter(writer);
+        };
+        const double cold
+            = RunGenerator(generator.second, project, path, createStringWriter, &generated);
+
+        size_t lines = 0;
+        for (const PStringCodeWriter& output : outputs) {
+            const wxString& code = output->GetString();
+            lines += std::count(code.begin(), code.end(), '\n');
+        }
+        std::vector<double> memory;
+        const unsigned long long allocations = GetAllocationCount();
+        for (unsigned i = 0; i < settings.iterations; ++i) {
+            outputs.clear();
+            memory.push_back(
+                RunGenerator(generator.second, project, path, createStringWriter, &generated));
+        }
+        const double allocationsPerObject = static_cast<double>(
+                                                GetAllocationCount() - allocations)
+            / settings.iterations / objects;
+
+        // The first writes create the files, the next ones find them unchanged
+        auto createFileWriter = [&path](const wxString& extension) {
+            return PCodeWriter(new FileCodeWriter(path + "benchmark" + extension));
+        };
+        std::vector<double> files;
+        for (unsigned i = 0; i < settings.iterations; ++i) {
+            files.push_back(
+                RunGenerator(generator.second, project, path, createFileWriter, &generated));
+        }
+        const double memoryMedian = Median(memory);
+        wxString line = wxString::Format(
+            "%-8s %10.2f %10.2f %10.2f %10zu %12.0f ", generator.first, cold, memoryMedian,
+            Median(files), lines, lines / std::max(memoryMedian, 1e-6) * 1000);
+#ifdef wxWEAVER_BENCHMARK_ALLOCATIONS
+        line << wxString::Format("%14.1f", allocationsPerObject);
+#else
+        wxUnusedVar(allocationsPerObject);
+        line << wxString::Format("%14s", "n/a");
+#endif
+        if (!generated) {
+            line << "  FAILED";
+            success = false;
+        }
+        std::cout << line.utf8_str() << '\n';
+    }
+
+    // Autosave: only the clone blocks the GUI thread, the worker serializes it
+    std::vector<double> clone;
+    std::vector<double> serialize;
+    size_t snapshotSize = 0;
+    for (unsigned i = 0; i < settings.iterations; ++i) {
+        const auto cloneStart = std::chrono::steady_clock::now();
+        PObjectBase copy = project->Clone();
+        const auto serializeStart = std::chrono::steady_clock::now();
+        snapshotSize = ProjectSnapshot::Serialize(copy).size();
+        const auto serializeEnd = std::chrono::steady_clock::now();
+
+        clone.push_back(
+            std::chrono::duration<double, std::milli>(serializeStart - cloneStart).count());
+        serialize.push_back(
+            std::chrono::duration<double, std::milli>(serializeEnd - serializeStart).count());
+    }
+    std::cout << wxString::Format("\nautosave: %.2f ms snapshot (GUI thread), "
+                                  "%.2f ms serialization of %zu bytes (worker)\n",
+                                  Median(clone), Median(serialize), snapshotSize)
+                     .utf8_str();
+    std::cout.flush();
+
+    ApplicationData::SetThreadProject(PObjectBase(), wxEmptyString);
+    wxFileName::Rmdir(path, wxPATH_RMDIR_RECURSIVE);
+
+    // Messages logged by the generators
+    wxLog::FlushActive();
+    return success;
+}
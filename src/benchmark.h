@@ -0,0 +1,55 @@
+/*
+    wxWeaver - A GUI Designer Editor for wxWidgets.
+    Copyright (C) 2021 Andrea Zanellato <redtid3@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#pragma once
+
+#include <wx/string.h>
+
+/** Measures the code generators on projects synthesised from the
+    registered components.
+*/
+class CodeGenBenchmark {
+public:
+    /** Size and composition of the synthesised project.
+    */
+    struct Settings {
+        unsigned forms = 10;      // Forms in the project, alternating frames, panels and dialogs
+        unsigned widgets = 50;    // Widgets per form
+        unsigned depth = 3;       // Nesting depth of the sizers in each form
+        unsigned bitmaps = 20;    // Percentage of widgets with their bitmaps set
+        unsigned events = 20;     // Percentage of widget events with a handler
+        unsigned iterations = 7;  // Measured runs of each generator
+    };
+
+    /** Parses a comma separated list of key=value pairs, e.g.
+        "forms=20,widgets=100,depth=4,bitmaps=50,events=10,iterations=9",
+        the keys being the names of the Settings members.
+    */
+    static bool ParseSettings(const wxString& text, Settings* settings);
+
+    /** Runs the benchmark and prints the results to the standard output.
+
+        Every generator runs once to compile its templates, then the given
+        number of times into memory and as many times into files.
+        The reported times are medians, so they can be compared across builds.
+
+        @return false if the project could not be synthesised
+                or a generator failed.
+    */
+    static bool Run(const Settings& settings);
+};
@@ -23,26 +23,195 @@
 #include "rtti/objectbase.h"
 #include "appdata.h"
 #include "utils/exception.h"
+#include "utils/fileutils.h"
 
 #include <wx/tokenzr.h>
 
-TemplateParser::TemplateParser(PObjectBase obj, wxString _template)
-    : m_obj(obj)
-    , m_in(_template)
-    , m_indent(0)
+#include <tuple>
+#include <utility>
+
+/** Builds the instructions of a CompiledTemplate.
+
+    Each instruction is compiled from a position of the source, the instruction
+    compiled from a given position is reused by every path reaching it.
+
+    The compiler works on a range of the source, inner templates are compiled
+    from a sub-range of the same buffer instead of being extracted first.
+*/
+class TemplateCompiler {
+public:
+    TemplateCompiler(const wxString& source, size_t begin, size_t end)
+        : m_source(source)
+        , m_pos(begin)
+        , m_end(end)
+    {
+    }
+
+    PCompiledTemplate Compile();
+
+private:
+    typedef CompiledTemplate::Opcode Opcode;
+    typedef CompiledTemplate::Relative Relative;
+    typedef CompiledTemplate::Instruction Instruction;
+
+    enum class Node {
+        Token,          // Text, a property or a macro
+        IfFound,        // Property found by a macro, or a property name follows
+        LookupProperty, // Property name of a conditional macro
+        Block           // Literal and inner template of a conditional macro
+    };
+
+    struct Pending {
+        size_t index;
+        Node node;
+        Opcode op;
+        size_t pos;
+    };
+
+    /** Gets the index of the instruction compiled for @a node at @a pos,
+        scheduling its compilation if it doesn't exist yet.
+    */
+    size_t GetInstruction(Node node, Opcode op, size_t pos);
+
+    static const std::map<wxString, Opcode>& GetMacros();
+
+    void CompileToken(Instruction& instruction);
+    void CompileMacro(Instruction& instruction);
+    void CompileLookup(Instruction& instruction, Opcode op);
+    void CompileLookupProperty(Instruction& instruction, Opcode op);
+    void CompileBlock(Instruction& instruction, Opcode op);
+
+    /** Compiles the inner template in [@a range.first, @a range.second).
+    */
+    PCompiledTemplate CompileInner(const std::pair<size_t, size_t>& range);
+
+    bool Eof() const { return m_pos >= m_end; }
+    wxChar Peek() const { return Eof() ? wxChar(0) : wxChar(m_source[m_pos]); }
+    wxChar GetC() { return Eof() ? wxChar(0) : wxChar(m_source[m_pos++]); }
+
+    /** Finds the first of @a chars from the current position,
+        returns the end of the range if there is none.
+    */
+    size_t Find(const char* chars) const;
+
+    void IgnoreLeadingWhitespaces();
+    wxString ParseIdent();
+    wxString ParsePropertyName(wxString* child = nullptr);
+    wxString ParseText();
+
+    /** A literal value is an string enclosed between '"' (e.g. "xxx"),
+        The " character is represented with "".
+    */
+    wxString ExtractLiteral();
+
+    /** Finds the template enclosed between '@{' and '@}',
+        having in mind that they can be nested.
+
+        @return The range of the template in the source.
+    */
+    std::pair<size_t, size_t> ExtractInnerTemplate();
+
+    const wxString& m_source;
+    size_t m_pos;
+    size_t m_end;
+
+    std::shared_ptr<CompiledTemplate> m_template;
+    std::map<std::tuple<Node, Opcode, size_t>, size_t> m_compiled;
+    std::vector<Pending> m_pending;
+};
+
+namespace {
+bool IsIdentChar(wxChar c)
 {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
 }
+} // namespace
 
-TemplateParser::TemplateParser(const TemplateParser& other, wxString _template)
-    : m_obj(other.m_obj)
-    , m_in(_template)
-    , m_indent(0)
+const std::map<wxString, CompiledTemplate::Opcode>& TemplateCompiler::GetMacros()
 {
+    static const std::map<wxString, Opcode> macros = {
+        { "wxparent", Opcode::WxParent },
+        { "ifnotnull", Opcode::IfNotNull },
+        { "ifnull", Opcode::IfNull },
+        { "foreach", Opcode::ForEach },
+        { "pred", Opcode::Pred },
+        { "npred", Opcode::NPred },
+        { "child", Opcode::Child },
+        { "parent", Opcode::Parent },
+        { "nl", Opcode::NewLine },
+        { "ifequal", Opcode::IfEqual },
+        { "ifnotequal", Opcode::IfNotEqual },
+        { "ifparenttypeequal", Opcode::IfParentTypeEqual },
+        { "ifparentclassequal", Opcode::IfParentClassEqual },
+        { "ifparenttypenotequal", Opcode::IfParentTypeNotEqual },
+        { "ifparentclassnotequal", Opcode::IfParentClassNotEqual },
+        { "append", Opcode::Append },
+        { "class", Opcode::Class },
+        { "form", Opcode::Form },
+        { "wizard", Opcode::Form },
+        { "indent", Opcode::Indent },
+        { "unindent", Opcode::Unindent },
+        { "iftypeequal", Opcode::IfTypeEqual },
+        { "iftypenotequal", Opcode::IfTypeNotEqual },
+        { "utbl", Opcode::LuaTable },
+    };
+    return macros;
 }
 
-TemplateParser::~TemplateParser() = default;
+PCompiledTemplate TemplateCompiler::Compile()
+{
+    m_template = std::make_shared<CompiledTemplate>();
+
+    // The entry point is the beginning of the range, inner templates
+    // share the source with the template containing them
+    GetInstruction(Node::Token, Opcode::Jump, m_pos);
+
+    while (!m_pending.empty()) {
+        const Pending pending = m_pending.back();
+        m_pending.pop_back();
+
+        // Compiling may add instructions, work on a copy
+        m_pos = pending.pos;
+        Instruction instruction;
+        switch (pending.node) {
+        case Node::Token:
+            CompileToken(instruction);
+            break;
+        case Node::IfFound:
+            instruction.op = Opcode::IfFound;
+            instruction.next = GetInstruction(Node::Block, pending.op, m_pos);
+            instruction.alternative = GetInstruction(Node::LookupProperty, pending.op, m_pos);
+            break;
+        case Node::LookupProperty:
+            CompileLookupProperty(instruction, pending.op);
+            break;
+        case Node::Block:
+            CompileBlock(instruction, pending.op);
+            break;
+        }
+        m_template->m_instructions[pending.index] = instruction;
+    }
+    return m_template;
+}
+
+size_t TemplateCompiler::GetInstruction(Node node, Opcode op, size_t pos)
+{
+    if (node == Node::Token && pos >= m_end)
+        return CompiledTemplate::End;
+
+    const auto key = std::make_tuple(node, op, pos);
+    const auto compiled = m_compiled.find(key);
+    if (compiled != m_compiled.end())
+        return compiled->second;
+
+    const size_t index = m_template->m_instructions.size();
+    m_template->m_instructions.emplace_back();
+    m_compiled[key] = index;
+    m_pending.push_back({ index, node, op, pos });
+    return index;
+}
 
-TemplateParser::Token TemplateParser::GetNextToken()
+void TemplateCompiler::CompileToken(Instruction& instruction)
 {
     /*
         There are 3 special characters
@@ -51,125 +220,157 @@ TemplateParser::Token TemplateParser::GetNextToken()
         %xxxx -> local variable
         @x -> Escape a special character. Example: @# is the character #.
     */
-    Token result = TOK_ERROR;
-
-    if (!m_in.Eof()) {
-        wxChar c = m_in.Peek();
-        if (c == '#')
-            result = TOK_MACRO;
-        else if (c == '$')
-            result = TOK_PROPERTY;
-        else
-            result = TOK_TEXT;
+    const wxChar c = Peek();
+    if (c == '#') {
+        CompileMacro(instruction);
+    } else if (c == '$') {
+        instruction.op = Opcode::Property;
+        instruction.text = ParsePropertyName(&instruction.child);
+    } else {
+        instruction.op = Opcode::Text;
+        instruction.text = ParseText();
     }
-    return result;
+    if (instruction.op != Opcode::Error && instruction.next == CompiledTemplate::End)
+        instruction.next = GetInstruction(Node::Token, Opcode::Jump, m_pos);
 }
 
-bool TemplateParser::ParseMacro()
+void TemplateCompiler::CompileMacro(Instruction& instruction)
 {
-    Ident ident = ParseIdent();
-    switch (ident) {
-    case ID_WXPARENT:
-        return ParseWxParent();
-        break;
-    case ID_PARENT:
-        return ParseParent();
-        break;
-    case ID_FORM:
-        return ParseForm();
-        break;
-    case ID_IFNOTNULL:
-        return ParseIfNotNull();
-        break;
-    case ID_IFNULL:
-        return ParseIfNull();
-        break;
-    case ID_FOREACH:
-        return ParseForEach();
-        break;
-    case ID_PREDEFINED:
-        return ParsePred();
-        break;
-    case ID_PREDEFINED_INDEX:
-        return ParseNPred();
-        break;
-    case ID_CHILD:
-        return ParseChild();
-        break;
-    case ID_NEWLINE:
-        return ParseNewLine();
-        break;
-    case ID_IFEQUAL:
-        ParseIfEqual();
-        break;
-    case ID_IFNOTEQUAL:
-        ParseIfNotEqual();
-        break;
-    case ID_IFPARENTTYPEEQUAL:
-        ParseIfParentTypeEqual();
-        break;
-    case ID_IFPARENTCLASSEQUAL:
-        ParseIfParentClassEqual();
-        break;
-    case ID_IFPARENTTYPENOTEQUAL:
-        ParseIfParentTypeNotEqual();
-        break;
-    case ID_IFPARENTCLASSNOTEQUAL:
-        ParseIfParentClassNotEqual();
-        break;
-    case ID_APPEND:
-        ParseAppend();
-        break;
-    case ID_CLASS:
-        ParseClass();
+    const wxString ident = ParseIdent();
+    const auto macro = GetMacros().find(ident);
+    if (macro == GetMacros().end()) {
+        instruction.op = Opcode::Error;
+        instruction.text = wxString::Format("Unknown macro: \"%s\"", ident);
+        return;
+    }
+    instruction.op = macro->second;
+    switch (instruction.op) {
+    case Opcode::WxParent:
+        IgnoreLeadingWhitespaces();
+        instruction.text = ParsePropertyName();
         break;
-    case ID_INDENT:
-        ParseIndent();
+    case Opcode::Parent:
+    case Opcode::Form:
+    case Opcode::Child: {
+        // Without the object the property name is left to be parsed as text
+        instruction.alternative = GetInstruction(Node::Token, Opcode::Jump, m_pos);
+        IgnoreLeadingWhitespaces();
+        instruction.text = ParsePropertyName();
         break;
-    case ID_UNINDENT:
-        ParseUnindent();
+    }
+    case Opcode::IfNotNull:
+    case Opcode::IfNull:
+    case Opcode::IfEqual:
+    case Opcode::IfNotEqual:
+        IgnoreLeadingWhitespaces();
+        CompileLookup(instruction, instruction.op);
         break;
-    case ID_IFTYPEEQUAL:
-        ParseIfTypeEqual();
+    case Opcode::ForEach:
+        IgnoreLeadingWhitespaces();
+        if (Peek() == '$') {
+            instruction.text = ParsePropertyName();
+            instruction.inner = CompileInner(ExtractInnerTemplate());
+        } else {
+            instruction.op = Opcode::Jump;
+        }
         break;
-    case ID_IFTYPENOTEQUAL:
-        ParseIfTypeNotEqual();
+    case Opcode::IfParentTypeEqual:
+    case Opcode::IfParentTypeNotEqual:
+    case Opcode::IfParentClassEqual:
+    case Opcode::IfParentClassNotEqual:
+    case Opcode::IfTypeEqual:
+    case Opcode::IfTypeNotEqual:
+        instruction.text = ExtractLiteral();
+        instruction.inner = CompileInner(ExtractInnerTemplate());
         break;
-    case ID_UTBL:
-        ParseLuaTable();
+    case Opcode::Append:
+        IgnoreLeadingWhitespaces();
         break;
     default:
-        wxWEAVER_THROW_EX("Invalid Macro Type");
         break;
     }
-    return true;
 }
 
-TemplateParser::Ident TemplateParser::ParseIdent()
+void TemplateCompiler::CompileLookup(Instruction& instruction, Opcode op)
 {
-    Ident ident = ID_ERROR;
-    if (!m_in.Eof()) {
-        wxString macro;
-        m_in.GetC();
-
-        wxChar peek(m_in.Peek());
-        while (peek != wxChar(EOF) && !m_in.Eof() && peek != '#' && peek != '$'
-               && ((peek >= 'a'
-                    && peek <= 'z')
-                   || (peek >= 'A'
-                       && peek <= 'Z')
-                   || (peek >= '0'
-                       && peek <= '9'))) {
-            macro += wxChar(m_in.GetC());
-            peek = wxChar(m_in.Peek());
+    // The property can be preceded by #wxparent, #parent or #child
+    if (Peek() == '#') {
+        const wxString ident = ParseIdent();
+        const auto macro = GetMacros().find(ident);
+        if (macro == GetMacros().end()) {
+            instruction.op = Opcode::LogError;
+            instruction.text = wxString::Format("Unknown macro: \"%s\"", ident);
+            instruction.next = GetInstruction(Node::LookupProperty, op, m_pos);
+            return;
+        }
+        switch (macro->second) {
+        case Opcode::WxParent:
+            instruction.relative = Relative::WxParent;
+            break;
+        case Opcode::Parent:
+            instruction.relative = Relative::Parent;
+            break;
+        case Opcode::Child:
+            instruction.relative = Relative::Child;
+            break;
+        default:
+            instruction.op = Opcode::Jump;
+            instruction.next = GetInstruction(Node::LookupProperty, op, m_pos);
+            return;
         }
-        // Searching the identifier
-        ident = SearchIdent(macro);
+        instruction.op = Opcode::LookupRelative;
+        instruction.alternative = GetInstruction(Node::LookupProperty, op, m_pos);
+        IgnoreLeadingWhitespaces();
+        instruction.text = ParsePropertyName();
+        instruction.next = GetInstruction(Node::IfFound, op, m_pos);
+        return;
     }
-    return ident;
+    CompileLookupProperty(instruction, op);
 }
 
-wxString TemplateParser::ParsePropertyName(wxString* child)
+void TemplateCompiler::CompileLookupProperty(Instruction& instruction, Opcode op)
+{
+    if (Peek() != '$') {
+        // No property, the macro arguments are parsed as text
+        instruction.op = Opcode::Jump;
+        instruction.next = GetInstruction(Node::Token, Opcode::Jump, m_pos);
+        return;
+    }
+    instruction.op = Opcode::LookupProperty;
+    instruction.text = ParsePropertyName(&instruction.child);
+    instruction.next = GetInstruction(Node::Block, op, m_pos);
+    instruction.alternative = GetInstruction(Node::Token, Opcode::Jump, m_pos);
+}
+
+void TemplateCompiler::CompileBlock(Instruction& instruction, Opcode op)
+{
+    instruction.op = op;
+    if (op == Opcode::IfEqual || op == Opcode::IfNotEqual)
+        instruction.text = ExtractLiteral();
+
+    instruction.inner = CompileInner(ExtractInnerTemplate());
+    instruction.next = GetInstruction(Node::Token, Opcode::Jump, m_pos);
+}
+
+void TemplateCompiler::IgnoreLeadingWhitespaces()
+{
+    while (!Eof() && Peek() == ' ')
+        m_pos++;
+}
+
+wxString TemplateCompiler::ParseIdent()
+{
+    if (Eof())
+        return wxString();
+
+    const size_t begin = ++m_pos;
+    while (!Eof() && IsIdentChar(Peek()))
+        m_pos++;
+
+    return m_source.substr(begin, m_pos - begin);
+}
+
+wxString TemplateCompiler::ParsePropertyName(wxString* child)
 {
     wxString propname;
 
@@ -182,23 +383,20 @@ wxString TemplateParser::ParsePropertyName(wxString* child)
         without any white spaces now.
     */
     bool foundLeftCurlyBracket = false;
-    bool saveChild = (child != nullptr);
 
-    if (!m_in.Eof()) {
-        m_in.GetC();
+    if (!Eof()) {
+        GetC();
 
-        wxChar peek(m_in.Peek());
-        while (peek != wxChar(EOF) && !m_in.Eof() && peek != '#' && peek != '$'
-               && ((peek >= 'a' && peek <= 'z')
-                   || (peek >= 'A' && peek <= 'Z')
-                   || (peek >= '0' && peek <= '9')
+        wxChar peek = Peek();
+        while (!Eof()
+               && (IsIdentChar(peek)
                    || (peek >= '{' && peek <= '}')
                    || peek == '_' || peek == '/')) {
+            const wxChar next = GetC();
             if (foundSlash) {
-                if (saveChild)
-                    (*child) << wxChar(m_in.GetC());
+                if (child)
+                    (*child) << next;
             } else {
-                wxChar next = wxChar(m_in.GetC());
                 if ('{' == next)
                     foundLeftCurlyBracket = true;
                 else if (('}' == next) && (foundLeftCurlyBracket == true))
@@ -208,755 +406,530 @@ wxString TemplateParser::ParsePropertyName(wxString* child)
                 else
                     propname << next;
             }
-            peek = wxChar(m_in.Peek());
+            peek = Peek();
         }
     }
     return propname;
 }
 
-bool TemplateParser::ParseProperty()
-{
-    wxString childName;
-    wxString propname = ParsePropertyName(&childName);
-
-    PProperty property = m_obj->GetProperty(propname);
-    if (!property) {
-        wxLogError("The property '%s' does not exist for objects of class '%s'",
-                   propname.c_str(), m_obj->GetClassName().c_str());
-        return true;
-    }
-    if (childName.empty()) {
-        wxString code = PropertyToCode(property);
-        m_out << code;
-    } else {
-        m_out << property->GetChildFromParent(childName);
-    }
-#if 0
-    LogDebug("parsing property %s", propname.c_str());
-#endif
-    return true;
-}
-
-bool TemplateParser::ParseText()
+wxString TemplateCompiler::ParseText()
 {
     wxString text;
     int sspace = 0;
 
-    if (!m_in.Eof()) {
-        wxChar peek(m_in.Peek());
-
-        while (peek != wxChar(EOF)
-               && !m_in.Eof()
-               && peek != '#'
-               && peek != '$') {
-            wxChar c(m_in.GetC());
-            if (c == '@') {
-                c = wxChar(m_in.GetC());
-                if (c == ' ')
-                    sspace++;
-            }
-            text << c;
-            peek = wxChar(m_in.Peek());
-        }
-        if (text.find_first_not_of("\r\n\t ") != text.npos) {
-            // If text is all whitespace, ignore it
-            m_out << text;
-        } else {
-            // ... but allow all '@ ' instances
-            wxString spaces(' ', sspace);
-            m_out << spaces;
-        }
+    // Copy the runs between escapes at once
+    while (!Eof()) {
+        const size_t special = Find("#$@");
+        text.append(m_source, m_pos, special - m_pos);
+        m_pos = special;
+        if (Eof() || m_source[m_pos] != '@')
+            break;
+
+        if (++m_pos == m_end)
+            break;
+
+        const wxChar c = GetC();
+        if (c == ' ')
+            sspace++;
+
+        text << c;
     }
-#if 0
-    LogDebug("Parsed Text: %s", text.c_str());
-#endif
-    return true;
-}
+    // If text is all whitespace, ignore it but allow all '@ ' instances
+    if (text.find_first_not_of("\r\n\t ") == text.npos)
+        return wxString(' ', sspace);
 
-bool TemplateParser::ParseInnerTemplate()
-{
-    return true;
+    return text;
 }
 
-PObjectBase TemplateParser::GetWxParent()
+wxString TemplateCompiler::ExtractLiteral()
 {
-    PObjectBase wxparent, prev_wxparent;
+    wxString os;
 
-    std::vector<PObjectBase> candidates;
-    candidates.push_back(m_obj->FindNearAncestor("container"));
-    candidates.push_back(m_obj->FindNearAncestor("notebook"));
-    candidates.push_back(m_obj->FindNearAncestor("splitter"));
-    candidates.push_back(m_obj->FindNearAncestor("listbook"));
-    candidates.push_back(m_obj->FindNearAncestor("choicebook"));
-    candidates.push_back(m_obj->FindNearAncestor("simplebook"));
-    candidates.push_back(m_obj->FindNearAncestor("toolbook"));
-    candidates.push_back(m_obj->FindNearAncestor("treebook"));
-    candidates.push_back(m_obj->FindNearAncestor("auinotebook"));
-    candidates.push_back(m_obj->FindNearAncestor("toolbar"));
-    candidates.push_back(m_obj->FindNearAncestor("wizardpagesimple"));
-    candidates.push_back(m_obj->FindNearAncestorByBaseClass("wxStaticBoxSizer"));
+    // Whitespaces at the very start are ignored
+    IgnoreLeadingWhitespaces();
 
-    for (size_t i = 0; i < candidates.size(); i++) {
-        if (!wxparent) {
-            wxparent = candidates[i];
-        } else {
-            if (candidates[i] && candidates[i]->Depth() > wxparent->Depth())
-                wxparent = candidates[i];
-        }
-        if (wxparent && wxparent->GetClassName() == "wxStaticBoxSizer"
-            && !wxparent->GetProperty("parent")->GetValueAsInteger()) {
-            wxparent = prev_wxparent;
-        }
-        prev_wxparent = wxparent;
-    }
-    return wxparent;
-}
+    // Initial quotation mark
+    if (GetC() != '"')
+        return os;
 
-bool TemplateParser::ParseWxParent()
-{
-    PObjectBase wxparent(GetWxParent());
+    while (!Eof()) {
+        const size_t quote = Find("\"");
+        os.append(m_source, m_pos, quote - m_pos);
+        m_pos = quote;
+        if (Eof())
+            break;
 
-    if (wxparent) {
-        PProperty property = GetRelatedProperty(wxparent);
-#if 0
-        m_out << PropertyToCode(property);
-#endif
-        wxString className = wxparent->GetClassName();
-        if (className == "wxStaticBoxSizer") {
-            // We got a wxStaticBoxSizer as parent,
-            // use the special PT_WXPARENT_SB type to generate code
-            // to get its static box
-            m_out << ValueToCode(PT_WXPARENT_SB, property->GetValueAsString());
-        } else if (className == "wxCollapsiblePane") {
-            // We got a wxCollapsiblePane as parent,
-            // use the special PT_WXPARENT_CP type to generate code
-            // to get its pane
-            m_out << ValueToCode(PT_WXPARENT_CP, property->GetValueAsString());
+        m_pos++;
+        if (Peek() == '"') {
+            // Char (") denoted as ("")
+            m_pos++;
+            os << '"';
         } else {
-            m_out << ValueToCode(PT_WXPARENT, property->GetValueAsString());
+            // Closing, all the following chars are ignored up to an space char,
+            // so we can avoid errors like "hello"world" -> "hello"
+            m_pos = Find(" ");
+            break;
         }
-    } else {
-        ignoreLeadingWhitespaces();
-        ParsePropertyName();
-        m_out << RootWxParentToCode();
     }
-    return true;
+    return os;
 }
 
-bool TemplateParser::ParseForm()
+std::pair<size_t, size_t> TemplateCompiler::ExtractInnerTemplate()
 {
-    PObjectBase form(m_obj);
-    PObjectBase parent(form->GetParent());
+    IgnoreLeadingWhitespaces();
 
-    if (!parent)
-        return false;
+    // The two following characters must be '@{'
+    const wxChar c1 = GetC();
+    const wxChar c2 = GetC();
+    if (c1 != '@' || c2 != '{')
+        return std::make_pair(m_pos, m_pos);
+
+    IgnoreLeadingWhitespaces();
+
+    const size_t begin = m_pos;
+    int level = 1;
+    while (!Eof()) {
+        const size_t escape = Find("@");
+        if (escape + 1 >= m_end)
+            break;
 
-    // form is a form when grandparent is null
-    PObjectBase grandparent = parent->GetParent();
-    while (grandparent) {
-        form = parent;
-        parent = grandparent;
-        grandparent = grandparent->GetParent();
+        // Every '@' escapes the following character
+        const wxChar c = m_source[escape + 1];
+        m_pos = escape + 2;
+        if (c == '}') {
+            if (--level == 0)
+                return std::make_pair(begin, escape);
+        } else if (c == '{') {
+            level++;
+        }
     }
+    // Missing closing brace, the template lasts up to the end
+    m_pos = m_end;
+    return std::make_pair(begin, m_end);
+}
 
-    PProperty property = GetRelatedProperty(form);
-    m_out << PropertyToCode(property);
+PCompiledTemplate TemplateCompiler::CompileInner(const std::pair<size_t, size_t>& range)
+{
+    TemplateCompiler compiler(m_source, range.first, range.second);
+    return compiler.Compile();
+}
 
-    return true;
+size_t TemplateCompiler::Find(const char* chars) const
+{
+    const size_t found = m_source.find_first_of(chars, m_pos);
+    return (found == wxString::npos || found > m_end) ? m_end : found;
 }
 
-void TemplateParser::ParseLuaTable()
+PCompiledTemplate CompiledTemplate::Compile(const wxString& source)
 {
-    const auto& project = AppData()->GetProjectData();
-    const auto& table = project->GetProperty("ui_table");
-    if (table) {
-        auto strTableName = table->GetValueAsString();
-        if (strTableName.empty())
-            strTableName = "UI";
+    TemplateCompiler compiler(source, 0, source.length());
+    return compiler.Compile();
+}
 
-        m_out << strTableName << ".";
-    }
+TemplateParser::TemplateParser(PObjectBase obj, const wxString& _template)
+    : TemplateParser(obj, CompiledTemplate::Compile(_template))
+{
 }
 
-bool TemplateParser::ParseParent()
+TemplateParser::TemplateParser(PObjectBase obj, PCompiledTemplate _template)
+    : m_obj(obj)
+    , m_template(_template)
+    , m_indent(0)
 {
-    PObjectBase parent(m_obj->GetParent());
-    if (parent) {
-        PProperty property = GetRelatedProperty(parent);
-        m_out << PropertyToCode(property);
-    } else {
-        m_out << "ERROR";
-    }
-    return true;
 }
 
-bool TemplateParser::ParseChild()
+TemplateParser::TemplateParser(const TemplateParser& other, PCompiledTemplate _template)
+    : m_obj(other.m_obj)
+    , m_template(_template)
+    , m_overrides(other.m_overrides)
+    , m_indent(0)
 {
-    // Get the first child
-    PObjectBase child(m_obj->GetChild(0));
+}
 
-    if (child) {
-        PProperty property = GetRelatedProperty(child);
-        m_out << PropertyToCode(property);
-    } else
-        m_out << RootWxParentToCode();
+TemplateParser::~TemplateParser() = default;
 
-    return true;
+void TemplateParser::SetPropertyOverrides(const PropertyOverrides& overrides)
+{
+    for (const auto& value : overrides) {
+        PProperty property = m_obj->GetProperty(value.first);
+        if (!property)
+            continue;
+
+        // Detached copy, the original property is shared with the other parsers
+        PProperty copy = std::make_shared<Property>(*property);
+        copy->SetValue(value.second);
+        m_overrides[value.first] = copy;
+    }
 }
 
-PProperty TemplateParser::GetRelatedProperty(PObjectBase relative)
+PProperty TemplateParser::GetProperty(const wxString& name)
 {
-    ignoreLeadingWhitespaces();
-    wxString propname = ParsePropertyName();
-    return relative->GetProperty(propname);
+    if (!m_overrides.empty()) {
+        auto it = m_overrides.find(name);
+        if (it != m_overrides.end())
+            return it->second;
+    }
+    return m_obj->GetProperty(name);
 }
 
-bool TemplateParser::ParseForEach()
+wxString TemplateParser::ParseTemplate()
 {
-    // Whitespaces at the very start are ignored
-    ignoreLeadingWhitespaces();
-
-    // parsing the property
-    if (GetNextToken() == TOK_PROPERTY) {
-        wxString propname = ParsePropertyName();
-        wxString inner_template = ExtractInnerTemplate();
-
-        PProperty property = m_obj->GetProperty(propname);
-        wxString propvalue = property->GetValueAsString();
-
-        // Property value must be an string using ',' as separator.
-        // The template will be generated nesting as many times as
-        // tokens were found in the property value.
-
-        if (property->GetType() == PT_INTLIST
-            || property->GetType() == PT_UINTLIST
-            || property->GetType() == PT_INTPAIRLIST
-            || property->GetType() == PT_UINTPAIRLIST) {
-
-            // For doing that we will use wxStringTokenizer class from wxWidgets
-            wxStringTokenizer tkz(propvalue, ",");
-            int i = 0;
-            while (tkz.HasMoreTokens()) {
-                wxString token;
-                token = tkz.GetNextToken();
-                token.Trim(true);
-                token.Trim(false);
-
-                // Pair values get interpreted as adjacent parameters,
-                // all supported languages use comma as parameter separator
-                token.Replace(":", ", ");
-
-                // Parsing the internal template
-                {
-                    wxString code;
-                    PTemplateParser parser = CreateParser(this, inner_template);
-                    parser->SetPredefined(token, wxString::Format("%i", i++));
-                    code = parser->ParseTemplate();
-                    m_out << "\n"
-                          << code;
+    typedef CompiledTemplate::Opcode Opcode;
+
+    // Result of the property lookups of the conditional macros
+    PProperty property;
+    wxString childName;
+    try {
+        const std::vector<Instruction>& instructions = m_template->m_instructions;
+        size_t index = instructions.empty() ? CompiledTemplate::End : 0;
+        while (index != CompiledTemplate::End) {
+            const Instruction& instruction = instructions[index];
+            index = instruction.next;
+
+            switch (instruction.op) {
+            case Opcode::Jump:
+                break;
+            case Opcode::Text:
+                m_out << instruction.text;
+                break;
+            case Opcode::Property:
+                ParseProperty(instruction);
+                break;
+            case Opcode::Error:
+                wxWEAVER_THROW_EX(instruction.text);
+                break;
+            case Opcode::LogError:
+                wxLogError(instruction.text);
+                break;
+            case Opcode::WxParent:
+                ParseWxParent(instruction);
+                break;
+            case Opcode::Parent:
+            case Opcode::Form:
+            case Opcode::Child: {
+                PObjectBase relative;
+                if (instruction.op == Opcode::Form)
+                    relative = GetForm();
+                else
+                    relative = GetRelative(instruction.op == Opcode::Parent
+                                               ? CompiledTemplate::Relative::Parent
+                                               : CompiledTemplate::Relative::Child);
+                if (relative) {
+                    m_out << PropertyToCode(relative->GetProperty(instruction.text));
+                } else {
+                    if (instruction.op == Opcode::Parent)
+                        m_out << "ERROR";
+                    else if (instruction.op == Opcode::Child)
+                        m_out << RootWxParentToCode();
+
+                    index = instruction.alternative;
                 }
+                break;
             }
-        } else if (property->GetType() == PT_STRINGLIST) {
-            wxArrayString array = property->GetValueAsArrayString();
-            for (size_t i = 0; i < array.Count(); i++) {
-                wxString code;
-                PTemplateParser parser = CreateParser(this, inner_template);
-                parser->SetPredefined(
-                    ValueToCode(PT_WXSTRING_I18N, array[i]),
-                    wxString::Format("%i", i));
+            case Opcode::LookupRelative: {
+                PObjectBase relative = GetRelative(instruction.relative);
+                property = relative ? relative->GetProperty(instruction.text) : PProperty();
+                childName.clear();
+                if (!relative)
+                    index = instruction.alternative;
 
-                code = parser->ParseTemplate();
-                m_out << "\n"
-                      << code;
+                break;
             }
-        } else
-            wxLogError("Property type not compatible with \"foreach\" macro");
-    }
-    return true;
-}
+            case Opcode::LookupProperty:
+                property = GetProperty(instruction.text);
+                childName = instruction.child;
+                if (!property)
+                    index = instruction.alternative;
 
-PProperty TemplateParser::GetProperty(wxString* childName)
-{
-    PProperty property;
+                break;
+            case Opcode::IfFound:
+                if (!property)
+                    index = instruction.alternative;
+
+                break;
+            case Opcode::IfNotNull:
+                if (!property->IsNull()) {
+                    if (childName.empty() || !property->GetChildFromParent(childName).empty())
+                        ParseInnerTemplate(instruction);
+                }
+                break;
+            case Opcode::IfNull:
+                if (property->IsNull()
+                    || (!childName.empty() && property->GetChildFromParent(childName).empty()))
+                    ParseInnerTemplate(instruction);
+
+                break;
+            case Opcode::IfEqual:
+            case Opcode::IfNotEqual: {
+                const wxString propValue = childName.empty()
+                    ? property->GetValueAsString()
+                    : property->GetChildFromParent(childName);
 
-    // Check for #wxparent, #parent, or #child
-    if (GetNextToken() == TOK_MACRO) {
-        try {
-            Ident ident = ParseIdent();
-            switch (ident) {
-            case ID_WXPARENT: {
-                PObjectBase wxparent(GetWxParent());
-                if (wxparent)
-                    property = GetRelatedProperty(wxparent);
+                if (instruction.op == Opcode::IfEqual
+                        ? IsEqual(propValue, instruction.text)
+                        : propValue != instruction.text)
+                    ParseInnerTemplate(instruction);
 
                 break;
             }
-            case ID_PARENT: {
+            case Opcode::ForEach:
+                ParseForEach(instruction);
+                break;
+            case Opcode::Pred:
+                m_out << m_pred;
+                break;
+            case Opcode::NPred:
+                m_out << m_npred;
+                break;
+            case Opcode::NewLine:
+                ParseNewLine();
+                break;
+            case Opcode::IfParentTypeEqual:
+            case Opcode::IfParentTypeNotEqual:
+            case Opcode::IfParentClassEqual:
+            case Opcode::IfParentClassNotEqual: {
                 PObjectBase parent(m_obj->GetParent());
-                if (parent)
-                    property = GetRelatedProperty(parent);
-
+                if (parent) {
+                    const bool byType = (instruction.op == Opcode::IfParentTypeEqual
+                                         || instruction.op == Opcode::IfParentTypeNotEqual);
+                    const bool equal = IsEqual(
+                        byType ? parent->GetTypeName() : parent->GetClassName(),
+                        instruction.text);
+
+                    if (equal == (instruction.op == Opcode::IfParentTypeEqual
+                                  || instruction.op == Opcode::IfParentClassEqual))
+                        ParseInnerTemplate(instruction);
+                }
                 break;
             }
-            case ID_CHILD: {
-                PObjectBase child(m_obj->GetChild(0));
-                if (child)
-                    property = GetRelatedProperty(child);
+            case Opcode::IfTypeEqual:
+            case Opcode::IfTypeNotEqual:
+                if (IsEqual(m_obj->GetTypeName(), instruction.text)
+                    == (instruction.op == Opcode::IfTypeEqual))
+                    ParseInnerTemplate(instruction);
 
                 break;
-            }
-            default:
+            case Opcode::Append:
+                ParseAppend();
                 break;
-            }
-        } catch (wxWeaverException& ex) {
-            wxLogError(ex.what());
-        }
-    }
+            case Opcode::Class:
+                ParseClass();
+                break;
+            case Opcode::Indent:
+                m_indent++;
+                break;
+            case Opcode::Unindent:
+                m_indent--;
+                if (m_indent < 0)
+                    m_indent = 0;
 
-    if (!property) {
-        if (GetNextToken() == TOK_PROPERTY) {
-            wxString propname = ParsePropertyName(childName);
-            property = m_obj->GetProperty(propname);
+                break;
+            case Opcode::LuaTable:
+                ParseLuaTable();
+                break;
+            }
         }
+    } catch (wxWeaverException& ex) {
+        wxLogError(ex.what());
     }
-    return property;
+    return m_out;
 }
 
-void TemplateParser::ignoreLeadingWhitespaces()
+void TemplateParser::ParseInnerTemplate(const Instruction& instruction)
 {
-    wxChar peek(m_in.Peek());
-    while (peek != wxChar(EOF) && !m_in.Eof() && peek == ' ') {
-        m_in.GetC();
-        peek = wxChar(m_in.Peek());
-    }
+    // Generate the code from the block
+    PTemplateParser parser = CreateParser(this, instruction.inner);
+    m_out << parser->ParseTemplate();
 }
 
-bool TemplateParser::ParseIfNotNull()
+void TemplateParser::ParseProperty(const Instruction& instruction)
 {
-    ignoreLeadingWhitespaces();
-
-    // Get the property
-    wxString childName;
-    PProperty property(GetProperty(&childName));
-    if (!property)
-        return false;
-
-    wxString innerTemplate = ExtractInnerTemplate();
-
-    if (!property->IsNull()) {
-        if (!childName.empty()) {
-            if (property->GetChildFromParent(childName).empty())
-                return true;
-        }
-        // Generate the code from the block
-        PTemplateParser parser = CreateParser(this, innerTemplate);
-        m_out << parser->ParseTemplate();
+    PProperty property = GetProperty(instruction.text);
+    if (!property) {
+        wxLogError("The property '%s' does not exist for objects of class '%s'",
+                   instruction.text.c_str(), m_obj->GetClassName().c_str());
+        return;
     }
-    return true;
-}
-
-bool TemplateParser::ParseIfNull()
-{
-    ignoreLeadingWhitespaces();
-
-    // Get the property
-    wxString childName;
-    PProperty property(GetProperty(&childName));
-    if (!property)
-        return false;
-
-    wxString inner_template = ExtractInnerTemplate();
-
-    if (property->IsNull()) {
-        // Generate the code from the block
-        PTemplateParser parser = CreateParser(this, inner_template);
-        m_out << parser->ParseTemplate();
+    if (instruction.child.empty()) {
+        wxString code = PropertyToCode(property);
+        m_out << code;
     } else {
-        if (!childName.empty()) {
-            if (property->GetChildFromParent(childName).empty()) {
-                // Generate the code from the block
-                PTemplateParser parser = CreateParser(this, inner_template);
-                m_out << parser->ParseTemplate();
-            }
-        }
-    }
-    return true;
-}
-
-wxString TemplateParser::ExtractLiteral()
-{
-    wxString os;
-    wxChar c;
-
-    // Whitespaces at the very start are ignored
-    ignoreLeadingWhitespaces();
-
-    c = wxChar(m_in.GetC()); // Initial quotation mark
-
-    if (c == '"') {
-        bool end = false;
-        // Beginning the template extraction
-        while (!end && !m_in.Eof() && m_in.Peek() != EOF) {
-            c = wxChar(m_in.GetC()); // obtaining one char
-
-            // Checking for a possible closing quotation mark
-            if (c == '"') {
-                if (m_in.Peek() == '"') // Char (") denoted as ("")
-                {
-                    m_in.GetC(); // Second quotation mark is ignored
-                    os << '"';
-                } else // Closing
-                {
-                    end = true;
-
-                    // All the following chars are ignored up to an space char,
-                    // so we can avoid errors like "hello"world" -> "hello"
-                    wxChar peek(m_in.Peek());
-                    while (peek != wxChar(EOF) && !m_in.Eof() && peek != ' ') {
-                        m_in.GetC();
-                        peek = wxChar(m_in.Peek());
-                    }
-                }
-            } else // one char from literal (N.B. ??)
-                os << c;
-        }
+        m_out << property->GetChildFromParent(instruction.child);
     }
-    return os;
+#if 0
+    LogDebug("parsing property %s", instruction.text.c_str());
+#endif
 }
 
-bool TemplateParser::ParseIfEqual()
+PObjectBase TemplateParser::GetWxParent()
 {
-    // ignore leading whitespace
-    ignoreLeadingWhitespaces();
-
-    // Get the property
-    wxString childName;
-    PProperty property(GetProperty(&childName));
-    if (property) {
-        // Get the value to compare to
-        wxString value = ExtractLiteral();
-
-        // Get the template to generate if comparison is true
-        wxString inner_template = ExtractInnerTemplate();
-
-        // Get the value of the property
-        wxString propValue;
-        if (childName.empty())
-            propValue = property->GetValueAsString();
-        else
-            propValue = property->GetChildFromParent(childName);
-
-        // Compare
-        //if ( propValue == value )
-        if (IsEqual(propValue, value)) {
-            // Generate the code
-            PTemplateParser parser = CreateParser(this, inner_template);
-            m_out << parser->ParseTemplate();
-            return true;
-        }
-    }
-    return false;
-}
+    PObjectBase wxparent, prev_wxparent;
 
-bool TemplateParser::ParseIfNotEqual()
-{
-    ignoreLeadingWhitespaces();
+    std::vector<PObjectBase> candidates;
+    candidates.push_back(m_obj->FindNearAncestor("container"));
+    candidates.push_back(m_obj->FindNearAncestor("notebook"));
+    candidates.push_back(m_obj->FindNearAncestor("splitter"));
+    candidates.push_back(m_obj->FindNearAncestor("listbook"));
+    candidates.push_back(m_obj->FindNearAncestor("choicebook"));
+    candidates.push_back(m_obj->FindNearAncestor("simplebook"));
+    candidates.push_back(m_obj->FindNearAncestor("toolbook"));
+    candidates.push_back(m_obj->FindNearAncestor("treebook"));
+    candidates.push_back(m_obj->FindNearAncestor("auinotebook"));
+    candidates.push_back(m_obj->FindNearAncestor("toolbar"));
+    candidates.push_back(m_obj->FindNearAncestor("wizardpagesimple"));
+    candidates.push_back(m_obj->FindNearAncestorByBaseClass("wxStaticBoxSizer"));
 
-    // Get the property
-    wxString childName;
-    PProperty property(GetProperty(&childName));
-    if (property) {
-        // Get the value to compare to
-        wxString value = ExtractLiteral();
-
-        // Get the template to generate if comparison is false
-        wxString inner_template = ExtractInnerTemplate();
-
-        // Get the value of the property
-        wxString propValue;
-        if (childName.empty()) {
-            propValue = property->GetValueAsString();
+    for (size_t i = 0; i < candidates.size(); i++) {
+        if (!wxparent) {
+            wxparent = candidates[i];
         } else {
-            propValue = property->GetChildFromParent(childName);
+            if (candidates[i] && candidates[i]->Depth() > wxparent->Depth())
+                wxparent = candidates[i];
         }
-
-        // Compare
-        if (propValue != value) {
-            // Generate the code
-            PTemplateParser parser = CreateParser(this, inner_template);
-            m_out << parser->ParseTemplate();
-            ;
-            return true;
+        if (wxparent && wxparent->GetClassName() == "wxStaticBoxSizer"
+            && !wxparent->GetProperty("parent")->GetValueAsInteger()) {
+            wxparent = prev_wxparent;
         }
+        prev_wxparent = wxparent;
     }
-    return false;
+    return wxparent;
 }
 
-bool TemplateParser::ParseIfParentTypeEqual()
+PObjectBase TemplateParser::GetForm()
 {
-    PObjectBase parent(m_obj->GetParent());
-
-    // get examined type name
-    wxString type = ExtractLiteral();
+    PObjectBase form(m_obj);
+    PObjectBase parent(form->GetParent());
 
-    // get the template to generate if comparison is true
-    wxString inner_template = ExtractInnerTemplate();
+    if (!parent)
+        return PObjectBase();
 
-    // compare give type name with type of the wx parent object
-    if (parent && IsEqual(parent->GetTypeName(), type)) {
-        // generate the code
-        PTemplateParser parser = CreateParser(this, inner_template);
-        m_out << parser->ParseTemplate();
-        return true;
+    // form is a form when grandparent is null
+    PObjectBase grandparent = parent->GetParent();
+    while (grandparent) {
+        form = parent;
+        parent = grandparent;
+        grandparent = grandparent->GetParent();
     }
-    return false;
+    return form;
 }
 
-bool TemplateParser::ParseIfParentTypeNotEqual()
+PObjectBase TemplateParser::GetRelative(CompiledTemplate::Relative relative)
 {
-    PObjectBase parent(m_obj->GetParent());
+    switch (relative) {
+    case CompiledTemplate::Relative::WxParent:
+        return GetWxParent();
+    case CompiledTemplate::Relative::Parent:
+        return m_obj->GetParent();
+    case CompiledTemplate::Relative::Child:
+        // Get the first child
+        if (m_obj->GetChildCount() > 0)
+            return m_obj->GetChild(0);
 
-    // get examined type name
-    wxString type = ExtractLiteral();
-
-    // get the template to generate if comparison is true
-    wxString inner_template = ExtractInnerTemplate();
-
-    // compare give type name with type of the wx parent object
-    if (parent && !IsEqual(parent->GetTypeName(), type)) {
-        // generate the code
-        PTemplateParser parser = CreateParser(this, inner_template);
-        m_out << parser->ParseTemplate();
-        return true;
+        break;
     }
-
-    return false;
+    return PObjectBase();
 }
 
-bool TemplateParser::ParseIfParentClassEqual()
+void TemplateParser::ParseWxParent(const Instruction& instruction)
 {
-    PObjectBase parent(m_obj->GetParent());
-
-    // get examined type name
-    wxString type = ExtractLiteral();
-
-    // get the template to generate if comparison is true
-    wxString inner_template = ExtractInnerTemplate();
-
-    // compare give type name with type of the wx parent object
-    if (parent && IsEqual(parent->GetClassName(), type)) {
-        // generate the code
-        PTemplateParser parser = CreateParser(this, inner_template);
-        m_out << parser->ParseTemplate();
-        return true;
+    PObjectBase wxparent(GetWxParent());
+    if (!wxparent) {
+        m_out << RootWxParentToCode();
+        return;
     }
-    return false;
-}
-
-bool TemplateParser::ParseIfParentClassNotEqual()
-{
-    PObjectBase parent(m_obj->GetParent());
-
-    // get examined type name
-    wxString type = ExtractLiteral();
-
-    // get the template to generate if comparison is true
-    wxString inner_template = ExtractInnerTemplate();
-
-    // compare give type name with type of the wx parent object
-    if (parent && !IsEqual(parent->GetClassName(), type)) {
-        // generate the code
-        PTemplateParser parser = CreateParser(this, inner_template);
-        m_out << parser->ParseTemplate();
-        return true;
+    PProperty property = wxparent->GetProperty(instruction.text);
+    if (!property)
+        return;
+
+    wxString className = wxparent->GetClassName();
+    if (className == "wxStaticBoxSizer") {
+        // We got a wxStaticBoxSizer as parent,
+        // use the special PT_WXPARENT_SB type to generate code
+        // to get its static box
+        m_out << ValueToCode(PT_WXPARENT_SB, property->GetValueAsString());
+    } else if (className == "wxCollapsiblePane") {
+        // We got a wxCollapsiblePane as parent,
+        // use the special PT_WXPARENT_CP type to generate code
+        // to get its pane
+        m_out << ValueToCode(PT_WXPARENT_CP, property->GetValueAsString());
+    } else {
+        m_out << ValueToCode(PT_WXPARENT, property->GetValueAsString());
     }
-    return false;
 }
 
-bool TemplateParser::ParseIfTypeEqual()
+void TemplateParser::ParseLuaTable()
 {
-    // get examined type name
-    wxString type = ExtractLiteral();
-
-    // get the template to generate if comparison is true
-    wxString inner_template = ExtractInnerTemplate();
-
-    // compare give type name with type of the wx parent object
-    if (IsEqual(m_obj->GetTypeName(), type)) {
-        // generate the code
-        PTemplateParser parser = CreateParser(this, inner_template);
-        m_out << parser->ParseTemplate();
-        return true;
-    }
-    return false;
-}
+    const auto& project = AppData()->GetProjectData();
+    const auto& table = project->GetProperty("ui_table");
+    if (table) {
+        auto strTableName = table->GetValueAsString();
+        if (strTableName.empty())
+            strTableName = "UI";
 
-bool TemplateParser::ParseIfTypeNotEqual()
-{
-    // get examined type name
-    wxString type = ExtractLiteral();
-
-    // get the template to generate if comparison is true
-    wxString inner_template = ExtractInnerTemplate();
-
-    // compare give type name with type of the wx parent object
-    if (!IsEqual(m_obj->GetTypeName(), type)) {
-        // generate the code
-        PTemplateParser parser = CreateParser(this, inner_template);
-        m_out << parser->ParseTemplate();
-        return true;
+        m_out << strTableName << ".";
     }
-    return false;
 }
 
-TemplateParser::Ident TemplateParser::SearchIdent(wxString ident)
+void TemplateParser::ParseForEach(const Instruction& instruction)
 {
-    //  LogDebug("Parsing command %s",ident.c_str());
-
-    if (ident == "wxparent")
-        return ID_WXPARENT;
-    else if (ident == "ifnotnull")
-        return ID_IFNOTNULL;
-    else if (ident == "ifnull")
-        return ID_IFNULL;
-    else if (ident == "foreach")
-        return ID_FOREACH;
-    else if (ident == "pred")
-        return ID_PREDEFINED;
-    else if (ident == "npred")
-        return ID_PREDEFINED_INDEX;
-    else if (ident == "child")
-        return ID_CHILD;
-    else if (ident == "parent")
-        return ID_PARENT;
-    else if (ident == "nl")
-        return ID_NEWLINE;
-    else if (ident == "ifequal")
-        return ID_IFEQUAL;
-    else if (ident == "ifnotequal")
-        return ID_IFNOTEQUAL;
-    else if (ident == "ifparenttypeequal")
-        return ID_IFPARENTTYPEEQUAL;
-    else if (ident == "ifparentclassequal")
-        return ID_IFPARENTCLASSEQUAL;
-    else if (ident == "ifparenttypenotequal")
-        return ID_IFPARENTTYPENOTEQUAL;
-    else if (ident == "ifparentclassnotequal")
-        return ID_IFPARENTCLASSNOTEQUAL;
-    else if (ident == "append")
-        return ID_APPEND;
-    else if (ident == "class")
-        return ID_CLASS;
-    else if (ident == "form" || ident == "wizard")
-        return ID_FORM;
-    else if (ident == "indent")
-        return ID_INDENT;
-    else if (ident == "unindent")
-        return ID_UNINDENT;
-    else if (ident == "iftypeequal")
-        return ID_IFTYPEEQUAL;
-    else if (ident == "iftypenotequal")
-        return ID_IFTYPENOTEQUAL;
-    else if (ident == "utbl")
-        return ID_UTBL;
-    else
-        wxWEAVER_THROW_EX(wxString::Format("Unknown macro: \"%s\"", ident.c_str()));
-}
-
-wxString TemplateParser::ParseTemplate()
-{
-    try {
-        while (!m_in.Eof()) {
-            Token token = GetNextToken();
-            switch (token) {
-            case TOK_MACRO:
-                ParseMacro();
-                break;
-            case TOK_PROPERTY:
-                ParseProperty();
-                break;
-            case TOK_TEXT:
-                ParseText();
-                break;
-            default:
-                return wxEmptyString;
-            }
-        }
-    } catch (wxWeaverException& ex) {
-        wxLogError(ex.what());
+    PProperty property = GetProperty(instruction.text);
+    if (!property) {
+        wxLogError("The property '%s' does not exist for objects of class '%s'",
+                   instruction.text.c_str(), m_obj->GetClassName().c_str());
+        return;
     }
-    return m_out;
-}
-
-/**
-* Obtaining the template enclosed between '@{' y '@}'.
-* Note: whitespaces at the very start will be ignored.
-*/
-wxString TemplateParser::ExtractInnerTemplate()
-{
-    wxString os;
-    wxChar c1, c2;
-    ignoreLeadingWhitespaces();
-
-    // The two following characters must be '@{'
-    c1 = wxChar(m_in.GetC());
-    c2 = wxChar(m_in.GetC());
-
-    if (c1 == '@' && c2 == '{') {
-        ignoreLeadingWhitespaces();
-
-        int level = 1;
-        bool end = false;
-        // Beginning with the template extraction
-        while (!end && !m_in.Eof() && m_in.Peek() != EOF) {
-            c1 = wxChar(m_in.GetC());
-
-            // Checking if there are initial or closing braces
-            if (c1 == '@') {
-                c2 = wxChar(m_in.GetC());
-
-                if (c2 == '}') {
-                    level--;
-                    if (!level) {
-                        end = true;
-                    } else {
-                        // There isn't a final closing brace, so that we put in
-                        // the chars and continue
-                        os << c1;
-                        os << c2;
-                    }
-                } else {
-                    os << c1;
-                    os << c2;
-
-                    if (c2 == '{')
-                        level++;
-                }
-            } else {
-                os << c1;
+    wxString propvalue = property->GetValueAsString();
+
+    // Property value must be an string using ',' as separator.
+    // The template will be generated nesting as many times as
+    // tokens were found in the property value.
+
+    if (property->GetType() == PT_INTLIST
+        || property->GetType() == PT_UINTLIST
+        || property->GetType() == PT_INTPAIRLIST
+        || property->GetType() == PT_UINTPAIRLIST) {
+
+        // For doing that we will use wxStringTokenizer class from wxWidgets
+        wxStringTokenizer tkz(propvalue, ",");
+        int i = 0;
+        while (tkz.HasMoreTokens()) {
+            wxString token;
+            token = tkz.GetNextToken();
+            token.Trim(true);
+            token.Trim(false);
+
+            // Pair values get interpreted as adjacent parameters,
+            // all supported languages use comma as parameter separator
+            token.Replace(":", ", ");
+
+            // Parsing the internal template
+            {
+                wxString code;
+                PTemplateParser parser = CreateParser(this, instruction.inner);
+                parser->SetPredefined(token, wxString::Format("%i", i++));
+                code = parser->ParseTemplate();
+                m_out << "\n"
+                      << code;
             }
         }
-    }
-    return os;
-}
-
-bool TemplateParser::ParsePred()
-{
-    if (!m_pred.empty())
-        m_out << m_pred;
-
-    return true;
-}
-
-bool TemplateParser::ParseNPred()
-{
-    if (!m_npred.empty())
-        m_out << m_npred;
-
-    return true;
+    } else if (property->GetType() == PT_STRINGLIST) {
+        wxArrayString array = property->GetValueAsArrayString();
+        for (size_t i = 0; i < array.Count(); i++) {
+            wxString code;
+            PTemplateParser parser = CreateParser(this, instruction.inner);
+            parser->SetPredefined(
+                ValueToCode(PT_WXSTRING_I18N, array[i]),
+                wxString::Format("%i", i));
+
+            code = parser->ParseTemplate();
+            m_out << "\n"
+                  << code;
+        }
+    } else
+        wxLogError("Property type not compatible with \"foreach\" macro");
 }
 
-bool TemplateParser::ParseNewLine()
+void TemplateParser::ParseNewLine()
 {
     m_out << '\n';
 
@@ -964,13 +937,10 @@ bool TemplateParser::ParseNewLine()
     // (will be replace by '\t' in code writer)
     for (int i = 0; i < m_indent; i++)
         m_out << "%TAB%";
-
-    return true;
 }
 
 void TemplateParser::ParseAppend()
 {
-    ignoreLeadingWhitespaces();
     /*
     NOTE: This macro is usually used to attach some postfix to a name
           to create another unique name.
@@ -998,7 +968,7 @@ void TemplateParser::ParseAppend()
 
 void TemplateParser::ParseClass()
 {
-    PProperty subclass_prop = m_obj->GetProperty("subclass");
+    PProperty subclass_prop = GetProperty("subclass");
     if (subclass_prop) {
         wxString subclass = subclass_prop->GetChildFromParent("name");
         if (!subclass.empty()) {
@@ -1009,19 +979,6 @@ void TemplateParser::ParseClass()
     m_out << ValueToCode(PT_CLASS, m_obj->GetClassName());
 }
 
-void TemplateParser::ParseIndent()
-{
-    m_indent++;
-}
-
-void TemplateParser::ParseUnindent()
-{
-    m_indent--;
-
-    if (m_indent < 0)
-        m_indent = 0;
-}
-
 wxString TemplateParser::PropertyToCode(PProperty property)
 {
     if (property)
@@ -1046,6 +1003,50 @@ bool TemplateParser::IsEqual(const wxString& value, const wxString& set)
     return contains;
 }
 
+uint64_t FormCodeCache::GetSettingsKey(PObjectBase project, const wxString& generator)
+{
+    uint64_t hash = FileUtils::HashString(generator);
+    hash = FileUtils::HashString(AppData()->GetProjectPath(), hash);
+    return project->Hash(hash, false);
+}
+
+uint64_t FormCodeCache::GetKey(PObjectBase form, uint64_t settingsKey)
+{
+    return form->Hash(settingsKey);
+}
+
+bool FormCodeCache::Find(uint64_t key, Fragments* fragments)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(key);
+    if (it == m_entries.end())
+        return false;
+
+    it->second.generation = m_generation;
+    *fragments = it->second.fragments;
+    return true;
+}
+
+void FormCodeCache::Insert(uint64_t key, const Fragments& fragments)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Entry& entry = m_entries[key];
+    entry.fragments = fragments;
+    entry.generation = m_generation;
+}
+
+void FormCodeCache::Prune()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (m_generation - it->second.generation >= MaxAge)
+            it = m_entries.erase(it);
+        else
+            ++it;
+    }
+    m_generation++;
+}
+
 CodeGenerator::~CodeGenerator() = default;
 
 void CodeGenerator::FindArrayObjects(PObjectBase obj, ArrayItems& arrays, bool skipRoot)
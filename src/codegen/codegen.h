@@ -23,9 +23,10 @@
 #include "rtti/types.h"
 #include "utils/defs.h"
 
-#include <wx/sstream.h>
-
+#include <cstdint>
 #include <map>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 /** Template notes
@@ -78,12 +79,97 @@
   - #npred (see #foreach)
 */
 
+/** Template compiled into a list of instructions.
+
+    Templates are parsed once into instructions linked by the index of the one
+    to execute next, which TemplateParser then runs against each object.
+    Macros that leave their arguments unparsed when their object or property
+    is missing (e.g. #parent on a form) continue at an alternative instruction,
+    compiled from the same source position the old character parser would
+    have continued from.
+
+    A compiled template is immutable, so it can be cached (see CodeInfo) and
+    shared by parsers running on different threads.
+*/
+class CompiledTemplate {
+public:
+    /** Compiles @a source, never fails: unknown macros compile to an
+        instruction reporting the error when the template is run.
+    */
+    static PCompiledTemplate Compile(const wxString& source);
+
+    bool IsEmpty() const { return m_instructions.empty(); }
+
+private:
+    friend class TemplateCompiler;
+    friend class TemplateParser;
+
+    static const size_t End = static_cast<size_t>(-1);
+
+    enum class Opcode {
+        Jump,
+        Text,
+        Property,
+        Error,
+        LogError,
+        WxParent,
+        Parent,
+        Form,
+        Child,
+        LookupRelative, // Finds a property of #wxparent, #parent or #child
+        LookupProperty, // Finds a property of the object
+        IfFound,
+        IfNotNull,
+        IfNull,
+        IfEqual,
+        IfNotEqual,
+        ForEach,
+        Pred,
+        NPred,
+        NewLine,
+        IfParentTypeEqual,
+        IfParentTypeNotEqual,
+        IfParentClassEqual,
+        IfParentClassNotEqual,
+        IfTypeEqual,
+        IfTypeNotEqual,
+        Append,
+        Class,
+        Indent,
+        Unindent,
+        LuaTable
+    };
+
+    enum class Relative {
+        WxParent,
+        Parent,
+        Child
+    };
+
+    struct Instruction {
+        Opcode op = Opcode::Jump;
+        Relative relative = Relative::Parent;
+        wxString text;  // Text, property name, literal or error message
+        wxString child; // Child of a parent property, e.g. $parent/child
+        PCompiledTemplate inner;
+        size_t next = End;
+        size_t alternative = End; // When the object or property is missing
+    };
+
+    std::vector<Instruction> m_instructions; // The first one is the entry point
+};
+
 /** Template Parser
 */
 class TemplateParser {
 public:
-    TemplateParser(PObjectBase obj, wxString _template);
-    TemplateParser(const TemplateParser& that, wxString _template);
+    /** Property values replacing those of the object, by property name.
+    */
+    typedef std::map<wxString, wxString> PropertyOverrides;
+
+    TemplateParser(PObjectBase obj, const wxString& _template);
+    TemplateParser(PObjectBase obj, PCompiledTemplate _template);
+    TemplateParser(const TemplateParser& that, PCompiledTemplate _template);
     virtual ~TemplateParser();
 
     /** Returns the code for a property value in the language format.
@@ -96,7 +182,7 @@ public:
     */
     virtual PTemplateParser CreateParser(
         const TemplateParser* oldparser,
-        wxString _template)
+        PCompiledTemplate _template)
         = 0;
 
     /** Returns the code for a "wxWindow* parent" root attribute' name.
@@ -109,7 +195,7 @@ public:
     */
     virtual wxString ValueToCode(PropertyType type, wxString value) = 0;
 
-    /** The "star" function for this class. Analyzes a template, returning the code.
+    /** The "star" function for this class. Runs the template, returning the code.
     */
     wxString ParseTemplate();
 
@@ -121,117 +207,94 @@ public:
         m_npred = npred;
     }
 
-private:
-    typedef enum {
-        TOK_ERROR,
-        TOK_MACRO,
-        TOK_TEXT,
-        TOK_PROPERTY
-    } Token;
-
-    typedef enum {
-        ID_ERROR,
-        ID_WXPARENT,
-        ID_PARENT,
-        ID_FORM,
-        ID_CHILD,
-        ID_IFNOTNULL,
-        ID_IFNULL,
-        ID_FOREACH,
-        ID_PREDEFINED,       // predefined symbol '#pred'
-        ID_PREDEFINED_INDEX, // #npred
-        ID_NEWLINE,
-        ID_IFEQUAL,
-        ID_IFNOTEQUAL,
-        ID_IFPARENTTYPEEQUAL,
-        ID_IFPARENTTYPENOTEQUAL,
-        ID_IFPARENTCLASSEQUAL,
-        ID_IFPARENTCLASSNOTEQUAL,
-        ID_APPEND,
-        ID_CLASS,
-        ID_INDENT,
-        ID_UNINDENT,
-        ID_IFTYPEEQUAL,
-        ID_IFTYPENOTEQUAL,
-        ID_UTBL
-    } Ident;
-
-    void ignoreLeadingWhitespaces();
+    /** Makes the template see the given values for some properties of the
+        object, which itself is left untouched so that it can be shared by
+        parsers running in other threads.
 
-    bool IsEqual(const wxString& value, const wxString& set);
-
-    Ident SearchIdent(wxString ident);
-    Ident ParseIdent();
+        The overrides also apply to the parsers of the nested blocks.
+    */
+    void SetPropertyOverrides(const PropertyOverrides& overrides);
 
-    wxString ParsePropertyName(wxString* child = nullptr);
+private:
+    typedef CompiledTemplate::Instruction Instruction;
 
-    /** This routine extracts the source code from a template enclosed between
-        the #begin and #end macros, having in mind that they can be nested
+    /** Gets a property of the object, honoring the overrides.
     */
-    wxString ExtractInnerTemplate();
+    PProperty GetProperty(const wxString& name);
 
-    /** A literal value is an string enclosed between '"' (e.g. "xxx"),
-        The " character is represented with "".
-    */
-    wxString ExtractLiteral();
+    bool IsEqual(const wxString& value, const wxString& set);
 
-    /** Look up for the following symbol from input and returns the token.
-        @return TOK_MACRO when it's followed by a command.
-                TOK_PROPERTY when it's followed by a property.
-                TOK_TEXT when it's followed by normal text.
+    PObjectBase GetWxParent();
+    PObjectBase GetForm();
+    PObjectBase GetRelative(CompiledTemplate::Relative relative);
+
+    /** Runs the inner template of a block, which gets its own parser.
     */
-    Token GetNextToken();
-
-    bool ParseInnerTemplate();
-    bool ParseWxParent();
-    bool ParseParent();
-    bool ParseForm();
-    bool ParseChild();
-    bool ParseForEach();
-    bool ParseIfNotNull();
-    bool ParseIfNull();
-    bool ParseNewLine();
-    bool ParseIfEqual();
-    bool ParseIfNotEqual();
-    bool ParseIfParentTypeEqual();
-    bool ParseIfParentTypeNotEqual();
-    bool ParseIfParentClassEqual();
-    bool ParseIfParentClassNotEqual();
+    void ParseInnerTemplate(const Instruction& instruction);
+
+    void ParseProperty(const Instruction& instruction);
+    void ParseWxParent(const Instruction& instruction);
+    void ParseForEach(const Instruction& instruction);
+    void ParseNewLine();
     void ParseAppend();
     void ParseClass();
-    void ParseIndent();
-    void ParseUnindent();
-    bool ParseIfTypeEqual();
-    bool ParseIfTypeNotEqual();
     void ParseLuaTable();
 
-    PProperty GetProperty(wxString* childName = nullptr);
-    PObjectBase GetWxParent();
-    PProperty GetRelatedProperty(PObjectBase relative);
+    PObjectBase m_obj;
+    PCompiledTemplate m_template;
+    std::map<wxString, PProperty> m_overrides;
+
+    wxString m_out;
+    wxString m_pred;
+    wxString m_npred;
+
+    int m_indent; // Current indentation level in the file
+};
+
+/** Cache of the code generated for the top level forms.
 
-    /** Parse a macro.
+    The fragments of a form are stored under a key hashing everything they
+    depend on: the form subtree, the project settings and the generator.
+    Generators splice the fragments of the unchanged forms back in and only
+    generate the others. It can be used from several threads at once.
+*/
+class FormCodeCache {
+public:
+    typedef std::vector<wxString> Fragments;
+
+    /** Computes the hash of the project level settings, made of the project
+        properties and @a generator, which has to identify the generator,
+        its version and its own options.
     */
-    bool ParseMacro();
+    static uint64_t GetSettingsKey(PObjectBase project, const wxString& generator);
 
-    /** Parse a property.
+    /** Computes the key of @a form, given the key of the project settings.
     */
-    bool ParseProperty();
+    static uint64_t GetKey(PObjectBase form, uint64_t settingsKey);
 
-    /** Parse text.
+    /** Looks up the fragments stored under @a key.
     */
-    bool ParseText();
+    bool Find(uint64_t key, Fragments* fragments);
 
-    bool ParsePred();
-    bool ParseNPred();
+    void Insert(uint64_t key, const Fragments& fragments);
 
-    PObjectBase m_obj;
+    /** Ends a code generation, dropping the entries not used recently,
+        e.g. those of the previous versions of the edited forms.
+    */
+    void Prune();
 
-    wxStringInputStream m_in;
-    wxString m_out;
-    wxString m_pred;
-    wxString m_npred;
+private:
+    struct Entry {
+        Fragments fragments;
+        unsigned generation;
+    };
+    // Generations an entry is kept without being used, so that switching
+    // between the preview of a form and the whole project still hits
+    static const unsigned MaxAge = 8;
 
-    int m_indent; // Current indentation level in the file
+    std::mutex m_mutex;
+    std::unordered_map<uint64_t, Entry> m_entries;
+    unsigned m_generation = 0;
 };
 
 /** Code Generator
@@ -274,6 +337,8 @@ public:
     */
     typedef std::map<wxString, ArrayItem> ArrayItems;
 
+    typedef TemplateParser::PropertyOverrides PropertyOverrides;
+
     /** Virtual destructor.
     */
     virtual ~CodeGenerator();
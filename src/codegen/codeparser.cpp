@@ -20,19 +20,54 @@
 */
 #include "codeparser.h"
 
-wxString RemoveWhiteSpace(wxString str)
+#include "utils/fileutils.h"
+
+#include <wx/convauto.h>
+#include <wx/msgdlg.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+/** Reads @a file as wxTextFile does, each line followed by a '\n'
+    whatever the line endings used by the file.
+*/
+wxString ReadLines(const wxString& file)
+{
+    std::vector<char> data;
+    if (!FileUtils::ReadFile(file, &data) || data.empty())
+        return wxEmptyString;
+
+    const wxString text(data.data(), wxConvAuto(), data.size());
+    wxString lines;
+    lines.reserve(text.length() + 1);
+    for (wxString::const_iterator it = text.begin(); it != text.end(); ++it) {
+        if (*it == '\r') {
+            lines += '\n';
+            wxString::const_iterator next = it + 1;
+            if (next != text.end() && *next == '\n')
+                it = next;
+        } else {
+            lines += *it;
+        }
+    }
+    if (!lines.empty() && lines.Last() != '\n')
+        lines += '\n';
+
+    return lines;
+}
+} // namespace
+
+wxString RemoveWhiteSpace(const wxString& str)
 {
-    size_t index = 0;
-    while (index < str.Len()) {
-        if (str.GetChar(index) == ' '
-            || str.GetChar(index) == '\t'
-            || str.GetChar(index) == '\n')
-
-            str.Remove(index, 1);
-        else
-            index++;
+    wxString result;
+    result.reserve(str.length());
+    for (wxString::const_iterator it = str.begin(); it != str.end(); ++it) {
+        const wxUniChar ch = *it;
+        if (ch != ' ' && ch != '\t' && ch != '\n')
+            result += ch;
     }
-    return str;
+    return result;
 }
 
 void Function::SetHeading(wxString heading)
@@ -68,131 +103,95 @@ wxString Function::GetFunction()
 // CodeParser
 //---------------------------------------------------
 
-void CCodeParser::ParseCFiles(wxString className)
+void CCodeParser::ParseCFiles(const wxString& className)
 {
     m_className = className;
-    wxTextFile headerFile(m_hFile);
-    wxTextFile sourceFile(m_cFile);
 
-    wxString header;
-    wxString source;
-
-    // start opening files
-    if (headerFile.Open()) {
-        wxString Str;
-
-        Str = headerFile.GetFirstLine();
-        while (!(headerFile.Eof())) {
-            header << Str;
-            header << '\n';
-            Str = headerFile.GetNextLine();
-        }
-        headerFile.Close();
-    } else {
-        header = "";
-    }
-    if (sourceFile.Open()) {
-        wxString Str;
-
-        source = sourceFile.GetFirstLine();
-        while (!(sourceFile.Eof())) {
-            source << Str;
-            source << '\n';
-            Str = sourceFile.GetNextLine();
-        }
-        sourceFile.Close();
-    } else {
-        source = "";
-    }
     // parse the file contents
-    ParseCCode(header, source);
+    ParseCCode(ReadLines(m_hFile), ReadLines(m_cFile));
 }
 
-void CCodeParser::ParseCCode(wxString header, wxString source)
+void CCodeParser::ParseCCode(const wxString& header, const wxString& source)
 {
     ParseCInclude(header);
     ParseCClass(header);
     ParseSourceFunctions(source);
 }
 
-void CCodeParser::ParseCInclude(wxString code)
+void CCodeParser::ParseCInclude(const wxString& code)
 {
-    int userIncludeEnd;
     m_userInclude = "";
 
     // find the beginning of the user include
-    int userIncludeStart = code.Find("//// end generated include");
-    if (userIncludeStart != wxNOT_FOUND) {
-        userIncludeStart = code.find('\n', userIncludeStart);
-        if (userIncludeStart != wxNOT_FOUND) {
-            // find the end of the user include
-            userIncludeEnd = code.find("\n/** Implementing ", userIncludeStart);
-
-            if (userIncludeEnd != wxNOT_FOUND) {
-                userIncludeStart++;
-                m_userInclude = code.substr(userIncludeStart,
-                                            userIncludeEnd - userIncludeStart);
-            }
-        }
-    }
+    size_t userIncludeStart = code.find("//// end generated include");
+    if (userIncludeStart == wxString::npos)
+        return;
+
+    userIncludeStart = code.find('\n', userIncludeStart);
+    if (userIncludeStart == wxString::npos)
+        return;
+
+    // find the end of the user include
+    const size_t userIncludeEnd = code.find("\n/** Implementing ", userIncludeStart);
+    if (userIncludeEnd == wxString::npos)
+        return;
+
+    userIncludeStart++;
+    m_userInclude = code.substr(userIncludeStart, userIncludeEnd - userIncludeStart);
 }
 
-void CCodeParser::ParseCClass(wxString code)
+void CCodeParser::ParseCClass(const wxString& code)
 {
-    int startClass = code.Find("class " + m_className);
-    if (startClass != wxNOT_FOUND) {
-        code = ParseBrackets(code, startClass);
-        if (startClass != wxNOT_FOUND)
-            ParseCUserMembers(code);
+    size_t startClass = code.find("class " + m_className);
+    if (startClass != wxString::npos) {
+        const wxString body = ParseBrackets(code, &startClass);
+        if (startClass != wxString::npos)
+            ParseCUserMembers(body);
     }
 }
 
-void CCodeParser::ParseCUserMembers(wxString code)
+void CCodeParser::ParseCUserMembers(const wxString& code)
 {
     m_userMemebers = "";
-    int userMembersStart = code.Find("//// end generated class members");
-    if (userMembersStart != wxNOT_FOUND) {
-        userMembersStart = code.find('\n', userMembersStart);
-        if (userMembersStart == wxNOT_FOUND) {
-            m_userMemebers = "";
-        } else {
-            userMembersStart++;
-            if (userMembersStart < (int)code.Len())
-                m_userMemebers = code.Mid(userMembersStart);
-        }
-    }
+    size_t userMembersStart = code.find("//// end generated class members");
+    if (userMembersStart == wxString::npos)
+        return;
+
+    userMembersStart = code.find('\n', userMembersStart);
+    if (userMembersStart == wxString::npos)
+        return;
+
+    userMembersStart++;
+    if (userMembersStart < code.length())
+        m_userMemebers = code.substr(userMembersStart);
 }
 
 void CCodeParser::ParseSourceFunctions(wxString code)
 {
-    int functionStart = 0;
-    int functionEnd = 0;
-    int previousFunctionEnd = 0;
-    wxString funcName, funcArg;
-    Function* func;
-    wxString Str, R;
-
-    int loop = 0;
-    while (1) {
+    const wxString scope = m_className + "::";
+    size_t previousFunctionEnd = 0;
+    while (true) {
         // find the beginning of the function name
-        Str = m_className + "::";
-        functionStart = code.find(Str, previousFunctionEnd);
-        if (functionStart == wxNOT_FOUND) {
+        const size_t match = code.find(scope, previousFunctionEnd);
+        if (match == wxString::npos) {
             // Get the last bit of remaining code after the last function in the file
             m_trailingCode = code.Mid(previousFunctionEnd);
             m_trailingCode.RemoveLast();
             return;
         }
         // found a function now create a new function class
-        func = new Function();
+        Function* func = new Function();
 
-        // find the beginning of the line on which the function name resides
-        functionStart = code.rfind('\n', functionStart);
+        // find the beginning of the line on which the function name resides,
+        // the unsigned arithmetic takes the rest of the code if there is none
+        size_t functionStart = code.rfind('\n', match);
         func->SetDocumentation(code.Mid(previousFunctionEnd,
                                         functionStart - previousFunctionEnd));
         functionStart++;
 
-        functionEnd = code.find('{', functionStart);
+        // The body follows the name, a bracket before it on the same line
+        // (e.g. "int v{0}; Foo::f()") belongs to other code
+        const size_t functionEnd = code.find('{', match);
         wxString heading = code.Mid(functionStart, functionEnd - functionStart);
         if (heading.Right(1) == '\n')
             heading.RemoveLast();
@@ -201,66 +200,51 @@ void CCodeParser::ParseSourceFunctions(wxString code)
 
         m_functions[std::string(RemoveWhiteSpace(heading).ToUTF8())] = func;
 
+        // No function past this one can have a body either
+        if (functionEnd == wxString::npos)
+            return;
+
         // find the opening brackets of the function
-        func->SetContents(ParseBrackets(code, functionStart));
-        if (functionStart != wxNOT_FOUND) {
-            functionEnd = functionStart;
+        size_t bodyEnd = functionEnd;
+        func->SetContents(ParseBrackets(code, &bodyEnd));
+        if (bodyEnd != wxString::npos) {
+            previousFunctionEnd = bodyEnd;
         } else {
             wxMessageBox("Brackets Missing in Source File!");
             code.insert(functionEnd + 1,
                         "//The Following Block is missing a closing bracket\n//and has been "
                         "set aside by wxWeaver\n");
             func->SetContents("");
+            previousFunctionEnd = functionEnd;
         }
-        previousFunctionEnd = functionEnd;
-        if (loop == 100) // TODO: ???
-            return;
-
-        loop++;
+        // Always move past the name, so the same function is never found again
+        previousFunctionEnd = std::max(previousFunctionEnd, match + scope.length());
     }
 }
 
-wxString CCodeParser::ParseBrackets(wxString code, int& functionStart)
+wxString CCodeParser::ParseBrackets(const wxString& code, size_t* start)
 {
-    int openingBrackets = 0;
-    int closingBrackets = 0;
-    int index = 0;
-    wxString Str;
-
-    int functionLength = 0;
-    index = code.find('{', functionStart);
-    if (index != wxNOT_FOUND) {
-        openingBrackets++;
-        index++;
-        functionStart = index;
-        int loop = 0;
-        while (openingBrackets > closingBrackets) {
-            index = code.find_first_of("{}", index);
-            if (index == wxNOT_FOUND) {
-                Str = code.Mid(functionStart, index);
-                functionStart = index;
-                return Str;
-            }
-            if (code.GetChar(index) == '{') {
-                index++;
-                openingBrackets++;
-            } else {
-                index++;
-                closingBrackets++;
-            }
-            if (loop == 100) // TODO: ???
-                return "";
-
-            loop++;
-        }
-        index--;
-        functionLength = index - functionStart;
-    } else {
+    const size_t opening = code.find('{', *start);
+    if (opening == wxString::npos) {
         wxMessageBox("no brackets found");
+        ++*start;
+        return wxEmptyString;
     }
-    Str = code.Mid(functionStart, functionLength);
-    functionStart = functionStart + functionLength + 1;
-    return Str;
+    const size_t bodyStart = opening + 1;
+    size_t index = bodyStart;
+    int depth = 1;
+    while (depth > 0) {
+        index = code.find_first_of("{}", index);
+        if (index == wxString::npos) {
+            *start = wxString::npos;
+            return code.substr(bodyStart);
+        }
+        depth += (code[index] == '{') ? 1 : -1;
+        index++;
+    }
+    // Following the closing bracket
+    *start = index;
+    return code.substr(bodyStart, index - 1 - bodyStart);
 }
 
 wxString CodeParser::GetFunctionDocumentation(wxString function)
@@ -22,12 +22,11 @@
 
 #include "utils/debug.h"
 
-#include <wx/textfile.h>
-#include <wx/msgdlg.h>
+#include <wx/string.h>
 
 #include <unordered_map>
 
-wxString RemoveWhiteSpace(wxString str);
+wxString RemoveWhiteSpace(const wxString& str);
 
 /** Stores all of the information for all of the parsed functions
 */
@@ -147,24 +146,33 @@ public:
 
     /** Opens the header and source,  'className' is the Inherited class
     */
-    void ParseCFiles(wxString className);
+    void ParseCFiles(const wxString& className);
 
     /** Extracts the contents of the files.
         Takes the the entire contents of both files in string form
     */
-    void ParseCCode(wxString header, wxString source);
+    void ParseCCode(const wxString& header, const wxString& source);
 
     /** Extracts all user header include code before the class declaration
     */
-    void ParseCInclude(wxString code);
+    void ParseCInclude(const wxString& code);
 
     /** Extracts the contents of the generated class declaration
     */
-    void ParseCClass(wxString code);
+    void ParseCClass(const wxString& code);
 
+    /** Extracts the functions of the class in a single pass over the source,
+        the code after the last one is kept as the trailing code.
+    */
     void ParseSourceFunctions(wxString code);
 
-    wxString ParseBrackets(wxString code, int& functionStart);
+    /** Gets the contents of the block starting at the first '{' found from
+        @a start, which receives the position following the block.
+
+        If the block has no closing bracket the rest of the code is returned
+        and @a start is set to wxString::npos.
+    */
+    wxString ParseBrackets(const wxString& code, size_t* start);
 
-    void ParseCUserMembers(wxString code);
+    void ParseCUserMembers(const wxString& code);
 };
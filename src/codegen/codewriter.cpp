@@ -20,17 +20,178 @@
 */
 #include "codewriter.h"
 
-#include "md5/md5.hh"
-#include "utils/typeconv.h"
+#include "codegen/dependencies.h"
 #include "utils/exception.h"
+#include "utils/fileutils.h"
 
+#include <wx/datetime.h>
 #include <wx/file.h>
-#include <wx/regex.h>
-#include <wx/tokenzr.h>
+#include <wx/filename.h>
 #include <wx/stc/stc.h>
 
+#include <algorithm>
+#include <cctype>
 #include <cstring>
-#include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <vector>
+
+namespace {
+/** Whitespace as considered by wxString::Trim().
+*/
+inline bool IsSpace(wxUniChar ch)
+{
+    return ch.IsAscii() && std::isspace(static_cast<int>(ch.GetValue()));
+}
+
+/** Records the size, modification time and hash of the files written to each
+    output directory, in a file next to them.
+
+    An output whose size and time still match its entry is known to hold the
+    recorded contents, so it is compared without reading it back.
+*/
+class OutputManifest {
+public:
+    struct Entry {
+        uint64_t hash = 0;
+        uint64_t size = 0;
+        int64_t time = 0;
+    };
+
+    static OutputManifest& Get()
+    {
+        static OutputManifest manifest;
+        return manifest;
+    }
+
+    bool Find(const wxString& file, Entry* entry)
+    {
+        const wxFileName fileName(file);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const Entries& entries = GetEntries(fileName.GetPath());
+        auto it = entries.find(fileName.GetFullName());
+        if (it == entries.end())
+            return false;
+
+        *entry = it->second;
+        return true;
+    }
+
+    void Update(const wxString& file, const Entry& entry)
+    {
+        const wxFileName fileName(file);
+        const wxString dir = fileName.GetPath();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        GetEntries(dir)[fileName.GetFullName()] = entry;
+        if (m_batches)
+            m_changedDirs.insert(dir);
+        else
+            Write(dir);
+    }
+
+    void BeginBatch()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_batches;
+    }
+
+    void EndBatch()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_batches)
+            return;
+
+        for (const wxString& dir : m_changedDirs)
+            Write(dir);
+
+        m_changedDirs.clear();
+    }
+
+private:
+    typedef std::map<wxString, Entry> Entries;
+
+    static wxString GetManifestFile(const wxString& dir)
+    {
+        return dir + wxFileName::GetPathSeparator() + ".wxweaver-manifest";
+    }
+
+    void Write(const wxString& dir)
+    {
+        const Entries& entries = m_dirs[dir];
+        std::string data;
+        for (const auto& it : entries) {
+            data += wxString::Format("%016llx %llu %lld ",
+                                     static_cast<unsigned long long>(it.second.hash),
+                                     static_cast<unsigned long long>(it.second.size),
+                                     static_cast<long long>(it.second.time))
+                        .ToStdString();
+            data += it.first.utf8_str();
+            data += '\n';
+        }
+        // Only an optimization, generation goes on without it
+        FileUtils::WriteFileAtomically(data, GetManifestFile(dir));
+    }
+
+    /** Gets the entries of @a dir, reading its manifest the first time.
+    */
+    Entries& GetEntries(const wxString& dir)
+    {
+        auto found = m_dirs.find(dir);
+        if (found != m_dirs.end())
+            return found->second;
+
+        Entries& entries = m_dirs[dir];
+        std::vector<char> data;
+        if (!FileUtils::ReadFile(GetManifestFile(dir), &data))
+            return entries;
+
+        std::istringstream in(std::string(data.begin(), data.end()));
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream fields(line);
+            Entry entry;
+            unsigned long long hash, size;
+            long long time;
+            std::string name;
+            if (fields >> std::hex >> hash >> std::dec >> size >> time
+                && fields.get() == ' ' && std::getline(fields, name) && !name.empty()) {
+                entry.hash = hash;
+                entry.size = size;
+                entry.time = time;
+                entries[wxString::FromUTF8(name.c_str())] = entry;
+            }
+        }
+        return entries;
+    }
+
+    std::mutex m_mutex;
+    std::map<wxString, Entries> m_dirs;
+    std::set<wxString> m_changedDirs;
+    unsigned m_batches = 0;
+};
+
+/** Modification times may have a resolution of one, or even two, seconds.
+
+    An output modified again within that time after its entry is recorded can
+    keep both its size and time, an external edit would then be mistaken for
+    the recorded contents. Such entries are marked as untrusted instead, the
+    file is compared the next time and recorded again once it is older.
+*/
+const int64_t TimeResolution = 2000;
+const int64_t UntrustedTime = -1;
+} // namespace
+
+FileCodeWriter::Batch::Batch()
+{
+    OutputManifest::Get().BeginBatch();
+}
+
+FileCodeWriter::Batch::~Batch()
+{
+    OutputManifest::Get().EndBatch();
+}
 
 CodeWriter::CodeWriter()
     : m_indent(0)
@@ -64,40 +225,90 @@ bool CodeWriter::IsSingleLine(const wxString& code) const
     return (code.find('\n') == wxString::npos);
 }
 
-void CodeWriter::ProcessLine(wxString line, bool rawIndents)
+void CodeWriter::ProcessLine(wxString::const_iterator begin,
+                             wxString::const_iterator end, bool rawIndents)
 {
-    static const wxRegEx reIndent = wxRegEx("%TAB%\\s*", wxRE_ADVANCED);
-
     // Cleanup whitespace
-    if (!rawIndents)
-        line.Trim(false);
+    if (!rawIndents) {
+        while (begin != end && IsSpace(*begin))
+            ++begin;
+    }
+    while (end != begin && IsSpace(*(end - 1)))
+        --end;
 
-    line.Trim();
     // Remove and count indentations defined in code templates by #indent and
-    // #unindent macros to use own indentation mode
-    auto templateIndents = reIndent.Replace(&line, "");
-    if (templateIndents < 0)
-        templateIndents = 0;
+    // #unindent macros, along with the whitespace following them,
+    // to use own indentation mode
+    static const wxString marker = "%TAB%";
+    int templateIndents = 0;
+    wxString line;
+    wxString::const_iterator segment = begin;
+    wxString::const_iterator it = begin;
+    while (it != end) {
+        if (*it != '%' || end - it < 5 || !std::equal(marker.begin(), marker.end(), it)) {
+            ++it;
+            continue;
+        }
+        line.append(segment, it);
+        it += 5;
+        while (it != end && IsSpace(*it))
+            ++it;
+
+        ++templateIndents;
+        segment = it;
+    }
+    if (templateIndents)
+        line.append(segment, end);
+    else
+        line.assign(begin, end);
 
     m_indent += templateIndents;
     Write(line, rawIndents);
     m_indent -= templateIndents;
 
     // To prevent trailing whitespace in case the line was empty write the newline as-is
-    Write('\n', true);
+    static const wxString newline = "\n";
+    DoWrite(newline);
     m_isLineWriting = false;
 }
 
 void CodeWriter::WriteLn(const wxString& code, bool rawIndents)
 {
-    if (!IsSingleLine(code)) {
-        wxStringTokenizer tkz(code, '\n', wxTOKEN_RET_EMPTY_ALL);
-
-        while (tkz.HasMoreTokens())
-            ProcessLine(tkz.GetNextToken(), rawIndents);
-    } else {
-        ProcessLine(code, rawIndents);
+    wxString::const_iterator begin = code.begin();
+    const wxString::const_iterator end = code.end();
+    for (wxString::const_iterator it = begin; it != end; ++it) {
+        if (*it == '\n') {
+            ProcessLine(begin, it, rawIndents);
+            begin = it + 1;
+        }
     }
+    ProcessLine(begin, end, rawIndents);
+}
+
+void CodeWriter::WriteIndent()
+{
+    // Precomputed indentation strings, deeper levels write them repeatedly
+    static const size_t MaxLevel = 16;
+    static const std::vector<wxString> tabs = [] {
+        std::vector<wxString> indents(MaxLevel + 1);
+        for (size_t i = 1; i <= MaxLevel; ++i)
+            indents[i] = indents[i - 1] + "\t";
+        return indents;
+    }();
+    static const std::vector<wxString> spaces = [] {
+        std::vector<wxString> indents(MaxLevel + 1);
+        for (size_t i = 1; i <= MaxLevel; ++i)
+            indents[i] = indents[i - 1] + "    ";
+        return indents;
+    }();
+    const std::vector<wxString>& indents = m_hasSpacesIndentation ? spaces : tabs;
+
+    size_t level = m_indent;
+    for (; level > MaxLevel; level -= MaxLevel)
+        DoWrite(indents[MaxLevel]);
+
+    if (level)
+        DoWrite(indents[level]);
 }
 
 void CodeWriter::Write(const wxString& code, bool rawIndents)
@@ -107,15 +318,20 @@ void CodeWriter::Write(const wxString& code, bool rawIndents)
         return;
 
     if (!m_isLineWriting) {
-        if (!rawIndents) {
-            for (int i = 0; i < m_indent; ++i)
-                DoWrite(m_hasSpacesIndentation ? "    " : "\t");
-        }
+        if (!rawIndents)
+            WriteIndent();
+
         m_isLineWriting = true;
     }
     DoWrite(code);
 }
 
+void CodeWriter::WriteFormatted(const wxString& code)
+{
+    if (!code.empty())
+        DoWrite(code);
+}
+
 void CodeWriter::SetIndentWithSpaces(bool on)
 {
     m_hasSpacesIndentation = on;
@@ -150,6 +366,7 @@ void TCCodeWriter::Clear()
 
 StringCodeWriter::StringCodeWriter()
 {
+    m_buffer.reserve(InitialCapacity);
 }
 
 void StringCodeWriter::DoWrite(const wxString& code)
@@ -183,48 +400,57 @@ FileCodeWriter::~FileCodeWriter()
 
 void FileCodeWriter::WriteBuffer()
 {
-    static const unsigned char MICROSOFT_BOM[3] = { 0xEF, 0xBB, 0xBF };
+    static const char MICROSOFT_BOM[3] = { '\xEF', '\xBB', '\xBF' };
+
+    // An output of the generation even if left unchanged
+    DependencyTracker::AddOutput(m_filename);
 
-    // TODO: Check this
     std::string data;
-    if (m_useUtf8)
-        data = m_buffer.ToStdString();
-    else
-        data = m_buffer.mb_str(wxConvISO8859_1);
+    if (m_useUtf8 && m_useMicrosoftBOM)
+        data.assign(MICROSOFT_BOM, 3);
 
-    // Compare buffer with existing file (if any) to determine if
-    // writing the file is necessary
+    if (m_useUtf8) {
+        const wxScopedCharBuffer utf8 = m_buffer.utf8_str();
+        data.append(utf8.data(), utf8.length());
+    } else {
+        data += m_buffer.mb_str(wxConvISO8859_1);
+    }
+    OutputManifest::Entry entry;
+    entry.hash = FileUtils::Hash(data);
+
+    // Compare the buffer with the existing file (if any) to determine if
+    // writing the file is necessary, trusting the manifest while the file
+    // is still the one written the last time
+    OutputManifest& manifest = OutputManifest::Get();
+    OutputManifest::Entry previous;
     bool shouldWrite = true;
-    std::ifstream fileIn(m_filename.mb_str(wxConvFile), std::ios::binary | std::ios::in);
-
-    if (fileIn) {
-        MD5 diskHash(fileIn);
-        unsigned char* diskDigest = diskHash.raw_digest();
-
-        MD5 bufferHash;
-        if (m_useUtf8 && m_useMicrosoftBOM) {
-            bufferHash.update(MICROSOFT_BOM, 3);
+    if (FileUtils::GetFileStamp(m_filename, &entry.size, &entry.time)) {
+        if (manifest.Find(m_filename, &previous) && previous.size == entry.size
+            && previous.time == entry.time) {
+            shouldWrite = (previous.hash != entry.hash);
+        } else if (entry.size == data.size()) {
+            std::vector<char> disk;
+            shouldWrite = !FileUtils::ReadFile(m_filename, &disk)
+                || std::memcmp(disk.data(), data.data(), data.size()) != 0;
         }
-        bufferHash.update(reinterpret_cast<const unsigned char*>(data.c_str()), data.size());
-        bufferHash.finalize();
-        unsigned char* bufferDigest = bufferHash.raw_digest();
-
-        shouldWrite = (0 != std::memcmp(diskDigest, bufferDigest, 16));
-
-        delete[] diskDigest;
-        delete[] bufferDigest;
     }
     if (shouldWrite) {
-        wxFile fileOut;
-        if (!fileOut.Create(m_filename, true)) {
+        if (!FileUtils::WriteFileAtomically(data, m_filename)) {
             wxLogError("Unable to create file: %s", m_filename.c_str());
             return;
         }
-        if (m_useUtf8 && m_useMicrosoftBOM)
-            fileOut.Write(MICROSOFT_BOM, 3);
-
-        fileOut.Write(data.c_str(), data.length());
+        if (!FileUtils::GetFileStamp(m_filename, &entry.size, &entry.time))
+            return;
     }
+    // Written or modified too recently to tell later changes, see TimeResolution
+    if (wxDateTime::UNow().GetValue().GetValue() - entry.time < TimeResolution)
+        entry.time = UntrustedTime;
+
+    if (!shouldWrite && previous.hash == entry.hash && previous.size == entry.size
+        && previous.time == entry.time)
+        return;
+
+    manifest.Update(m_filename, entry);
 }
 
 void FileCodeWriter::Clear()
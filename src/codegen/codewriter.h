@@ -63,6 +63,15 @@ public:
      */
     void Write(const wxString& code, bool rawIndents = false);
 
+    /** Appends code already formatted by another writer, as-is.
+
+        This allows to generate parts of the code on other threads
+        and to join them in order afterwards.
+
+        @param code Complete lines, as written by WriteLn(const wxString&, bool)
+    */
+    void WriteFormatted(const wxString& code);
+
     /** Sets the option to indent with spaces
     */
     void SetIndentWithSpaces(bool on);
@@ -93,12 +102,18 @@ protected:
         Performs whitespace cleanup and indentation processing
         including the special markers of the TemplateParser.
 
-        @param line Single line, must not contain newlines
+        @param begin Start of the line
+        @param end End of the line, the line must not contain newlines
         @param rawIndents If true, keep leading indenting whitespace and don't apply own indenting
      */
-    void ProcessLine(wxString line, bool rawIndents);
+    void ProcessLine(wxString::const_iterator begin, wxString::const_iterator end,
+                     bool rawIndents);
 
 private:
+    /** Writes the indentation of the current level.
+    */
+    void WriteIndent();
+
     int m_indent;                // Current indentation level in the file
     bool m_isLineWriting;        // Flag if line writing is in progress
     bool m_hasSpacesIndentation; // If using spaces for indentation
@@ -132,10 +147,30 @@ protected:
     void DoWrite(const wxString& code) override;
 
     wxString m_buffer;
+
+private:
+    // Initial capacity of the buffer, enough for most of the generated files
+    static const size_t InitialCapacity = 64 * 1024;
 };
 
 class FileCodeWriter : public StringCodeWriter {
 public:
+    /** Defers the updates of the output manifests while in scope.
+
+        The writers record the outputs of each directory in a manifest.
+        While a batch exists, in any thread, the updates are collected and
+        every changed manifest is written once when the last batch ends,
+        otherwise each writer rewrites the manifest of its directory.
+    */
+    class Batch {
+    public:
+        Batch();
+        ~Batch();
+
+        Batch(const Batch&) = delete;
+        Batch& operator=(const Batch&) = delete;
+    };
+
     FileCodeWriter(const wxString& file, bool useMicrosoftBOM = false,
                    bool useUtf8 = true);
     ~FileCodeWriter() override;
@@ -26,17 +26,119 @@
 #include "utils/typeconv.h"
 #include "utils/exception.h"
 #include "codegen/codewriter.h"
+#include "codegen/dependencies.h"
 
 #include <wx/filename.h>
+#include <wx/thread.h>
 #include <wx/tokenzr.h>
 
 #include <algorithm>
+#include <atomic>
+#include <thread>
 
 // TODO: wxStrings by value
 
+namespace {
+wxString GetFileComment()
+{
+    return wxString::Format(
+        "/*\n"
+        "    C++ code generated with wxWeaver (version %s%s " __DATE__ ")\n"
+        "    https://wxweaver.github.io/\n"
+        "\n"
+        "    PLEASE DO *NOT* EDIT THIS FILE!\n"
+        "*/",
+        VERSION, REVISION);
+}
+
+/** Member classes declared as typedefs, or as macros, by some ports,
+    which can't be forward declared.
+*/
+const std::set<wxString> s_undeclarableClasses = {
+    "wxCalendarCtrl", "wxCollapsiblePane", "wxInfoBar", "wxScrolledCanvas", "wxScrolledWindow"
+};
+
+bool IsIdentifier(const wxString& text)
+{
+    if (text.empty() || wxIsdigit(text[0]))
+        return false;
+
+    for (const wxUniChar c : text) {
+        if (!wxIsalnum(c) && c != '_')
+            return false;
+    }
+    return true;
+}
+
+/** Collects the classes of the members declared by @a declaration.
+
+    @return false unless all the members are pointers to classes that
+    can be forward declared.
+*/
+bool GetPointerClasses(const wxString& declaration, std::set<wxString>* classes)
+{
+    wxStringTokenizer lines(declaration, "\n", wxTOKEN_STRTOK);
+    while (lines.HasMoreTokens()) {
+        wxString line = lines.GetNextToken();
+        line.Trim().Trim(false);
+        if (line.empty() || line.StartsWith("enum "))
+            continue;
+
+        const int star = line.Find('*');
+        if (star == wxNOT_FOUND || !line.EndsWith(";"))
+            return false;
+
+        wxString type = line.Left(star);
+        type.Trim();
+        wxString name = line.Mid(star + 1).BeforeFirst(';').BeforeFirst('[');
+        name.Trim().Trim(false);
+        if (!IsIdentifier(type) || !IsIdentifier(name) || s_undeclarableClasses.count(type))
+            return false;
+
+        classes->insert(type);
+    }
+    return true;
+}
+
+/** Checks that the forms, written to files named after them, can be
+    written without overwriting each other or the project files.
+
+    The names are compared ignoring the case, as the file systems of
+    some platforms do.
+*/
+bool CheckFormFileNames(PObjectBase project, const wxString& file)
+{
+    std::set<wxString> names = { file.Lower() };
+    for (size_t i = 0; i < project->GetChildCount(); ++i) {
+        const wxString name = project->GetChild(i)->GetPropertyAsString("name");
+        if (name.empty() || name.find_first_of("\\/:*?\"<>|") != wxString::npos) {
+            wxLogError("The form \"%s\" can't be written to its own files, "
+                       "its name is not a valid file name",
+                       name);
+            return false;
+        }
+        if (!names.insert(name.Lower()).second) {
+            wxLogError("The form \"%s\" can't be written to its own files, "
+                       "its name is already used by the project file or by another form",
+                       name);
+            return false;
+        }
+    }
+    return true;
+}
+} // namespace
+
 CppTemplateParser::CppTemplateParser(PObjectBase obj, wxString _template,
                                      bool useI18N, bool useRelativePath,
                                      wxString basePath)
+    : CppTemplateParser(obj, CompiledTemplate::Compile(_template),
+                        useI18N, useRelativePath, basePath)
+{
+}
+
+CppTemplateParser::CppTemplateParser(PObjectBase obj, PCompiledTemplate _template,
+                                     bool useI18N, bool useRelativePath,
+                                     wxString basePath)
     : TemplateParser(obj, _template)
     , m_basePath(basePath)
     , m_useI18n(useI18N)
@@ -47,7 +149,7 @@ CppTemplateParser::CppTemplateParser(PObjectBase obj, wxString _template,
 }
 
 CppTemplateParser::CppTemplateParser(const CppTemplateParser& other,
-                                     wxString _template)
+                                     PCompiledTemplate _template)
     : TemplateParser(other, _template)
     , m_basePath(other.m_basePath)
     , m_useI18n(other.m_useI18n)
@@ -61,7 +163,7 @@ wxString CppTemplateParser::RootWxParentToCode()
 }
 
 PTemplateParser CppTemplateParser::CreateParser(const TemplateParser* oldparser,
-                                                wxString _template)
+                                                PCompiledTemplate _template)
 {
     const CppTemplateParser* cppOldParser
         = dynamic_cast<const CppTemplateParser*>(oldparser);
@@ -148,7 +250,6 @@ wxString CppTemplateParser::ValueToCode(PropertyType type, wxString value)
     case PT_WXFONT: {
         if (!value.empty()) {
             wxFontContainer fontContainer = TypeConv::StringToFont(value);
-            wxFont font = fontContainer.GetFont();
 
             const int pointSize = fontContainer.GetPointSize();
 
@@ -158,8 +259,8 @@ wxString CppTemplateParser::ValueToCode(PropertyType type, wxString value)
                      ? "wxNORMAL_FONT->GetPointSize()"
                      : (wxString() << pointSize)),
                 TypeConv::FontFamilyToString(fontContainer.GetFamily()),
-                font.GetStyleString(),
-                font.GetWeightString(),
+                TypeConv::FontStyleToString(fontContainer.GetStyle()),
+                TypeConv::FontWeightToString(fontContainer.GetWeight()),
                 (fontContainer.GetUnderlined() ? "true" : "false"),
                 (fontContainer.m_faceName.empty()
                      ? "wxEmptyString"
@@ -301,6 +402,8 @@ CppCodeGenerator::CppCodeGenerator()
     m_useRelativePath = false;
     m_useI18n = false;
     m_firstID = 1000;
+    m_generateEmbeddedFiles = true;
+    m_slimHeaders = false;
 }
 
 wxString CppCodeGenerator::ConvertCppString(wxString text)
@@ -522,24 +625,17 @@ bool CppCodeGenerator::GenerateCode(PObjectBase project)
     if (i18nProperty && i18nProperty->GetValueAsInteger())
         m_useI18n = true;
 
+    m_slimHeaders = false;
+    PProperty slimHeadersProperty = project->GetProperty("slim_headers");
+    if (slimHeadersProperty && slimHeadersProperty->GetValueAsInteger())
+        m_slimHeaders = true;
+
     m_useConnect = (project->GetPropertyAsString("event_generation") != "table");
     m_disconnectEvents = (project->GetPropertyAsInteger("disconnect_events"));
 
     m_header->Clear();
     m_source->Clear();
 
-    wxString code = wxString::Format(
-        "/*\n"
-        "    C++ code generated with wxWeaver (version %s%s " __DATE__ ")\n"
-        "    https://wxweaver.github.io/\n"
-        "\n"
-        "    PLEASE DO *NOT* EDIT THIS FILE!\n"
-        "*/",
-        VERSION, REVISION);
-
-    m_header->WriteLn(code, true);
-    m_source->WriteLn(code, true);
-
     PProperty propFile = project->GetProperty("file");
     if (!propFile) {
         wxLogError("Missing \"file\" property on Project Object");
@@ -549,6 +645,142 @@ bool CppCodeGenerator::GenerateCode(PObjectBase project)
     if (file.empty())
         file = "noname";
 
+    // Without a factory (e.g. in the previews) all the forms go to the
+    // header and source writers
+    const bool splitForms = m_writerFactory && project->GetPropertyAsInteger("split_forms");
+
+    wxString classDecoration;
+    PProperty propNamespace = project->GetProperty("namespace");
+    wxArrayString namespaceArray;
+    if (propNamespace)
+        namespaceArray = propNamespace->GetValueAsArrayString();
+
+    if (splitForms) {
+        if (!CheckFormFileNames(project, file))
+            return false;
+
+        GenProjectFiles(project, file);
+        classDecoration = GetClassDecoration(project, nullptr);
+    } else {
+        classDecoration = GenFilePrologue(project, project, file, namespaceArray, useEnum);
+    }
+    // The code of a form only depends on its own subtree, the project
+    // properties and these generator settings
+    uint64_t settingsKey = 0;
+    if (m_formCache) {
+        settingsKey = FormCodeCache::GetSettingsKey(
+            project, wxString::Format("C++ %s%s %d %s %zu", VERSION, REVISION,
+                                      static_cast<int>(m_useRelativePath), m_basePath,
+                                      m_firstID));
+    }
+    // Forms are independent, generate them on a worker pool into their own
+    // buffers and append these in project order, or write them to their
+    // own files
+    const size_t formCount = project->GetChildCount();
+    std::vector<FormCodeCache::Fragments> forms(formCount);
+    std::atomic<size_t> next(0);
+    std::atomic<bool> failed(false);
+    DependencyTracker* tracker = DependencyTracker::Get();
+    wxString projectFile;
+    PObjectBase threadProject = ApplicationData::GetThreadProject(&projectFile);
+    auto worker = [&]() {
+        // The templates resolve the relative paths against the thread project
+        ApplicationData::SetThreadProject(threadProject, projectFile);
+        DependencyTracker::Scope scope(tracker);
+        for (size_t i = next++; i < formCount; i = next++) {
+            PObjectBase form = project->GetChild(i);
+            uint64_t key = 0;
+            if (m_formCache)
+                key = FormCodeCache::GetKey(form, settingsKey);
+
+            if (!m_formCache || !m_formCache->Find(key, &forms[i])) {
+                PStringCodeWriter header = std::make_shared<StringCodeWriter>();
+                PStringCodeWriter source = std::make_shared<StringCodeWriter>();
+                for (size_t j = 0; j < namespaceArray.Count(); ++j)
+                    header->Indent();
+
+                CppCodeGenerator generator(*this);
+                generator.m_header = header;
+                generator.m_source = source;
+                generator.GenForm(form, useEnum, classDecoration);
+
+                forms[i] = { header->GetString(), source->GetString() };
+                if (m_formCache)
+                    m_formCache->Insert(key, forms[i]);
+            }
+            if (splitForms && !GenFormFiles(project, form, forms[i], useEnum))
+                failed = true;
+        }
+    };
+    const size_t jobs = std::max<size_t>(
+        1, std::min<size_t>(std::thread::hardware_concurrency(), formCount));
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < jobs; ++i)
+        threads.emplace_back(worker);
+
+    worker();
+    for (std::thread& thread : threads)
+        thread.join();
+
+    // Messages logged by the workers, on a worker thread itself (e.g. the
+    // code preview) they are left to the main thread
+    if (wxThread::IsMain())
+        wxLog::FlushActive();
+
+    if (m_formCache)
+        m_formCache->Prune();
+
+    if (splitForms)
+        return !failed;
+
+    for (const FormCodeCache::Fragments& form : forms) {
+        m_header->WriteFormatted(form[0]);
+        m_source->WriteFormatted(form[1]);
+    }
+    GenFileEpilogue(namespaceArray);
+    return true;
+}
+
+wxString CppCodeGenerator::GetClassDecoration(PObjectBase project, wxString* include)
+{
+    PProperty propClassDecoration = project->GetProperty("class_decoration");
+    if (!propClassDecoration)
+        return wxEmptyString;
+
+    // get the decoration to be used by GenClassDeclaration
+    std::map<wxString, wxString> children;
+    propClassDecoration->SplitParentProperty(&children);
+
+    wxString classDecoration;
+    std::map<wxString, wxString>::iterator decoration;
+    decoration = children.find("decoration");
+
+    if (decoration != children.end()) {
+        classDecoration = decoration->second;
+        if (!classDecoration.empty())
+            classDecoration += " ";
+    }
+    // Now get the header
+    std::map<wxString, wxString>::iterator header;
+    header = children.find("header");
+
+    if (include && header != children.end() && !header->second.empty())
+        *include = "#include \"" + header->second + "\"";
+
+    return classDecoration;
+}
+
+wxString CppCodeGenerator::GenFilePrologue(PObjectBase project, PObjectBase root,
+                                           const wxString& file,
+                                           const wxArrayString& namespaceArray,
+                                           bool useEnum)
+{
+    const bool isProject = (root == project);
+    wxString code = GetFileComment();
+    m_header->WriteLn(code, true);
+    m_source->WriteLn(code, true);
+
     m_header->WriteLn("#pragma once");
     m_header->WriteLn(wxEmptyString);
 
@@ -561,8 +793,19 @@ bool CppCodeGenerator::GenerateCode(PObjectBase project)
     std::set<wxString> subclassSourceIncludes;
     std::vector<wxString> headerIncludes;
 
-    GenSubclassSets(project, &subclasses, &subclassSourceIncludes, &headerIncludes);
+    GenSubclassSets(root, &subclasses, &subclassSourceIncludes, &headerIncludes);
 
+    // Generating in the .h header file those include from components dependencies,
+    // or in the .cpp source file for the members that can be forward declared
+    std::set<wxString> templates;
+    std::vector<wxString> sourceIncludes;
+    if (m_slimHeaders) {
+        std::set<wxString> sourceTemplates;
+        GenSlimIncludes(root, &headerIncludes, &templates, &sourceIncludes,
+                        &sourceTemplates, &subclasses);
+    } else {
+        GenIncludes(root, &headerIncludes, &templates);
+    }
     // Write the forward declaration lines
     std::set<wxString>::iterator subclassIt;
     for (subclassIt = subclasses.begin(); subclassIt != subclasses.end(); ++subclassIt)
@@ -571,10 +814,6 @@ bool CppCodeGenerator::GenerateCode(PObjectBase project)
     if (!subclasses.empty())
         m_header->WriteLn(wxEmptyString);
 
-    // Generating in the .h header file those include from components dependencies.
-    std::set<wxString> templates;
-    GenIncludes(project, &headerIncludes, &templates);
-
     // Write the include lines
     std::vector<wxString>::iterator includeIt;
     for (includeIt = headerIncludes.begin();
@@ -585,36 +824,14 @@ bool CppCodeGenerator::GenerateCode(PObjectBase project)
         m_header->WriteLn(wxEmptyString);
 
     // class decoration
-    PProperty propClassDecoration = project->GetProperty("class_decoration");
-    wxString classDecoration;
-    if (propClassDecoration) {
-        // get the decoration to be used by GenClassDeclaration
-        std::map<wxString, wxString> children;
-        propClassDecoration->SplitParentProperty(&children);
-
-        std::map<wxString, wxString>::iterator decoration;
-        decoration = children.find("decoration");
-
-        if (decoration != children.end()) {
-            classDecoration = decoration->second;
-            if (!classDecoration.empty())
-                classDecoration += " ";
-        }
-        // Now get the header
-        std::map<wxString, wxString>::iterator header;
-        header = children.find("header");
-
-        if (header != children.end()) {
-            wxString headerVal = header->second;
-            if (!headerVal.empty()) {
-                wxString include = "#include \"" + headerVal + "\"";
-                std::vector<wxString>::iterator findInclude
-                    = std::find(headerIncludes.begin(), headerIncludes.end(), include);
-                if (findInclude == headerIncludes.end()) {
-                    m_header->WriteLn(include);
-                    m_header->WriteLn(wxEmptyString);
-                }
-            }
+    wxString include;
+    const wxString classDecoration = GetClassDecoration(project, &include);
+    if (!include.empty()) {
+        std::vector<wxString>::iterator findInclude
+            = std::find(headerIncludes.begin(), headerIncludes.end(), include);
+        if (findInclude == headerIncludes.end()) {
+            m_header->WriteLn(include);
+            m_header->WriteLn(wxEmptyString);
         }
     }
     code = GetCode(project, "header_epilogue");
@@ -636,58 +853,49 @@ bool CppCodeGenerator::GenerateCode(PObjectBase project)
     if (!subclassSourceIncludes.empty())
         m_source->WriteLn(wxEmptyString);
 
+    for (const wxString& include : sourceIncludes)
+        m_source->WriteLn(include);
+
+    if (!sourceIncludes.empty())
+        m_source->WriteLn(wxEmptyString);
+
     // Generated header
     m_source->WriteLn("#include \"" + file + ".h\"");
     m_source->WriteLn(wxEmptyString);
-    GenEmbeddedBitmapIncludes(project);
-
-    code = GetCode(project, "cpp_epilogue");
-    m_source->WriteLn(code);
+    GenEmbeddedBitmapIncludes(project, root);
 
+    // Project wide code, written once by the project source
+    if (isProject) {
+        code = GetCode(project, "cpp_epilogue");
+        m_source->WriteLn(code);
+    }
     // namespace
-    PProperty propNamespace = project->GetProperty("namespace");
-    wxArrayString namespaceArray;
-    if (propNamespace) {
-        namespaceArray = propNamespace->GetValueAsArrayString();
-        wxString usingNamespaceStr;
-        for (size_t i = 0; i < namespaceArray.Count(); ++i) {
-            m_header->WriteLn("namespace " + namespaceArray[i]);
-            m_header->WriteLn("{");
-            m_header->Indent();
+    wxString usingNamespaceStr;
+    for (size_t i = 0; i < namespaceArray.Count(); ++i) {
+        m_header->WriteLn("namespace " + namespaceArray[i]);
+        m_header->WriteLn("{");
+        m_header->Indent();
 
-            if (usingNamespaceStr.empty())
-                usingNamespaceStr = "using namespace ";
-            else
-                usingNamespaceStr += "::";
+        if (usingNamespaceStr.empty())
+            usingNamespaceStr = "using namespace ";
+        else
+            usingNamespaceStr += "::";
 
-            usingNamespaceStr += namespaceArray[i];
-        }
-        if (namespaceArray.Count() && !usingNamespaceStr.empty()) {
-            usingNamespaceStr += ';';
-            m_source->WriteLn(usingNamespaceStr);
-        }
+        usingNamespaceStr += namespaceArray[i];
+    }
+    if (namespaceArray.Count() && !usingNamespaceStr.empty()) {
+        usingNamespaceStr += ';';
+        m_source->WriteLn(usingNamespaceStr);
     }
     // Generating "defines" for macros
     if (!useEnum)
-        GenDefines(project);
-
-    for (size_t i = 0; i < project->GetChildCount(); i++) {
-        PObjectBase child = project->GetChild(i);
+        GenDefines(project, isProject ? PObjectBase() : root);
 
-        // Preprocess to find arrays
-        ArrayItems arrays;
-        FindArrayObjects(child, arrays, true);
-
-        EventVector events;
-        FindEventHandlers(child, events);
-        GenClassDeclaration(child, useEnum, classDecoration, events, arrays);
-        if (!m_useConnect)
-            GenEvents(child, events);
+    return classDecoration;
+}
 
-        GenConstructor(child, events, arrays);
-        GenDestructor(child, events);
-    }
-    // namespace
+void CppCodeGenerator::GenFileEpilogue(const wxArrayString& namespaceArray)
+{
     if (namespaceArray.Count() > 0) {
         for (size_t i = namespaceArray.Count(); i > 0; --i) {
             m_header->Unindent();
@@ -695,9 +903,93 @@ bool CppCodeGenerator::GenerateCode(PObjectBase project)
         }
         m_header->WriteLn(wxEmptyString);
     }
+}
+
+void CppCodeGenerator::GenProjectFiles(PObjectBase project, const wxString& file)
+{
+    wxString code = GetFileComment();
+    m_header->WriteLn(code, true);
+    m_source->WriteLn(code, true);
+
+    m_header->WriteLn("#pragma once");
+    m_header->WriteLn(wxEmptyString);
+
+    code = GetCode(project, "header_preamble");
+    if (!code.empty()) {
+        m_header->WriteLn(code);
+        m_header->WriteLn(wxEmptyString);
+    }
+    if (project->GetPropertyAsInteger("umbrella_header")) {
+        for (size_t i = 0; i < project->GetChildCount(); ++i) {
+            const wxString form = project->GetChild(i)->GetPropertyAsString("name");
+            m_header->WriteLn("#include \"" + form + ".h\"");
+        }
+        m_header->WriteLn(wxEmptyString);
+    }
+    code = GetCode(project, "cpp_preamble");
+    if (!code.empty()) {
+        m_source->WriteLn(code);
+        m_source->WriteLn(wxEmptyString);
+    }
+    m_source->WriteLn("#include \"" + file + ".h\"");
+    m_source->WriteLn(wxEmptyString);
+
+    code = GetCode(project, "cpp_epilogue");
+    m_source->WriteLn(code);
+
+    // The forms only include the headers of the embedded files they use,
+    // write these once for the whole project
+    std::set<wxString> includeSet;
+    std::set<wxString> embeddedFiles;
+    FindEmbeddedBitmapProperties(project, project, includeSet, embeddedFiles);
+    if (m_generateEmbeddedFiles && !embeddedFiles.empty())
+        FileToCArray::GenerateAll(embeddedFiles, project);
+}
+
+bool CppCodeGenerator::GenFormFiles(PObjectBase project, PObjectBase form,
+                                    const FormCodeCache::Fragments& fragments,
+                                    bool useEnum)
+{
+    const wxString name = form->GetPropertyAsString("name");
+    try {
+        CppCodeGenerator generator(*this);
+        generator.m_generateEmbeddedFiles = false;
+        generator.m_header = m_writerFactory(name + ".h");
+        generator.m_source = m_writerFactory(name + ".cpp");
+
+        wxArrayString namespaceArray;
+        PProperty propNamespace = project->GetProperty("namespace");
+        if (propNamespace)
+            namespaceArray = propNamespace->GetValueAsArrayString();
+
+        generator.GenFilePrologue(project, form, name, namespaceArray, useEnum);
+        generator.m_header->WriteFormatted(fragments[0]);
+        generator.m_source->WriteFormatted(fragments[1]);
+        generator.GenFileEpilogue(namespaceArray);
+    } catch (wxWeaverException& ex) {
+        wxLogError(ex.what());
+        return false;
+    }
     return true;
 }
 
+void CppCodeGenerator::GenForm(PObjectBase form, bool useEnum,
+                               const wxString& classDecoration)
+{
+    // Preprocess to find arrays
+    ArrayItems arrays;
+    FindArrayObjects(form, arrays, true);
+
+    EventVector events;
+    FindEventHandlers(form, events);
+    GenClassDeclaration(form, useEnum, classDecoration, events, arrays);
+    if (!m_useConnect)
+        GenEvents(form, events);
+
+    GenConstructor(form, events, arrays);
+    GenDestructor(form, events);
+}
+
 void CppCodeGenerator::GenEvents(PObjectBase classObj, const EventVector& events,
                                  bool disconnect)
 {
@@ -895,8 +1187,8 @@ void CppCodeGenerator::GenValVarsBase(PObjectInfo info, PObjectBase obj)
     if (!codeInfo)
         return;
 
-    wxString _template = codeInfo->GetTemplate("valvar_declaration");
-    if (!_template.empty()) {
+    PCompiledTemplate _template = codeInfo->GetCompiledTemplate("valvar_declaration");
+    if (!_template->IsEmpty()) {
         CppTemplateParser parser(obj, _template,
                                  m_useI18n, m_useRelativePath, m_basePath);
         wxString code = parser.ParseTemplate();
@@ -927,8 +1219,8 @@ void CppCodeGenerator::GenDefinedEventHandlers(PObjectInfo info, PObjectBase obj
     if (!codeInfo)
         return;
 
-    wxString _template = codeInfo->GetTemplate("generated_event_handlers");
-    if (!_template.empty()) {
+    PCompiledTemplate _template = codeInfo->GetCompiledTemplate("generated_event_handlers");
+    if (!_template->IsEmpty()) {
         CppTemplateParser parser(obj, _template,
                                  m_useI18n, m_useRelativePath, m_basePath);
         wxString code = parser.ParseTemplate();
@@ -942,7 +1234,8 @@ void CppCodeGenerator::GenDefinedEventHandlers(PObjectInfo info, PObjectBase obj
     }
 }
 
-wxString CppCodeGenerator::GetCode(PObjectBase obj, wxString name)
+wxString CppCodeGenerator::GetCode(PObjectBase obj, wxString name,
+                                   const PropertyOverrides& overrides)
 {
     PCodeInfo codeInfo = obj->GetObjectInfo()->GetCodeInfo("C++");
     if (!codeInfo) {
@@ -952,8 +1245,9 @@ wxString CppCodeGenerator::GetCode(PObjectBase obj, wxString name)
         wxLogError(msg);
         return wxEmptyString;
     }
-    wxString _template = codeInfo->GetTemplate(name);
+    PCompiledTemplate _template = codeInfo->GetCompiledTemplate(name);
     CppTemplateParser parser(obj, _template, m_useI18n, m_useRelativePath, m_basePath);
+    parser.SetPropertyOverrides(overrides);
     wxString code = parser.ParseTemplate();
     return code;
 }
@@ -1009,9 +1303,7 @@ wxString CppCodeGenerator::GetDeclaration(PObjectBase obj,
     for (size_t index : item.maxIndex)
         targetName.append(wxString::Format("[%zd]", index + 1));
 
-    propName->SetValue(targetName);           // Set declaration name
-    code.append(GetCode(obj, "declaration")); // Get the Code
-    propName->SetValue(name);                 // Restore the name
+    code.append(GetCode(obj, "declaration", { { "name", targetName } }));
 
     item.isDeclared = true; // Mark the array as declared
     return code;
@@ -1273,7 +1565,7 @@ void CppCodeGenerator::GenObjectIncludes(PObjectBase project,
     // Fill the set
     PCodeInfo codeInfo = project->GetObjectInfo()->GetCodeInfo("C++");
     if (codeInfo) {
-        CppTemplateParser parser(project, codeInfo->GetTemplate("include"),
+        CppTemplateParser parser(project, codeInfo->GetCompiledTemplate("include"),
                                  m_useI18n, m_useRelativePath, m_basePath);
         wxString include = parser.ParseTemplate();
         if (!include.empty()) {
@@ -1285,6 +1577,40 @@ void CppCodeGenerator::GenObjectIncludes(PObjectBase project,
     GenBaseIncludes(project->GetObjectInfo(), project, includes, templates);
 }
 
+void CppCodeGenerator::GenSlimIncludes(PObjectBase obj,
+                                       std::vector<wxString>* headerIncludes,
+                                       std::set<wxString>* headerTemplates,
+                                       std::vector<wxString>* sourceIncludes,
+                                       std::set<wxString>* sourceTemplates,
+                                       std::set<wxString>* declarations)
+{
+    for (size_t i = 0; i < obj->GetChildCount(); i++) {
+        GenSlimIncludes(obj->GetChild(i), headerIncludes, headerTemplates,
+                        sourceIncludes, sourceTemplates, declarations);
+    }
+    // The forms derive from their classes and the event handlers declared
+    // in the header take the event classes of the objects
+    PObjectBase parent = obj->GetParent();
+    bool inHeader = (parent && parent->GetTypeName() == "project");
+    for (size_t i = 0; i < obj->GetEventCount() && !inHeader; i++)
+        inHeader = !obj->GetEvent(i)->GetValue().empty();
+
+    // Only the objects declared by GenAttributeDeclaration are members
+    wxString declaration;
+    if (!inHeader && ObjectDatabase::HasCppProperties(obj->GetTypeName()))
+        declaration = GetCode(obj, "declaration");
+
+    std::set<wxString> classes;
+    if (!inHeader && GetPointerClasses(declaration, &classes)) {
+        for (const wxString& className : classes)
+            declarations->insert("class " + className + ";");
+
+        GenBaseIncludes(obj->GetObjectInfo(), obj, sourceIncludes, sourceTemplates);
+    } else {
+        GenBaseIncludes(obj->GetObjectInfo(), obj, headerIncludes, headerTemplates);
+    }
+}
+
 void CppCodeGenerator::GenBaseIncludes(PObjectInfo info, PObjectBase obj,
                                        std::vector<wxString>* includes,
                                        std::set<wxString>* templates)
@@ -1299,7 +1625,7 @@ void CppCodeGenerator::GenBaseIncludes(PObjectInfo info, PObjectBase obj,
     }
     PCodeInfo codeInfo = info->GetCodeInfo("C++");
     if (codeInfo) {
-        CppTemplateParser parser(obj, codeInfo->GetTemplate("include"),
+        CppTemplateParser parser(obj, codeInfo->GetCompiledTemplate("include"),
                                  m_useI18n, m_useRelativePath, m_basePath);
         wxString include = parser.ParseTemplate();
         if (!include.empty()) {
@@ -1584,18 +1910,16 @@ void CppCodeGenerator::GenConstruction(PObjectBase obj, bool is_widget,
         if (wxDefaultSize != toolbarsize) {
             PProperty prop = obj->GetProperty("bitmap");
             if (prop) {
-                wxString oldVal = prop->GetValueAsString();
+                const wxString value = prop->GetValueAsString();
                 wxString path, source;
                 wxSize toolsize;
-                TypeConv::ParseBitmapWithResource(oldVal, &path, &source, &toolsize);
+                TypeConv::ParseBitmapWithResource(value, &path, &source, &toolsize);
                 if (("Load From Icon Resource") == source
                     && wxDefaultSize == toolsize) {
-                    prop->SetValue(wxString::Format("%s; %s [%i; %i]", path.c_str(),
-                                                    source.c_str(),
-                                                    toolbarsize.GetWidth(),
-                                                    toolbarsize.GetHeight()));
-                    m_source->WriteLn(GetCode(obj, "construction"));
-                    prop->SetValue(oldVal);
+                    const wxString bitmap = wxString::Format(
+                        "%s; %s [%i; %i]", path.c_str(), source.c_str(),
+                        toolbarsize.GetWidth(), toolbarsize.GetHeight());
+                    m_source->WriteLn(GetCode(obj, "construction", { { "bitmap", bitmap } }));
                     return;
                 }
             }
@@ -1642,11 +1966,17 @@ void CppCodeGenerator::FindEventHandlers(PObjectBase obj, EventVector& events)
     }
 }
 
-void CppCodeGenerator::GenDefines(PObjectBase project)
+void CppCodeGenerator::GenDefines(PObjectBase project, PObjectBase form)
 {
     std::vector<wxString> macros;
     FindMacros(project, &macros);
 
+    // The IDs are numbered across the whole project, so the macros shared
+    // by several forms are redefined with the same value
+    std::vector<wxString> formMacros;
+    if (form)
+        FindMacros(form, &formMacros);
+
     // Remove the default macro from the set, for backward compatibility
     std::vector<wxString>::iterator it;
     it = std::find(macros.begin(), macros.end(), "ID_DEFAULT");
@@ -1661,7 +1991,8 @@ void CppCodeGenerator::GenDefines(PObjectBase project)
 
     for (it = macros.begin(); it != macros.end(); it++) {
         // Don't redefine wx IDs
-        m_header->WriteLn(wxString::Format("#define %s %i", it->c_str(), id));
+        if (!form || std::find(formMacros.begin(), formMacros.end(), *it) != formMacros.end())
+            m_header->WriteLn(wxString::Format("#define %s %i", it->c_str(), id));
         id++;
     }
     m_header->WriteLn(wxEmptyString);
@@ -1673,8 +2004,8 @@ void CppCodeGenerator::GenSettings(PObjectInfo info, PObjectBase obj)
     if (!codeInfo)
         return;
 
-    wxString _template = codeInfo->GetTemplate("settings");
-    if (!_template.empty()) {
+    PCompiledTemplate _template = codeInfo->GetCompiledTemplate("settings");
+    if (!_template->IsEmpty()) {
         CppTemplateParser parser(obj, _template,
                                  m_useI18n, m_useRelativePath, m_basePath);
         wxString code = parser.ParseTemplate();
@@ -1692,9 +2023,9 @@ void CppCodeGenerator::GenDestruction(PObjectBase obj)
 {
     PCodeInfo codeInfo = obj->GetObjectInfo()->GetCodeInfo("C++");
     if (codeInfo) {
-        wxString _template = codeInfo->GetTemplate("destruction");
+        PCompiledTemplate _template = codeInfo->GetCompiledTemplate("destruction");
 
-        if (!_template.empty()) {
+        if (!_template->IsEmpty()) {
             CppTemplateParser parser(obj, _template,
                                      m_useI18n, m_useRelativePath, m_basePath);
             wxString code = parser.ParseTemplate();
@@ -1724,8 +2055,8 @@ void CppCodeGenerator::GetAddToolbarCode(PObjectInfo info, PObjectBase obj, wxAr
     if (!codeInfo)
         return;
 
-    wxString _template = codeInfo->GetTemplate("toolbar_add");
-    if (!_template.empty()) {
+    PCompiledTemplate _template = codeInfo->GetCompiledTemplate("toolbar_add");
+    if (!_template->IsEmpty()) {
         CppTemplateParser parser(obj, _template,
                                  m_useI18n, m_useRelativePath, m_basePath);
         wxString code = parser.ParseTemplate();
@@ -1741,12 +2072,16 @@ void CppCodeGenerator::GetAddToolbarCode(PObjectInfo info, PObjectBase obj, wxAr
     }
 }
 
-void CppCodeGenerator::GenEmbeddedBitmapIncludes(PObjectBase project)
+void CppCodeGenerator::GenEmbeddedBitmapIncludes(PObjectBase project, PObjectBase root)
 {
     std::set<wxString> includeSet;
+    std::set<wxString> embeddedFiles;
 
     // We begin obtaining the "include" list
-    FindEmbeddedBitmapProperties(project, includeSet);
+    FindEmbeddedBitmapProperties(project, root, includeSet, embeddedFiles);
+
+    if (m_generateEmbeddedFiles && !embeddedFiles.empty())
+        FileToCArray::GenerateAll(embeddedFiles, project);
 
     if (includeSet.empty())
         return;
@@ -1760,8 +2095,9 @@ void CppCodeGenerator::GenEmbeddedBitmapIncludes(PObjectBase project)
     m_source->WriteLn();
 }
 
-void CppCodeGenerator::FindEmbeddedBitmapProperties(PObjectBase obj,
-                                                    std::set<wxString>& embedSet)
+void CppCodeGenerator::FindEmbeddedBitmapProperties(PObjectBase project, PObjectBase obj,
+                                                    std::set<wxString>& embedSet,
+                                                    std::set<wxString>& embeddedFiles)
 {
     /*
         We go through (browse) for each property in "obj" object. If any of the
@@ -1783,6 +2119,9 @@ void CppCodeGenerator::FindEmbeddedBitmapProperties(PObjectBase obj,
                 wxString absPath = TypeConv::MakeAbsolutePath(
                     path, AppData()->GetProjectPath());
 
+                // Included by the generated source
+                DependencyTracker::AddInput(absPath);
+
                 // It's supposed that "path" contains an absolute path to the file
                 // and not a relative one.
                 wxString relPath
@@ -1795,10 +2134,11 @@ void CppCodeGenerator::FindEmbeddedBitmapProperties(PObjectBase obj,
             } else if (source == "Load From Embedded File") {
                 wxString absPath = TypeConv::MakeAbsolutePath(
                     path, AppData()->GetProjectPath());
-                wxString includePath = FileToCArray::Generate(absPath);
+                wxString includePath = FileToCArray::GetIncludePath(absPath, project);
                 wxString inc;
                 inc << "#include \"" << includePath << "\"";
                 embedSet.insert(inc);
+                embeddedFiles.insert(absPath);
             }
 #if 0
             /*
@@ -1816,7 +2156,7 @@ void CppCodeGenerator::FindEmbeddedBitmapProperties(PObjectBase obj,
     count = obj->GetChildCount();
     for (i = 0; i < count; i++) {
         PObjectBase child = obj->GetChild(i);
-        FindEmbeddedBitmapProperties(child, embedSet);
+        FindEmbeddedBitmapProperties(project, child, embedSet, embeddedFiles);
     }
 }
 
@@ -23,6 +23,7 @@
 #include "codegen.h"
 #include "codeparser.h"
 
+#include <functional>
 #include <set>
 #include <vector>
 
@@ -38,11 +39,14 @@ public:
     CppTemplateParser(PObjectBase obj, wxString _template,
                       bool useI18N, bool useRelativePath, wxString basePath);
 
-    CppTemplateParser(const CppTemplateParser& that, wxString _template);
+    CppTemplateParser(PObjectBase obj, PCompiledTemplate _template,
+                      bool useI18N, bool useRelativePath, wxString basePath);
+
+    CppTemplateParser(const CppTemplateParser& that, PCompiledTemplate _template);
 
     // overrides for C++
     PTemplateParser CreateParser(const TemplateParser* oldparser,
-                                 wxString _template) override;
+                                 PCompiledTemplate _template) override;
 
     wxString RootWxParentToCode() override;
 
@@ -101,6 +105,27 @@ public:
     */
     void SetFirstID(const size_t id) { m_firstID = id; }
 
+    /** Set the cache used to skip the generation of the unchanged forms.
+    */
+    void SetFormCache(PFormCodeCache cache) { m_formCache = cache; }
+
+    /** Creates the writer of a file of the output directory.
+    */
+    typedef std::function<PCodeWriter(const wxString& fileName)> WriterFactory;
+
+    /** Set the factory of the writers of the files of each form, used when
+        the split_forms project property is set.
+
+        Without a factory, e.g. for the previews, all the forms are written
+        to the header and source writers.
+    */
+    void SetWriterFactory(WriterFactory factory) { m_writerFactory = factory; }
+
+    /** Set whether the headers of the embedded files are written, which
+        previews don't need since they only show the includes.
+    */
+    void SetGenerateEmbeddedFiles(bool generate) { m_generateEmbeddedFiles = generate; }
+
     /** Generate the project's code
     */
     bool GenerateCode(PObjectBase project) override;
@@ -124,7 +149,8 @@ private:
 
     /** Given an object and the name for a template, obtains the code.
     */
-    wxString GetCode(PObjectBase obj, wxString name);
+    wxString GetCode(PObjectBase obj, wxString name,
+                     const PropertyOverrides& overrides = PropertyOverrides());
 
     /** Gets the declaration fragment for the specified object.
 
@@ -137,9 +163,12 @@ private:
     */
     void FindDependencies(PObjectBase obj, std::set<PObjectInfo>& info_set);
 
-    /** Stores the needed "includes" set for the PT_BITMAP properties.
+    /** Stores the needed "includes" set for the PT_BITMAP properties,
+        and the files to embed.
     */
-    void FindEmbeddedBitmapProperties(PObjectBase obj, std::set<wxString>& embedset);
+    void FindEmbeddedBitmapProperties(PObjectBase project, PObjectBase obj,
+                                      std::set<wxString>& embedset,
+                                      std::set<wxString>& embeddedFiles);
 
     /** Stores all the properties for "macro" type objects, so that their
         related '#define' can be generated subsequently.
@@ -150,6 +179,43 @@ private:
      */
     void FindEventHandlers(PObjectBase obj, EventVector& events);
 
+    /** Gets the decoration of the class declarations, and the include
+        of the header defining it if @a include is not nullptr.
+    */
+    wxString GetClassDecoration(PObjectBase project, wxString* include);
+
+    /** Writes the code preceding the forms in the header and the source.
+
+        @param root The project, or the form when writing its own files.
+        @param file Name of the header, without extension.
+        @return The class decoration.
+    */
+    wxString GenFilePrologue(PObjectBase project, PObjectBase root, const wxString& file,
+                             const wxArrayString& namespaceArray, bool useEnum);
+
+    /** Writes the code following the forms in the header.
+    */
+    void GenFileEpilogue(const wxArrayString& namespaceArray);
+
+    /** Writes the project header and source when the forms have their
+        own files, and the files to embed used by all the forms.
+    */
+    void GenProjectFiles(PObjectBase project, const wxString& file);
+
+    /** Writes the header and the source of @a form, using the writer factory.
+
+        @param fragments The form code, as generated by GenForm().
+    */
+    bool GenFormFiles(PObjectBase project, PObjectBase form,
+                      const FormCodeCache::Fragments& fragments, bool useEnum);
+
+    /** Generates the declaration and the implementation of a top level form.
+
+        It only reads the object tree, so the forms can be generated
+        concurrently by copies of this generator with their own writers.
+    */
+    void GenForm(PObjectBase form, bool useEnum, const wxString& classDecoration);
+
     /** Generates classes declarations inside the header file.
     */
     void GenClassDeclaration(PObjectBase class_obj, bool use_enum,
@@ -200,6 +266,16 @@ private:
     void GenObjectIncludes(PObjectBase project, std::vector<wxString>* includes,
                            std::set<wxString>* templates);
 
+    /** Generates the '#include' section of the header, only for the forms
+        and the members that need their complete type, the other includes
+        go to the source and their classes are forward declared.
+    */
+    void GenSlimIncludes(PObjectBase obj, std::vector<wxString>* headerIncludes,
+                         std::set<wxString>* headerTemplates,
+                         std::vector<wxString>* sourceIncludes,
+                         std::set<wxString>* sourceTemplates,
+                         std::set<wxString>* declarations);
+
     void GenBaseIncludes(PObjectInfo info, PObjectBase obj,
                          std::vector<wxString>* includes,
                          std::set<wxString>* templates);
@@ -214,13 +290,15 @@ private:
                          std::set<wxString>* sourceIncludes,
                          std::vector<wxString>* headerIncludes);
 
-    /** Generates the '#include' section for the embedded bitmap properties.
+    /** Generates the '#include' section for the embedded bitmap properties
+        of @a root and its children.
     */
-    void GenEmbeddedBitmapIncludes(PObjectBase project);
+    void GenEmbeddedBitmapIncludes(PObjectBase project, PObjectBase root);
 
-    /** Generates the '#define' section for macros.
+    /** Generates the '#define' section for macros, only those used by
+        @a form if it is not empty.
     */
-    void GenDefines(PObjectBase project);
+    void GenDefines(PObjectBase project, PObjectBase form = PObjectBase());
 
     /** Generates an enum with wxWindow identifiers.
     */
@@ -270,10 +348,14 @@ private:
     CCodeParser m_inheritedCodeParser;
     PCodeWriter m_header;
     PCodeWriter m_source;
+    PFormCodeCache m_formCache;
+    WriterFactory m_writerFactory;
 
     wxString m_basePath;
 
     size_t m_firstID;
+    bool m_generateEmbeddedFiles;
+    bool m_slimHeaders;
     bool m_useRelativePath;
     bool m_useArrayEnum;
     bool m_useI18n;
@@ -0,0 +1,170 @@
+/*
+    wxWeaver - A GUI Designer Editor for wxWidgets.
+    Copyright (C) 2021 Andrea Zanellato <redtid3@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include "dependencies.h"
+
+#include "utils/fileutils.h"
+
+#include <wx/filename.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+/** Writes @a data unless @a file already holds it, so the build
+    doesn't see a new time stamp after every generation.
+*/
+bool WriteIfChanged(const std::string& data, const wxString& file)
+{
+    std::vector<char> current;
+    if (FileUtils::ReadFile(file, &current) && current.size() == data.size()
+        && std::equal(current.begin(), current.end(), data.begin()))
+        return true;
+
+    return FileUtils::WriteFileAtomically(data, file);
+}
+
+std::string EscapeMake(const wxString& file)
+{
+    std::string escaped;
+    for (const char c : std::string(file.utf8_str())) {
+        if (c == ' ' || c == '#')
+            escaped += '\\';
+        else if (c == '$')
+            escaped += '$';
+
+        escaped += c;
+    }
+    return escaped;
+}
+
+std::string EscapeJson(const wxString& text)
+{
+    std::string escaped = "\"";
+    for (const char c : std::string(text.utf8_str())) {
+        switch (c) {
+        case '"':
+            escaped += "\\\"";
+            break;
+        case '\\':
+            escaped += "\\\\";
+            break;
+        case '\n':
+            escaped += "\\n";
+            break;
+        case '\t':
+            escaped += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char code[8];
+                snprintf(code, sizeof(code), "\\u%04x", c);
+                escaped += code;
+            } else {
+                escaped += c;
+            }
+        }
+    }
+    return escaped + '"';
+}
+
+std::string JsonArray(const std::set<wxString>& files)
+{
+    std::string array = "[";
+    for (const wxString& file : files) {
+        array += (array.size() > 1 ? ",\n    " : "\n    ");
+        array += EscapeJson(file);
+    }
+    return array + (files.empty() ? "]" : "\n  ]");
+}
+} // namespace
+
+thread_local DependencyTracker* DependencyTracker::s_current = nullptr;
+
+DependencyTracker::Scope::Scope(DependencyTracker* tracker)
+    : m_previous(s_current)
+{
+    s_current = tracker;
+}
+
+DependencyTracker::Scope::~Scope()
+{
+    s_current = m_previous;
+}
+
+DependencyTracker* DependencyTracker::Get()
+{
+    return s_current;
+}
+
+void DependencyTracker::AddInput(const wxString& file)
+{
+    if (!s_current)
+        return;
+
+    const wxString path = NormalizePath(file);
+    std::lock_guard<std::mutex> lock(s_current->m_mutex);
+    s_current->m_inputs.insert(path);
+}
+
+void DependencyTracker::AddOutput(const wxString& file)
+{
+    if (!s_current)
+        return;
+
+    const wxString path = NormalizePath(file);
+    std::lock_guard<std::mutex> lock(s_current->m_mutex);
+    s_current->m_outputs.insert(path);
+}
+
+bool DependencyTracker::WriteDepfile(const wxString& file) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_outputs.empty())
+        return true;
+
+    std::string rule;
+    for (const wxString& output : m_outputs)
+        rule += (rule.empty() ? "" : " \\\n") + EscapeMake(output);
+
+    rule += ":";
+    for (const wxString& input : m_inputs)
+        rule += " \\\n  " + EscapeMake(input);
+
+    rule += "\n";
+    return WriteIfChanged(rule, file);
+}
+
+bool DependencyTracker::WriteManifest(const wxString& file, const wxString& project) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::string json = "{\n  \"project\": " + EscapeJson(NormalizePath(project));
+    json += ",\n  \"outputs\": " + JsonArray(m_outputs);
+    json += ",\n  \"inputs\": " + JsonArray(m_inputs);
+    json += "\n}\n";
+    return WriteIfChanged(json, file);
+}
+
+wxString DependencyTracker::NormalizePath(const wxString& file)
+{
+    wxFileName fileName(file);
+    fileName.Normalize(wxPATH_NORM_DOTS | wxPATH_NORM_ABSOLUTE);
+    return fileName.GetFullPath();
+}
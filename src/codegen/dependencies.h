@@ -0,0 +1,78 @@
+/*
+    wxWeaver - A GUI Designer Editor for wxWidgets.
+    Copyright (C) 2021 Andrea Zanellato <redtid3@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#pragma once
+
+#include <wx/string.h>
+
+#include <mutex>
+#include <set>
+
+/** Collects the files read and written while generating a project, so
+    build systems can tell when the generation has to run again.
+
+    The writers report to the tracker of their thread, if any, so the
+    generators don't need to know about it.
+*/
+class DependencyTracker {
+public:
+    /** Makes a tracker the one of the calling thread while in scope.
+    */
+    class Scope {
+    public:
+        explicit Scope(DependencyTracker* tracker);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        DependencyTracker* m_previous;
+    };
+
+    /** Gets the tracker of the calling thread, nullptr if there is none.
+    */
+    static DependencyTracker* Get();
+
+    /** Records a file read by the generation, or a file the generated code
+        depends on, in the tracker of the calling thread.
+    */
+    static void AddInput(const wxString& file);
+
+    /** Records a file written (or left unchanged) by the generation
+        in the tracker of the calling thread.
+    */
+    static void AddOutput(const wxString& file);
+
+    /** Writes a Makefile rule making every output depend on every input.
+    */
+    bool WriteDepfile(const wxString& file) const;
+
+    /** Writes the project, outputs and inputs as a JSON object.
+    */
+    bool WriteManifest(const wxString& file, const wxString& project) const;
+
+private:
+    static wxString NormalizePath(const wxString& file);
+
+    static thread_local DependencyTracker* s_current;
+
+    mutable std::mutex m_mutex;
+    std::set<wxString> m_inputs;
+    std::set<wxString> m_outputs;
+};
@@ -37,6 +37,15 @@ LuaTemplateParser::LuaTemplateParser(PObjectBase obj, wxString _template,
                                      bool useI18N, bool useRelativePath,
                                      wxString basePath,
                                      std::vector<wxString> strUserIDsVec)
+    : LuaTemplateParser(obj, CompiledTemplate::Compile(_template),
+                        useI18N, useRelativePath, basePath, strUserIDsVec)
+{
+}
+
+LuaTemplateParser::LuaTemplateParser(PObjectBase obj, PCompiledTemplate _template,
+                                     bool useI18N, bool useRelativePath,
+                                     wxString basePath,
+                                     std::vector<wxString> strUserIDsVec)
     : TemplateParser(obj, _template)
     , m_basePath(basePath)
     , m_strUserIDsVec(strUserIDsVec)
@@ -50,7 +59,7 @@ LuaTemplateParser::LuaTemplateParser(PObjectBase obj, wxString _template,
 }
 
 LuaTemplateParser::LuaTemplateParser(const LuaTemplateParser& other,
-                                     wxString _template,
+                                     PCompiledTemplate _template,
                                      std::vector<wxString> strUserIDsVec)
     : TemplateParser(other, _template)
     , m_basePath(other.m_basePath)
@@ -67,7 +76,7 @@ wxString LuaTemplateParser::RootWxParentToCode()
 }
 
 PTemplateParser LuaTemplateParser::CreateParser(const TemplateParser* oldparser,
-                                                wxString _template)
+                                                PCompiledTemplate _template)
 {
     const LuaTemplateParser* luaOldParser
         = dynamic_cast<const LuaTemplateParser*>(oldparser);
@@ -190,7 +199,6 @@ wxString LuaTemplateParser::ValueToCode(PropertyType type, wxString value)
     case PT_WXFONT: {
         if (!value.empty()) {
             wxFontContainer fontContainer = TypeConv::StringToFont(value);
-            wxFont font = fontContainer.GetFont();
 
             const int pointSize = fontContainer.GetPointSize();
 
@@ -200,8 +208,8 @@ wxString LuaTemplateParser::ValueToCode(PropertyType type, wxString value)
                      ? "wx.wxNORMAL_FONT:GetPointSize()"
                      : (wxString() << pointSize)),
                 "wx." + TypeConv::FontFamilyToString(fontContainer.GetFamily()),
-                "wx." + font.GetStyleString(),
-                "wx." + font.GetWeightString(),
+                "wx." + TypeConv::FontStyleToString(fontContainer.GetStyle()),
+                "wx." + TypeConv::FontWeightToString(fontContainer.GetWeight()),
                 (fontContainer.GetUnderlined() ? "True" : "False"),
                 (fontContainer.m_faceName.empty()
                      ? "\"\""
@@ -718,8 +726,8 @@ void LuaCodeGenerator::GenDefinedEventHandlers(PObjectInfo info, PObjectBase obj
 {
     PCodeInfo codeInfo = info->GetCodeInfo("Lua");
     if (codeInfo) {
-        wxString _template = codeInfo->GetTemplate("generated_event_handlers");
-        if (!_template.empty()) {
+        PCompiledTemplate _template = codeInfo->GetCompiledTemplate("generated_event_handlers");
+        if (!_template->IsEmpty()) {
             LuaTemplateParser parser(obj, _template, m_useI18n, m_useRelativePath,
                                      m_basePath, m_strUserIDsVec);
             wxString code = parser.ParseTemplate();
@@ -734,7 +742,8 @@ void LuaCodeGenerator::GenDefinedEventHandlers(PObjectInfo info, PObjectBase obj
     }
 }
 
-wxString LuaCodeGenerator::GetCode(PObjectBase obj, wxString name, bool silent /*= false*/, wxString strSelf /*= wxEmptyString*/)
+wxString LuaCodeGenerator::GetCode(PObjectBase obj, wxString name, bool silent /*= false*/, wxString strSelf /*= wxEmptyString*/,
+                                   const PropertyOverrides& overrides)
 {
     PCodeInfo codeInfo = obj->GetObjectInfo()->GetCodeInfo("Lua");
     if (!codeInfo) {
@@ -745,15 +754,23 @@ wxString LuaCodeGenerator::GetCode(PObjectBase obj, wxString name, bool silent /
         }
         return wxEmptyString;
     }
+    // Templates with placeholders replaced before parsing can't be cached
+    PCompiledTemplate compiled;
     wxString _template = codeInfo->GetTemplate(name);
-    _template.Replace("#parentname", strSelf);
-    if (!m_strUITable.empty())
-        _template.Replace("#utbl", m_strUITable + ".");
-    else
-        _template.Replace("#utbl", wxEmptyString);
+    if (_template.Contains("#parentname") || _template.Contains("#utbl")) {
+        _template.Replace("#parentname", strSelf);
+        if (!m_strUITable.empty())
+            _template.Replace("#utbl", m_strUITable + ".");
+        else
+            _template.Replace("#utbl", wxEmptyString);
 
-    LuaTemplateParser parser(obj, _template, m_useI18n, m_useRelativePath,
+        compiled = CompiledTemplate::Compile(_template);
+    } else {
+        compiled = codeInfo->GetCompiledTemplate(name);
+    }
+    LuaTemplateParser parser(obj, compiled, m_useI18n, m_useRelativePath,
                              m_basePath, m_strUserIDsVec);
+    parser.SetPropertyOverrides(overrides);
     wxString code = parser.ParseTemplate();
 
     //handle unsupported classes
@@ -779,13 +796,14 @@ wxString LuaCodeGenerator::GetCode(PObjectBase obj, wxString name, bool silent /
 }
 
 wxString LuaCodeGenerator::GetConstruction(PObjectBase obj, bool silent,
-                                           wxString strSelf, ArrayItems& arrays)
+                                           wxString strSelf, ArrayItems& arrays,
+                                           const PropertyOverrides& overrides)
 {
     // Get the name
     const auto& propName = obj->GetProperty("name");
     if (!propName) {
         // Object has no name, just get its code
-        return GetCode(obj, "construction", silent, strSelf);
+        return GetCode(obj, "construction", silent, strSelf, overrides);
     }
     // Object has a name, check if its an array
     const auto& name = propName->GetValueAsString();
@@ -793,13 +811,13 @@ wxString LuaCodeGenerator::GetConstruction(PObjectBase obj, bool silent,
     ArrayItem unused;
     if (!ParseArrayName(name, baseName, unused)) {
         // Object is not an array, just get its code
-        return GetCode(obj, "construction", silent, strSelf);
+        return GetCode(obj, "construction", silent, strSelf, overrides);
     }
     // Object is an array, check if it needs to be declared
     auto& item = arrays[baseName];
     if (item.isDeclared) {
         // Object is already declared, just get its code
-        return GetCode(obj, "construction", silent, strSelf);
+        return GetCode(obj, "construction", silent, strSelf, overrides);
     }
     // UI table code copied from TemplateParser
     wxString strTableName;
@@ -840,10 +858,8 @@ wxString LuaCodeGenerator::GetConstruction(PObjectBase obj, bool silent,
             stackNext.clear();
         }
     }
-    code.append(
-        GetCode(
-            obj, "construction", silent, strSelf)); // Get the Code
-    item.isDeclared = true;                         // Mark the array as declared
+    code.append(GetCode(obj, "construction", silent, strSelf, overrides)); // Get the Code
+    item.isDeclared = true; // Mark the array as declared
     return code;
 }
 
@@ -936,7 +952,7 @@ void LuaCodeGenerator::GenObjectIncludes(PObjectBase project,
     // Fill the set
     PCodeInfo codeInfo = project->GetObjectInfo()->GetCodeInfo("Lua");
     if (codeInfo) {
-        LuaTemplateParser parser(project, codeInfo->GetTemplate("include"),
+        LuaTemplateParser parser(project, codeInfo->GetCompiledTemplate("include"),
                                  m_useI18n, m_useRelativePath, m_basePath, m_strUserIDsVec);
         wxString include = parser.ParseTemplate();
         if (!include.empty()) {
@@ -968,7 +984,7 @@ void LuaCodeGenerator::GenBaseIncludes(PObjectInfo info, PObjectBase obj,
     if (!codeInfo)
         return;
 
-    LuaTemplateParser parser(obj, codeInfo->GetTemplate("include"),
+    LuaTemplateParser parser(obj, codeInfo->GetCompiledTemplate("include"),
                              m_useI18n, m_useRelativePath, m_basePath, m_strUserIDsVec);
 
     wxString include = parser.ParseTemplate();
@@ -1257,16 +1273,16 @@ void LuaCodeGenerator::GenConstruction(PObjectBase obj, bool is_widget,
         if (wxDefaultSize != toolbarsize) {
             PProperty prop = obj->GetProperty("bitmap");
             if (prop) {
-                wxString oldVal = prop->GetValueAsString();
+                const wxString value = prop->GetValueAsString();
                 wxString path, source;
                 wxSize toolsize;
-                TypeConv::ParseBitmapWithResource(oldVal, &path, &source, &toolsize);
+                TypeConv::ParseBitmapWithResource(value, &path, &source, &toolsize);
                 if (source == "Load From Icon Resource" && toolsize == wxDefaultSize) {
-                    prop->SetValue(wxString::Format(
+                    const wxString bitmap = wxString::Format(
                         "%s; %s [%i; %i]", path.c_str(), source.c_str(),
-                        toolbarsize.GetWidth(), toolbarsize.GetHeight()));
-                    m_source->WriteLn(GetConstruction(obj, false, wxEmptyString, arrays));
-                    prop->SetValue(oldVal);
+                        toolbarsize.GetWidth(), toolbarsize.GetHeight());
+                    m_source->WriteLn(GetConstruction(obj, false, wxEmptyString, arrays,
+                                                      { { "bitmap", bitmap } }));
                     return;
                 }
             }
@@ -1284,8 +1300,8 @@ void LuaCodeGenerator::GenDestruction(PObjectBase obj)
     PCodeInfo codeInfo = obj->GetObjectInfo()->GetCodeInfo("Lua");
 
     if (codeInfo) {
-        wxString _template = codeInfo->GetTemplate("destruction");
-        if (!_template.empty()) {
+        PCompiledTemplate _template = codeInfo->GetCompiledTemplate("destruction");
+        if (!_template->IsEmpty()) {
             LuaTemplateParser parser(obj, _template, m_useI18n, m_useRelativePath,
                                      m_basePath, m_strUserIDsVec);
             wxString code = parser.ParseTemplate();
@@ -1370,8 +1386,8 @@ void LuaCodeGenerator::GenSettings(PObjectInfo info, PObjectBase obj, wxString&
     if (!codeInfo)
         return;
 
-    wxString _template = codeInfo->GetTemplate("settings");
-    if (!_template.empty()) {
+    PCompiledTemplate _template = codeInfo->GetCompiledTemplate("settings");
+    if (!_template->IsEmpty()) {
         LuaTemplateParser parser(obj, _template, m_useI18n, m_useRelativePath,
                                  m_basePath, m_strUserIDsVec);
         wxString code = parser.ParseTemplate();
@@ -1403,8 +1419,8 @@ void LuaCodeGenerator::GetAddToolbarCode(PObjectInfo info, PObjectBase obj, wxAr
     if (!codeInfo)
         return;
 
-    wxString _template = codeInfo->GetTemplate("toolbar_add");
-    if (!_template.empty()) {
+    PCompiledTemplate _template = codeInfo->GetCompiledTemplate("toolbar_add");
+    if (!_template->IsEmpty()) {
         LuaTemplateParser parser(obj, _template, m_useI18n, m_useRelativePath,
                                  m_basePath, m_strUserIDsVec);
         wxString code = parser.ParseTemplate();
@@ -36,12 +36,17 @@ public:
                       wxString basePath,
                       std::vector<wxString> strUserIDsVec);
 
-    LuaTemplateParser(const LuaTemplateParser& other, wxString _template,
+    LuaTemplateParser(PObjectBase obj, PCompiledTemplate _template,
+                      bool useI18N, bool useRelativePath,
+                      wxString basePath,
+                      std::vector<wxString> strUserIDsVec);
+
+    LuaTemplateParser(const LuaTemplateParser& other, PCompiledTemplate _template,
                       std::vector<wxString> strUserIDsVec);
 
     // overrides for Lua
     PTemplateParser CreateParser(const TemplateParser* oldparser,
-                                 wxString _template) override;
+                                 PCompiledTemplate _template) override;
     wxString RootWxParentToCode() override;
 
     /** Convert the value of the property to Lua code
@@ -101,7 +106,8 @@ private:
     /** Given an object and the name for a template, obtains the code.
     */
     wxString GetCode(PObjectBase obj, wxString name, bool silent = false,
-                     wxString strSelf = wxEmptyString);
+                     wxString strSelf = wxEmptyString,
+                     const PropertyOverrides& overrides = PropertyOverrides());
 
     /** Gets the construction fragment for the specified object.
 
@@ -109,7 +115,8 @@ private:
         for array declarations.
     */
     wxString GetConstruction(PObjectBase obj, bool silent, wxString strSelf,
-                             ArrayItems& arrays);
+                             ArrayItems& arrays,
+                             const PropertyOverrides& overrides = PropertyOverrides());
 
     /** Stores the project's objects classes set, for generating the includes.
     */
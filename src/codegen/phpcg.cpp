@@ -36,6 +36,14 @@
 PHPTemplateParser::PHPTemplateParser(PObjectBase obj, wxString _template,
                                      bool useI18N, bool useRelativePath,
                                      wxString basePath)
+    : PHPTemplateParser(obj, CompiledTemplate::Compile(_template),
+                        useI18N, useRelativePath, basePath)
+{
+}
+
+PHPTemplateParser::PHPTemplateParser(PObjectBase obj, PCompiledTemplate _template,
+                                     bool useI18N, bool useRelativePath,
+                                     wxString basePath)
     : TemplateParser(obj, _template)
     , m_basePath(basePath)
     , m_useI18n(useI18N)
@@ -46,7 +54,7 @@ PHPTemplateParser::PHPTemplateParser(PObjectBase obj, wxString _template,
 }
 
 PHPTemplateParser::PHPTemplateParser(const PHPTemplateParser& other,
-                                     wxString _template)
+                                     PCompiledTemplate _template)
     : TemplateParser(other, _template)
     , m_basePath(other.m_basePath)
     , m_useI18n(other.m_useI18n)
@@ -60,7 +68,7 @@ wxString PHPTemplateParser::RootWxParentToCode()
 }
 
 PTemplateParser PHPTemplateParser::CreateParser(const TemplateParser* oldparser,
-                                                wxString _template)
+                                                PCompiledTemplate _template)
 {
     const PHPTemplateParser* phpOldParser
         = dynamic_cast<const PHPTemplateParser*>(oldparser);
@@ -151,7 +159,6 @@ wxString PHPTemplateParser::ValueToCode(PropertyType type, wxString value)
     case PT_WXFONT: {
         if (!value.empty()) {
             wxFontContainer fontContainer = TypeConv::StringToFont(value);
-            wxFont font = fontContainer.GetFont();
 
             const int pointSize = fontContainer.GetPointSize();
 
@@ -161,8 +168,8 @@ wxString PHPTemplateParser::ValueToCode(PropertyType type, wxString value)
                      ? "wxC2D(wxNORMAL_FONT)->GetPointSize()"
                      : (wxString() << pointSize)),
                 TypeConv::FontFamilyToString(fontContainer.GetFamily()),
-                font.GetStyleString(),
-                font.GetWeightString(),
+                TypeConv::FontStyleToString(fontContainer.GetStyle()),
+                TypeConv::FontWeightToString(fontContainer.GetWeight()),
                 (fontContainer.GetUnderlined() ? "true" : "false"),
                 (fontContainer.m_faceName.empty()
                      ? "wxEmptyString"
@@ -619,8 +626,8 @@ void PHPCodeGenerator::GenDefinedEventHandlers(PObjectInfo info, PObjectBase obj
 {
     PCodeInfo codeInfo = info->GetCodeInfo("PHP");
     if (codeInfo) {
-        wxString _template = codeInfo->GetTemplate("generated_event_handlers");
-        if (!_template.empty()) {
+        PCompiledTemplate _template = codeInfo->GetCompiledTemplate("generated_event_handlers");
+        if (!_template->IsEmpty()) {
             PHPTemplateParser parser(obj, _template,
                                      m_useI18n, m_useRelativePath, m_basePath);
 
@@ -636,7 +643,8 @@ void PHPCodeGenerator::GenDefinedEventHandlers(PObjectInfo info, PObjectBase obj
     }
 }
 
-wxString PHPCodeGenerator::GetCode(PObjectBase obj, wxString name, bool silent)
+wxString PHPCodeGenerator::GetCode(PObjectBase obj, wxString name, bool silent,
+                                   const PropertyOverrides& overrides)
 {
     PCodeInfo codeInfo = obj->GetObjectInfo()->GetCodeInfo("PHP");
     if (!codeInfo) {
@@ -648,19 +656,21 @@ wxString PHPCodeGenerator::GetCode(PObjectBase obj, wxString name, bool silent)
         }
         return wxEmptyString;
     }
-    wxString _template = codeInfo->GetTemplate(name);
+    PCompiledTemplate _template = codeInfo->GetCompiledTemplate(name);
     PHPTemplateParser parser(obj, _template, m_useI18n, m_useRelativePath, m_basePath);
+    parser.SetPropertyOverrides(overrides);
     wxString code = parser.ParseTemplate();
     return code;
 }
 
-wxString PHPCodeGenerator::GetConstruction(PObjectBase obj, ArrayItems& arrays)
+wxString PHPCodeGenerator::GetConstruction(PObjectBase obj, ArrayItems& arrays,
+                                           const PropertyOverrides& overrides)
 {
     // Get the name
     const auto& propName = obj->GetProperty("name");
     if (!propName) {
         // Object has no name, just get its code
-        return GetCode(obj, "construction");
+        return GetCode(obj, "construction", false, overrides);
     }
     // Object has a name, check if its an array
     const auto& name = propName->GetValueAsString();
@@ -668,13 +678,13 @@ wxString PHPCodeGenerator::GetConstruction(PObjectBase obj, ArrayItems& arrays)
     ArrayItem unused;
     if (!ParseArrayName(name, baseName, unused)) {
         // Object is not an array, just get its code
-        return GetCode(obj, "construction");
+        return GetCode(obj, "construction", false, overrides);
     }
     // Object is an array, check if it needs to be declared
     auto& item = arrays[baseName];
     if (item.isDeclared) {
         // Object is already declared, just get its code
-        return GetCode(obj, "construction");
+        return GetCode(obj, "construction", false, overrides);
     }
     // Array needs to be declared
     wxString code;
@@ -688,7 +698,7 @@ wxString PHPCodeGenerator::GetConstruction(PObjectBase obj, ArrayItems& arrays)
     // If more dimensions are present they will get created automatically
 
     // Get the Code
-    code.append(GetCode(obj, "construction"));
+    code.append(GetCode(obj, "construction", false, overrides));
 
     // Mark the array as declared
     item.isDeclared = true;
@@ -808,7 +818,7 @@ void PHPCodeGenerator::GenObjectIncludes(PObjectBase project,
     // Fill the set
     PCodeInfo codeInfo = project->GetObjectInfo()->GetCodeInfo("PHP");
     if (codeInfo) {
-        PHPTemplateParser parser(project, codeInfo->GetTemplate("include"),
+        PHPTemplateParser parser(project, codeInfo->GetCompiledTemplate("include"),
                                  m_useI18n, m_useRelativePath, m_basePath);
         wxString include = parser.ParseTemplate();
         if (!include.empty()) {
@@ -838,7 +848,7 @@ void PHPCodeGenerator::GenBaseIncludes(PObjectInfo info, PObjectBase obj,
     }
     PCodeInfo codeInfo = info->GetCodeInfo("PHP");
     if (codeInfo) {
-        PHPTemplateParser parser(obj, codeInfo->GetTemplate("include"),
+        PHPTemplateParser parser(obj, codeInfo->GetCompiledTemplate("include"),
                                  m_useI18n, m_useRelativePath, m_basePath);
         wxString include = parser.ParseTemplate();
         if (!include.empty()) {
@@ -1085,17 +1095,16 @@ void PHPCodeGenerator::GenConstruction(PObjectBase obj, bool is_widget, ArrayIte
         if (wxDefaultSize != toolbarsize) {
             PProperty prop = obj->GetProperty("bitmap");
             if (prop) {
-                wxString oldVal = prop->GetValueAsString();
+                const wxString value = prop->GetValueAsString();
                 wxString path, source;
                 wxSize toolsize;
-                TypeConv::ParseBitmapWithResource(oldVal, &path, &source, &toolsize);
+                TypeConv::ParseBitmapWithResource(value, &path, &source, &toolsize);
                 if (source == "Load From Icon Resource"
                     && toolsize == wxDefaultSize) {
-                    prop->SetValue(wxString::Format(
+                    const wxString bitmap = wxString::Format(
                         "%s; %s [%i; %i]", path.c_str(), source.c_str(),
-                        toolbarsize.GetWidth(), toolbarsize.GetHeight()));
-                    m_source->WriteLn(GetConstruction(obj, arrays));
-                    prop->SetValue(oldVal);
+                        toolbarsize.GetWidth(), toolbarsize.GetHeight());
+                    m_source->WriteLn(GetConstruction(obj, arrays, { { "bitmap", bitmap } }));
                     return;
                 }
             }
@@ -1112,8 +1121,8 @@ void PHPCodeGenerator::GenDestruction(PObjectBase obj)
 {
     PCodeInfo codeInfo = obj->GetObjectInfo()->GetCodeInfo("PHP");
     if (codeInfo) {
-        wxString _template = codeInfo->GetTemplate("destruction");
-        if (!_template.empty()) {
+        PCompiledTemplate _template = codeInfo->GetCompiledTemplate("destruction");
+        if (!_template->IsEmpty()) {
             PHPTemplateParser parser(obj, _template,
                                      m_useI18n, m_useRelativePath, m_basePath);
             wxString code = parser.ParseTemplate();
@@ -1196,8 +1205,8 @@ void PHPCodeGenerator::GenSettings(PObjectInfo info, PObjectBase obj)
     if (!codeInfo)
         return;
 
-    wxString _template = codeInfo->GetTemplate("settings");
-    if (!_template.empty()) {
+    PCompiledTemplate _template = codeInfo->GetCompiledTemplate("settings");
+    if (!_template->IsEmpty()) {
         PHPTemplateParser parser(obj, _template, m_useI18n, m_useRelativePath, m_basePath);
         wxString code = parser.ParseTemplate();
         if (!code.empty())
@@ -1225,8 +1234,8 @@ void PHPCodeGenerator::GetAddToolbarCode(PObjectInfo info, PObjectBase obj,
     if (!codeInfo)
         return;
 
-    wxString _template = codeInfo->GetTemplate("toolbar_add");
-    if (!_template.empty()) {
+    PCompiledTemplate _template = codeInfo->GetCompiledTemplate("toolbar_add");
+    if (!_template->IsEmpty()) {
         PHPTemplateParser parser(obj, _template, m_useI18n,
                                  m_useRelativePath, m_basePath);
         wxString code = parser.ParseTemplate();
@@ -33,11 +33,14 @@ public:
     PHPTemplateParser(PObjectBase obj, wxString _template,
                       bool useI18N, bool useRelativePath, wxString basePath);
 
-    PHPTemplateParser(const PHPTemplateParser& other, wxString _template);
+    PHPTemplateParser(PObjectBase obj, PCompiledTemplate _template,
+                      bool useI18N, bool useRelativePath, wxString basePath);
+
+    PHPTemplateParser(const PHPTemplateParser& other, PCompiledTemplate _template);
 
     // overrides for PHP
     PTemplateParser CreateParser(const TemplateParser* oldparser,
-                                 wxString _template) override;
+                                 PCompiledTemplate _template) override;
     wxString RootWxParentToCode() override;
 
     /** Convert the value of the property to PHP code
@@ -90,13 +93,15 @@ private:
 
     /** Given an object and the name for a template, obtains the code.
     */
-    wxString GetCode(PObjectBase obj, wxString name, bool silent = false);
+    wxString GetCode(PObjectBase obj, wxString name, bool silent = false,
+                     const PropertyOverrides& overrides = PropertyOverrides());
 
     /** Gets the construction fragment for the specified object.
 
         This method encapsulates the adjustments that need to be made for array declarations.
     */
-    wxString GetConstruction(PObjectBase obj, ArrayItems& arrays);
+    wxString GetConstruction(PObjectBase obj, ArrayItems& arrays,
+                             const PropertyOverrides& overrides = PropertyOverrides());
 
     /** Stores the project's objects classes set, for generating the includes.
     */
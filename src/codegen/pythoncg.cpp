@@ -37,6 +37,16 @@ PythonTemplateParser::PythonTemplateParser(PObjectBase obj, wxString _template,
                                            bool useI18N, bool useRelativePath,
                                            wxString basePath,
                                            wxString imagePathWrapperFunctionName)
+    : PythonTemplateParser(obj, CompiledTemplate::Compile(_template),
+                           useI18N, useRelativePath, basePath,
+                           imagePathWrapperFunctionName)
+{
+}
+
+PythonTemplateParser::PythonTemplateParser(PObjectBase obj, PCompiledTemplate _template,
+                                           bool useI18N, bool useRelativePath,
+                                           wxString basePath,
+                                           wxString imagePathWrapperFunctionName)
     : TemplateParser(obj, _template)
     , m_basePath(basePath)
     , m_imagePathWrapperFunctionName(imagePathWrapperFunctionName)
@@ -50,7 +60,7 @@ PythonTemplateParser::PythonTemplateParser(PObjectBase obj, wxString _template,
 }
 
 PythonTemplateParser::PythonTemplateParser(const PythonTemplateParser& other,
-                                           wxString _template)
+                                           PCompiledTemplate _template)
     : TemplateParser(other, _template)
     , m_basePath(other.m_basePath)
     , m_imagePathWrapperFunctionName(other.m_imagePathWrapperFunctionName)
@@ -66,7 +76,7 @@ wxString PythonTemplateParser::RootWxParentToCode()
 }
 
 PTemplateParser PythonTemplateParser::CreateParser(const TemplateParser* oldparser,
-                                                   wxString _template)
+                                                   PCompiledTemplate _template)
 {
     const PythonTemplateParser* pythonOldParser
         = dynamic_cast<const PythonTemplateParser*>(oldparser);
@@ -179,7 +189,6 @@ wxString PythonTemplateParser::ValueToCode(PropertyType type, wxString value)
     case PT_WXFONT: {
         if (!value.empty()) {
             wxFontContainer fontContainer = TypeConv::StringToFont(value);
-            wxFont font = fontContainer.GetFont();
             const int pointSize = fontContainer.GetPointSize();
             result = wxString::Format(
                 "wx.Font( %s, %s, %s, %s, %s, %s )",
@@ -187,8 +196,8 @@ wxString PythonTemplateParser::ValueToCode(PropertyType type, wxString value)
                      ? "wx.NORMAL_FONT.GetPointSize()"
                      : (wxString() << pointSize)),
                 TypeConv::FontFamilyToString(fontContainer.GetFamily()).replace(0, 2, "wx."),
-                font.GetStyleString().replace(0, 2, "wx."),
-                font.GetWeightString().replace(0, 2, "wx."),
+                TypeConv::FontStyleToString(fontContainer.GetStyle()).replace(0, 2, "wx."),
+                TypeConv::FontWeightToString(fontContainer.GetWeight()).replace(0, 2, "wx."),
                 (fontContainer.GetUnderlined() ? "True" : "False"),
                 (fontContainer.m_faceName.empty()
                      ? "wx.EmptyString"
@@ -638,8 +647,8 @@ void PythonCodeGenerator::GenDefinedEventHandlers(PObjectInfo info, PObjectBase
 {
     PCodeInfo codeInfo = info->GetCodeInfo("Python");
     if (codeInfo) {
-        wxString _template = codeInfo->GetTemplate("generated_event_handlers");
-        if (!_template.empty()) {
+        PCompiledTemplate _template = codeInfo->GetCompiledTemplate("generated_event_handlers");
+        if (!_template->IsEmpty()) {
             PythonTemplateParser parser(obj, _template, m_useI18n, m_useRelativePath,
                                         m_basePath, m_imagePathWrapperFunctionName);
             wxString code = parser.ParseTemplate();
@@ -667,7 +676,8 @@ void PythonCodeGenerator::GenImagePathWrapperFunction()
     }
 }
 
-wxString PythonCodeGenerator::GetCode(PObjectBase obj, wxString name, bool silent)
+wxString PythonCodeGenerator::GetCode(PObjectBase obj, wxString name, bool silent,
+                                      const PropertyOverrides& overrides)
 {
     PCodeInfo codeInfo = obj->GetObjectInfo()->GetCodeInfo("Python");
     if (!codeInfo) {
@@ -679,21 +689,23 @@ wxString PythonCodeGenerator::GetCode(PObjectBase obj, wxString name, bool silen
         }
         return wxEmptyString;
     }
-    wxString _template = codeInfo->GetTemplate(name);
+    PCompiledTemplate _template = codeInfo->GetCompiledTemplate(name);
     PythonTemplateParser parser(obj, _template, m_useI18n, m_useRelativePath,
                                 m_basePath, m_imagePathWrapperFunctionName);
+    parser.SetPropertyOverrides(overrides);
     wxString code = parser.ParseTemplate();
     return code;
 }
 
 wxString PythonCodeGenerator::GetConstruction(PObjectBase obj, bool silent,
-                                              ArrayItems& arrays)
+                                              ArrayItems& arrays,
+                                              const PropertyOverrides& overrides)
 {
     // Get the name
     const auto& propName = obj->GetProperty("name");
     if (!propName) {
         // Object has no name, just get its code
-        return GetCode(obj, "construction", silent);
+        return GetCode(obj, "construction", silent, overrides);
     }
     // Object has a name, check if its an array
     const auto& name = propName->GetValueAsString();
@@ -701,13 +713,13 @@ wxString PythonCodeGenerator::GetConstruction(PObjectBase obj, bool silent,
     ArrayItem unused;
     if (!ParseArrayName(name, baseName, unused)) {
         // Object is not an array, just get its code
-        return GetCode(obj, "construction", silent);
+        return GetCode(obj, "construction", silent, overrides);
     }
     // Object is an array, check if it needs to be declared
     auto& item = arrays[baseName];
     if (item.isDeclared) {
         // Object is already declared, just get its code
-        return GetCode(obj, "construction", silent);
+        return GetCode(obj, "construction", silent, overrides);
     }
     // Array needs to be declared
     // Base array
@@ -742,7 +754,7 @@ wxString PythonCodeGenerator::GetConstruction(PObjectBase obj, bool silent,
         }
     }
     // Get the Code
-    code.append(GetCode(obj, "construction", silent));
+    code.append(GetCode(obj, "construction", silent, overrides));
 
     // Mark the array as declared
     item.isDeclared = true;
@@ -856,7 +868,7 @@ void PythonCodeGenerator::GenObjectIncludes(PObjectBase project,
     // Fill the set
     PCodeInfo codeInfo = project->GetObjectInfo()->GetCodeInfo("Python");
     if (codeInfo) {
-        PythonTemplateParser parser(project, codeInfo->GetTemplate("include"),
+        PythonTemplateParser parser(project, codeInfo->GetCompiledTemplate("include"),
                                     m_useI18n, m_useRelativePath, m_basePath,
                                     m_imagePathWrapperFunctionName);
         wxString include = parser.ParseTemplate();
@@ -887,7 +899,7 @@ void PythonCodeGenerator::GenBaseIncludes(PObjectInfo info, PObjectBase obj,
     }
     PCodeInfo codeInfo = info->GetCodeInfo("Python");
     if (codeInfo) {
-        PythonTemplateParser parser(obj, codeInfo->GetTemplate("include"),
+        PythonTemplateParser parser(obj, codeInfo->GetCompiledTemplate("include"),
                                     m_useI18n, m_useRelativePath, m_basePath,
                                     m_imagePathWrapperFunctionName);
         wxString include = parser.ParseTemplate();
@@ -1139,18 +1151,18 @@ void PythonCodeGenerator::GenConstruction(PObjectBase obj, bool is_widget,
         if (wxDefaultSize != toolbarsize) {
             PProperty prop = obj->GetProperty("bitmap");
             if (prop) {
-                wxString oldVal = prop->GetValueAsString();
+                const wxString value = prop->GetValueAsString();
                 wxString path, source;
                 wxSize toolsize;
-                TypeConv::ParseBitmapWithResource(oldVal, &path, &source, &toolsize);
+                TypeConv::ParseBitmapWithResource(value, &path, &source, &toolsize);
                 if ("Load From Icon Resource" == source
                     && wxDefaultSize == toolsize) {
-                    prop->SetValue(wxString::Format(
+                    const wxString bitmap = wxString::Format(
                         "%s; %s [%i; %i]",
                         path.c_str(), source.c_str(),
-                        toolbarsize.GetWidth(), toolbarsize.GetHeight()));
-                    m_source->WriteLn(GetConstruction(obj, false, arrays));
-                    prop->SetValue(oldVal);
+                        toolbarsize.GetWidth(), toolbarsize.GetHeight());
+                    m_source->WriteLn(
+                        GetConstruction(obj, false, arrays, { { "bitmap", bitmap } }));
                     return;
                 }
             }
@@ -1167,8 +1179,8 @@ void PythonCodeGenerator::GenDestruction(PObjectBase obj)
 {
     PCodeInfo codeInfo = obj->GetObjectInfo()->GetCodeInfo("Python");
     if (codeInfo) {
-        wxString _template = codeInfo->GetTemplate("destruction");
-        if (!_template.empty()) {
+        PCompiledTemplate _template = codeInfo->GetCompiledTemplate("destruction");
+        if (!_template->IsEmpty()) {
             PythonTemplateParser parser(obj, _template, m_useI18n,
                                         m_useRelativePath, m_basePath,
                                         m_imagePathWrapperFunctionName);
@@ -1257,8 +1269,8 @@ void PythonCodeGenerator::GenSettings(PObjectInfo info, PObjectBase obj)
     if (!codeInfo)
         return;
 
-    wxString _template = codeInfo->GetTemplate("settings");
-    if (!_template.empty()) {
+    PCompiledTemplate _template = codeInfo->GetCompiledTemplate("settings");
+    if (!_template->IsEmpty()) {
         PythonTemplateParser parser(obj, _template, m_useI18n, m_useRelativePath,
                                     m_basePath, m_imagePathWrapperFunctionName);
         wxString code = parser.ParseTemplate();
@@ -1286,8 +1298,8 @@ void PythonCodeGenerator::GetAddToolbarCode(PObjectInfo info, PObjectBase obj, w
     if (!codeInfo)
         return;
 
-    wxString _template = codeInfo->GetTemplate("toolbar_add");
-    if (!_template.empty()) {
+    PCompiledTemplate _template = codeInfo->GetCompiledTemplate("toolbar_add");
+    if (!_template->IsEmpty()) {
         PythonTemplateParser parser(obj, _template, m_useI18n, m_useRelativePath,
                                     m_basePath, m_imagePathWrapperFunctionName);
         wxString code = parser.ParseTemplate();
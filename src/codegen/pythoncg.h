@@ -36,11 +36,15 @@ public:
                          bool useI18N, bool useRelativePath, wxString basePath,
                          wxString imagePathWrapperFunctionName);
 
-    PythonTemplateParser(const PythonTemplateParser& other, wxString _template);
+    PythonTemplateParser(PObjectBase obj, PCompiledTemplate _template,
+                         bool useI18N, bool useRelativePath, wxString basePath,
+                         wxString imagePathWrapperFunctionName);
+
+    PythonTemplateParser(const PythonTemplateParser& other, PCompiledTemplate _template);
 
     // overrides for Python
     PTemplateParser CreateParser(const TemplateParser* oldparser,
-                                 wxString _template) override;
+                                 PCompiledTemplate _template) override;
     wxString RootWxParentToCode() override;
 
     /** Convert the value of the property to Python code
@@ -106,13 +110,15 @@ private:
 
     /** Given an object and the name for a template, obtains the code.
     */
-    wxString GetCode(PObjectBase obj, wxString name, bool silent = false);
+    wxString GetCode(PObjectBase obj, wxString name, bool silent = false,
+                     const PropertyOverrides& overrides = PropertyOverrides());
 
     /** Gets the construction fragment for the specified object.
 
         This method encapsulates the adjustments that need to be made for array declarations.
     */
-    wxString GetConstruction(PObjectBase obj, bool silent, ArrayItems& arrays);
+    wxString GetConstruction(PObjectBase obj, bool silent, ArrayItems& arrays,
+                             const PropertyOverrides& overrides = PropertyOverrides());
 
     /** Stores the project's objects classes set, for generating the includes.
     */
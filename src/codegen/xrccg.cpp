@@ -22,10 +22,250 @@
 #include "codegen/xrccg.h"
 #include "rtti/objectbase.h"
 #include "codegen/codewriter.h"
+#include "codegen/dependencies.h"
+#include "utils/exception.h"
+#include "utils/filetocarray.h"
+#include "utils/fileutils.h"
 #include "utils/typeconv.h"
+#include "appdata.h"
 
 #include <ticpp.h>
 
+#include <wx/filename.h>
+#include <wx/log.h>
+#include <wx/mstream.h>
+#include <wx/zipstrm.h>
+
+#include <algorithm>
+#include <memory>
+
+namespace {
+/** Replaces the texts of the descendants of @a element found in @a texts.
+*/
+void ReplaceTexts(ticpp::Element* element, const std::map<std::string, std::string>& texts)
+{
+    for (ticpp::Element* child = element->FirstChildElement(false); child;
+         child = child->NextSiblingElement(false)) {
+        auto it = texts.find(child->GetText(false));
+        if (it != texts.end())
+            child->SetText(it->second);
+        else
+            ReplaceTexts(child, texts);
+    }
+}
+} // namespace
+
+/** Prints the elements in the same format as TiXmlPrinter, one by one.
+
+    The started elements are only written when their first child is, or when
+    they end, so that the children can still change them, and the output is
+    passed to the code writer in chunks of complete elements.
+*/
+class XrcCodeGenerator::Writer : public TiXmlVisitor {
+public:
+    /** @param codeWriter Target of the output, if nullptr it is kept in memory.
+        @param depth Indentation level of the first element.
+    */
+    Writer(PCodeWriter codeWriter, int depth)
+        : m_codeWriter(codeWriter)
+        , m_depth(depth)
+    {
+    }
+
+    /** Starts an element, the following ones are its children until it ends.
+    */
+    ticpp::Element* Open(std::unique_ptr<ticpp::Element> element)
+    {
+        m_levels.push_back({ std::move(element), false });
+        return m_levels.back().element.get();
+    }
+
+    /** Ends the last started element.
+    */
+    void Close()
+    {
+        Level& level = m_levels.back();
+        if (level.written) {
+            --m_depth;
+            Indent();
+            m_buffer += "</" + level.element->Value() + ">\n";
+        } else {
+            WriteStarted(m_levels.size() - 1);
+            level.element->Accept(this);
+        }
+        m_levels.pop_back();
+        WriteChunk(false);
+    }
+
+    /** Writes a complete node as a child of the last started element.
+    */
+    void Write(const ticpp::Node& node)
+    {
+        WriteStarted(m_levels.size());
+        node.Accept(this);
+        WriteChunk(false);
+    }
+
+    /** Writes the output of another writer as a child of the last started element.
+    */
+    void Write(const std::string& xml)
+    {
+        WriteStarted(m_levels.size());
+        m_buffer += xml;
+        WriteChunk(false);
+    }
+
+    /** Passes the rest of the output to the code writer,
+        or returns it if there is none.
+    */
+    std::string Finish()
+    {
+        WriteChunk(true);
+        return std::move(m_buffer);
+    }
+
+    bool VisitEnter(const TiXmlElement& element, const TiXmlAttribute* firstAttribute) override
+    {
+        Indent();
+        m_buffer += "<" + element.ValueStr();
+        for (const TiXmlAttribute* attribute = firstAttribute; attribute;
+             attribute = attribute->Next()) {
+            m_buffer += " ";
+            attribute->Print(nullptr, 0, &m_buffer);
+        }
+        if (&element == m_started) {
+            // The children written later follow the current ones
+            m_buffer += ">\n";
+        } else if (!element.FirstChild()) {
+            m_buffer += " />\n";
+        } else {
+            m_buffer += ">";
+            const TiXmlText* text = element.FirstChild()->ToText();
+            if (text && element.LastChild() == element.FirstChild() && !text->CDATA())
+                m_simpleText = true;
+            else
+                m_buffer += "\n";
+        }
+        ++m_depth;
+        return true;
+    }
+
+    bool VisitExit(const TiXmlElement& element) override
+    {
+        if (&element == m_started)
+            return true;
+
+        --m_depth;
+        if (!element.FirstChild())
+            return true;
+
+        if (m_simpleText)
+            m_simpleText = false;
+        else
+            Indent();
+
+        m_buffer += "</" + element.ValueStr() + ">\n";
+        return true;
+    }
+
+    bool Visit(const TiXmlDeclaration& declaration) override
+    {
+        Indent();
+        declaration.Print(nullptr, 0, &m_buffer);
+        m_buffer += "\n";
+        return true;
+    }
+
+    bool Visit(const TiXmlText& text) override
+    {
+        if (text.CDATA()) {
+            Indent();
+            m_buffer += "<![CDATA[" + text.ValueStr() + "]]>\n";
+            return true;
+        }
+        if (!m_simpleText)
+            Indent();
+
+        TIXML_STRING encoded;
+        TiXmlBase::EncodeString(text.ValueTStr(), &encoded);
+        m_buffer += encoded;
+        if (!m_simpleText)
+            m_buffer += "\n";
+
+        return true;
+    }
+
+    bool Visit(const TiXmlComment& comment) override
+    {
+        Indent();
+        m_buffer += "<!--" + comment.ValueStr() + "-->\n";
+        return true;
+    }
+
+    bool Visit(const TiXmlUnknown& unknown) override
+    {
+        Indent();
+        m_buffer += "<" + unknown.ValueStr() + ">\n";
+        return true;
+    }
+
+private:
+    struct Level {
+        std::unique_ptr<ticpp::Element> element;
+        bool written;
+    };
+    // Enough to avoid converting the output in small pieces
+    static const size_t ChunkSize = 64 * 1024;
+
+    void Indent() { m_buffer.append(m_depth, '\t'); }
+
+    /** Writes the start of the first @a count started elements not yet written.
+    */
+    void WriteStarted(size_t count)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            Level& level = m_levels[i];
+            if (level.written)
+                continue;
+
+            // Prints the start tag and the current children, leaving it open
+            StartedElementFinder finder;
+            level.element->Accept(&finder);
+            m_started = finder.element;
+            level.element->Accept(this);
+            m_started = nullptr;
+            level.written = true;
+        }
+    }
+
+    void WriteChunk(bool force)
+    {
+        if (!m_codeWriter || (!force && m_buffer.size() < ChunkSize))
+            return;
+
+        m_codeWriter->WriteFormatted(wxString(m_buffer));
+        m_buffer.clear();
+    }
+
+    /** Gets the TinyXML element of a ticpp one.
+    */
+    struct StartedElementFinder : public TiXmlVisitor {
+        bool VisitEnter(const TiXmlElement& visited, const TiXmlAttribute*) override
+        {
+            element = &visited;
+            return false;
+        }
+        const TiXmlElement* element = nullptr;
+    };
+
+    PCodeWriter m_codeWriter;
+    std::vector<Level> m_levels;
+    std::string m_buffer;
+    const TiXmlElement* m_started = nullptr;
+    int m_depth;
+    bool m_simpleText = false;
+};
+
 void XrcCodeGenerator::SetWriter(PCodeWriter cw)
 {
     m_codeWriter = cw;
@@ -36,148 +276,290 @@ bool XrcCodeGenerator::GenerateCode(PObjectBase project)
     m_codeWriter->Clear();
     m_contextMenus.clear();
 
-    ticpp::Document doc;
-    ticpp::Declaration decl("1.0", "UTF-8", "yes");
-    doc.LinkEndChild(&decl);
+    Writer writer(m_codeWriter, 0);
+    writer.Write(ticpp::Declaration("1.0", "UTF-8", "yes"));
 
-    ticpp::Element element("resource");
-    element.SetAttribute("xmlns", "http://www.wxwidgets.org/wxxrc");
-    element.SetAttribute("version", "2.5.3.0");
+    std::unique_ptr<ticpp::Element> element(new ticpp::Element("resource"));
+    element->SetAttribute("xmlns", "http://www.wxwidgets.org/wxxrc");
+    element->SetAttribute("version", "2.5.3.0");
+    writer.Open(std::move(element));
 
     // If project is not actually a "Project", generate it
     if (project->GetClassName() == "Project") {
-        for (size_t i = 0; i < project->GetChildCount(); i++) {
-            ticpp::Element* child = GetElement(project->GetChild(i));
-            if (child) {
-                element.LinkEndChild(child);
-                delete child;
-            }
-        }
+        for (size_t i = 0; i < project->GetChildCount(); i++)
+            WriteElement(&writer, project->GetChild(i));
     } else {
-        ticpp::Element* child = GetElement(project);
-        if (child) {
-            element.LinkEndChild(child);
-            delete child;
-        }
+        WriteElement(&writer, project);
     }
     // generate context menus as top-level menus
-    for (std::vector<ticpp::Element*>::iterator it
-         = m_contextMenus.begin();
-         it != m_contextMenus.end(); ++it) {
-        element.LinkEndChild(*it);
-        delete *it;
+    for (const std::string& contextMenu : m_contextMenus)
+        writer.Write(contextMenu);
+
+    m_contextMenus.clear();
+    writer.Close();
+    writer.Finish();
+    return true;
+}
+
+bool XrcCodeGenerator::GenerateFiles(PObjectBase project, const wxString& basePath)
+{
+    const wxString output = project->GetPropertyAsString("xrc_output");
+    if (output != "xrs" && output != "cpp") {
+        SetWriter(PCodeWriter(new FileCodeWriter(basePath + ".xrc")));
+        return GenerateCode(project);
     }
-    doc.LinkEndChild(&element);
+    std::string archive;
+    const bool success = GenerateArchive(project, &archive);
+    if (output == "cpp") {
+        wxString function = project->GetPropertyAsString("xrs_function");
+        if (function.empty())
+            function = "InitXmlResource";
 
-    TiXmlPrinter printer;
-    printer.SetIndent("\t");
-    printer.SetLineBreak("\n");
+        GenerateArchiveSource(archive, wxFileName(basePath).GetFullName() + ".xrs", function,
+                              PCodeWriter(new FileCodeWriter(basePath + "_xrs.cpp")));
+        return success;
+    }
+    // An output of the generation even if left unchanged
+    const wxString file = basePath + ".xrs";
+    DependencyTracker::AddOutput(file);
 
-    doc.Accept(&printer);
-    const std::string& xrcFile = printer.Str();
+    std::vector<char> previous;
+    if (FileUtils::ReadFile(file, &previous) && previous.size() == archive.size()
+        && std::equal(previous.begin(), previous.end(), archive.begin())) {
+        return success;
+    }
+    if (!FileUtils::WriteFileAtomically(archive, file))
+        wxWEAVER_THROW_EX("Unable to write file: " << file);
 
-    m_codeWriter->Write(xrcFile);
-    return true;
+    return success;
 }
 
-ticpp::Element* XrcCodeGenerator::GetElement(PObjectBase obj, ticpp::Element* parent)
+bool XrcCodeGenerator::WriteElement(Writer* writer, PObjectBase obj, ticpp::Element* parent)
 {
-    ticpp::Element* element = nullptr;
+    std::unique_ptr<ticpp::Element> element;
     IComponent* comp = obj->GetObjectInfo()->GetComponent();
     if (comp)
-        element = comp->ExportToXrc(obj.get());
-
-    if (element) {
-        std::string className = element->GetAttribute("class");
-        if (className == "__dummyitem__") {
-            delete element;
-            element = nullptr;
-
-            if (obj->GetChildCount() > 0)
-                element = GetElement(obj->GetChild(0));
-
-            return element;
-        } else if (className == "spacer") {
-            // Dirty hack to replace the containing sizeritem with the spacer
-            if (parent) {
-                parent->SetAttribute("class", "spacer");
-                for (ticpp::Node* child = element->FirstChild(false);
-                     child; child = child->NextSibling(false)) {
-                    parent->LinkEndChild(child->Clone().release());
-                }
-                delete element;
-                return nullptr;
-            }
-        } else if (className == "wxFrame") {
-            // Dirty hack to prevent sizer generation directly under a wxFrame
-            // If there is a sizer, the size property of the wxFrame is ignored
-            // when loading the xrc file at runtime
-            if (obj->GetPropertyAsInteger("xrc_skip_sizer")) {
-                for (size_t i = 0; i < obj->GetChildCount(); i++) {
-                    ticpp::Element* aux = nullptr;
-                    PObjectBase child = obj->GetChild(i);
-
-                    if (child->GetObjectInfo()->IsSubclassOf("sizer")) {
-                        if (child->GetChildCount() == 1) {
-                            PObjectBase sizeritem = child->GetChild(0);
-                            if (sizeritem)
-                                aux = GetElement(sizeritem->GetChild(0), element);
-                        }
-                    }
-                    if (!aux)
-                        aux = GetElement(child, element);
-
-                    if (aux) {
-                        element->LinkEndChild(aux);
-                        delete aux;
-                    }
-                }
-                return element;
-            }
-        } else if (className == "wxMenu") {
-            if (parent) {
-                // Do not generate context menus assigned to forms or widgets
-                std::string parent_name = parent->GetAttribute("class");
-                if ((parent_name != "wxMenuBar") && (parent_name != "wxMenu")) {
-                    // insert context menu into vector for delayed processing
-                    // (context menus will be generated as top-level menus)
-                    for (size_t i = 0; i < obj->GetChildCount(); i++) {
-                        ticpp::Element* aux = GetElement(obj->GetChild(i), element);
-                        if (aux) {
-                            element->LinkEndChild(aux);
-                            delete aux;
-                        }
-                    }
-                    m_contextMenus.push_back(element);
-                    return nullptr;
-                }
-            }
-        } else if (className == "wxCollapsiblePane") {
-            ticpp::Element* aux = new ticpp::Element("object");
-            aux->SetAttribute("class", "panewindow");
+        element.reset(comp->ExportToXrc(obj.get()));
 
-            ticpp::Element* child = GetElement(obj->GetChild(0), aux);
-            aux->LinkEndChild(child);
-            element->LinkEndChild(aux);
+    if (element && m_archiveBitmaps)
+        LinkArchiveBitmaps(obj, element.get());
 
-            delete aux;
-            delete child;
-            return element;
+    if (!element) {
+        if (obj->GetTypeName() == "nonvisual")
+            return false;
+
+        // The componenet does not XRC
+        ticpp::Element unknown("object");
+        unknown.SetAttribute("class", "unknown");
+        unknown.SetAttribute("name", obj->GetPropertyAsString("name").ToStdString());
+        writer->Write(unknown);
+        return true;
+    }
+    const std::string className = element->GetAttribute("class");
+    if (className == "__dummyitem__") {
+        if (obj->GetChildCount() > 0)
+            return WriteElement(writer, obj->GetChild(0));
+
+        return false;
+    } else if (className == "spacer" && parent) {
+        // Dirty hack to replace the containing sizeritem with the spacer,
+        // which is its only child, so the sizeritem isn't written yet
+        parent->SetAttribute("class", "spacer");
+        for (ticpp::Node* child = element->FirstChild(false);
+             child; child = child->NextSibling(false)) {
+            parent->LinkEndChild(child->Clone().release());
         }
+        return false;
+    } else if (className == "wxMenu" && parent) {
+        // Do not generate context menus assigned to forms or widgets
+        std::string parent_name = parent->GetAttribute("class");
+        if ((parent_name != "wxMenuBar") && (parent_name != "wxMenu")) {
+            // keep the context menu for delayed writing
+            // (context menus will be generated as top-level menus)
+            Writer menuWriter(PCodeWriter(), 1);
+            ticpp::Element* menu = menuWriter.Open(std::move(element));
+            for (size_t i = 0; i < obj->GetChildCount(); i++)
+                WriteElement(&menuWriter, obj->GetChild(i), menu);
+
+            menuWriter.Close();
+            m_contextMenus.push_back(menuWriter.Finish());
+            return false;
+        }
+    }
+    ticpp::Element* current = writer->Open(std::move(element));
+    if (className == "wxFrame" && obj->GetPropertyAsInteger("xrc_skip_sizer")) {
+        // Dirty hack to prevent sizer generation directly under a wxFrame
+        // If there is a sizer, the size property of the wxFrame is ignored
+        // when loading the xrc file at runtime
         for (size_t i = 0; i < obj->GetChildCount(); i++) {
-            ticpp::Element* aux = GetElement(obj->GetChild(i), element);
-            if (aux) {
-                element->LinkEndChild(aux);
-                delete aux;
+            PObjectBase child = obj->GetChild(i);
+            bool written = false;
+            if (child->GetObjectInfo()->IsSubclassOf("sizer") && child->GetChildCount() == 1) {
+                PObjectBase sizeritem = child->GetChild(0);
+                if (sizeritem->GetChildCount() > 0)
+                    written = WriteElement(writer, sizeritem->GetChild(0), current);
             }
+            if (!written)
+                WriteElement(writer, child, current);
+        }
+    } else if (className == "wxCollapsiblePane") {
+        std::unique_ptr<ticpp::Element> pane(new ticpp::Element("object"));
+        pane->SetAttribute("class", "panewindow");
+        ticpp::Element* paneWindow = writer->Open(std::move(pane));
+        if (obj->GetChildCount() > 0)
+            WriteElement(writer, obj->GetChild(0), paneWindow);
+
+        writer->Close();
+    } else {
+        for (size_t i = 0; i < obj->GetChildCount(); i++)
+            WriteElement(writer, obj->GetChild(i), current);
+    }
+    writer->Close();
+    return true;
+}
+
+void XrcCodeGenerator::LinkArchiveBitmaps(PObjectBase obj, ticpp::Element* element)
+{
+    std::map<std::string, std::string> entries;
+    for (size_t i = 0; i < obj->GetPropertyCount(); i++) {
+        PProperty property = obj->GetProperty(i);
+        if (property->GetType() != PT_BITMAP)
+            continue;
+
+        wxString path;
+        wxString source;
+        wxSize icoSize;
+        TypeConv::ParseBitmapWithResource(property->GetValueAsString(), &path, &source, &icoSize);
+        if (path.empty()
+            || (source != "Load From File" && source != "Load From Embedded File")) {
+            continue;
+        }
+        entries[path.ToStdString(wxConvUTF8)] = GetArchiveEntry(path).ToStdString(wxConvUTF8);
+    }
+    if (!entries.empty())
+        ReplaceTexts(element, entries);
+}
+
+wxString XrcCodeGenerator::GetArchiveEntry(const wxString& path)
+{
+    const wxString projectPath = AppData()->GetProjectPath();
+    wxFileName fileName(TypeConv::MakeAbsolutePath(path, projectPath));
+    const wxString absPath = fileName.GetFullPath();
+
+    wxString entry;
+    if (fileName.MakeRelativeTo(projectPath) && !fileName.GetFullPath().StartsWith(".."))
+        entry = fileName.GetFullPath(wxPATH_UNIX);
+    else
+        entry = "bitmaps/" + fileName.GetFullName();
+
+    // Files with the same name in different directories out of the project
+    wxString unique = entry;
+    for (int i = 2;; i++) {
+        auto it = m_archiveBitmaps->find(unique);
+        if (it == m_archiveBitmaps->end()) {
+            (*m_archiveBitmaps)[unique] = absPath;
+            return unique;
         }
+        if (it->second == absPath)
+            return unique;
+
+        unique = wxString::Format("bitmaps/%d/%s", i, fileName.GetFullName());
+    }
+}
+
+bool XrcCodeGenerator::GenerateArchive(PObjectBase project, std::string* data)
+{
+    std::vector<PObjectBase> forms;
+    if (project->GetClassName() == "Project") {
+        for (size_t i = 0; i < project->GetChildCount(); i++)
+            forms.push_back(project->GetChild(i));
     } else {
-        if (obj->GetTypeName() != "nonvisual") {
-            // The componenet does not XRC
-            element = new ticpp::Element("object");
-            element->SetAttribute("class", "unknown");
-            element->SetAttribute("name", obj->GetPropertyAsString("name").ToStdString());
+        forms.push_back(project);
+    }
+    PCodeWriter codeWriter = m_codeWriter;
+    std::map<wxString, wxString> bitmaps;
+    m_archiveBitmaps = &bitmaps;
+
+    // Fixed time stamps, so that the archive of an unchanged project is the same
+    const wxDateTime entryTime(1, wxDateTime::Jan, 1980);
+    bool success = true;
+    wxMemoryOutputStream archive;
+    {
+        wxZipOutputStream zip(archive, 9);
+        for (PObjectBase form : forms) {
+            PStringCodeWriter xrcWriter(new StringCodeWriter);
+            m_codeWriter = xrcWriter;
+            GenerateCode(form);
+
+            const wxScopedCharBuffer xrc = xrcWriter->GetString().utf8_str();
+            zip.PutNextEntry(new wxZipEntry(form->GetPropertyAsString("name") + ".xrc",
+                                            entryTime));
+            zip.Write(xrc.data(), xrc.length());
+        }
+        for (const auto& bitmap : bitmaps) {
+            DependencyTracker::AddInput(bitmap.second);
+
+            std::vector<char> contents;
+            if (!FileUtils::ReadFile(bitmap.second, &contents)) {
+                wxLogError("Unable to read the bitmap %s", bitmap.second);
+                success = false;
+                continue;
+            }
+            zip.PutNextEntry(new wxZipEntry(bitmap.first, entryTime));
+            zip.Write(contents.data(), contents.size());
         }
+        zip.Close();
     }
-    return element;
+    m_archiveBitmaps = nullptr;
+    m_codeWriter = codeWriter;
+
+    data->resize(archive.GetLength());
+    if (!data->empty())
+        archive.CopyTo(&(*data)[0], data->size());
+
+    return success;
+}
+
+void XrcCodeGenerator::GenerateArchiveSource(const std::string& archive, const wxString& name,
+                                             const wxString& function, PCodeWriter writer)
+{
+    const wxString location = "memory:" + name;
+
+    writer->Clear();
+    writer->WriteLn(wxString::Format(
+        "/*\n"
+        "    C++ code generated with wxWeaver (version %s%s " __DATE__ ")\n"
+        "    https://wxweaver.github.io/\n"
+        "\n"
+        "    PLEASE DO *NOT* EDIT THIS FILE!\n"
+        "*/",
+        VERSION, REVISION));
+    writer->WriteLn();
+    writer->WriteLn("#include <wx/filesys.h>");
+    writer->WriteLn("#include <wx/fs_arc.h>");
+    writer->WriteLn("#include <wx/fs_mem.h>");
+    writer->WriteLn("#include <wx/xrc/xmlres.h>");
+    writer->WriteLn();
+    writer->WriteLn("static const unsigned char xrs_archive[] =");
+    writer->WriteLn("{");
+    writer->WriteFormatted(FileToCArray::EncodeBytes(archive.data(), archive.size()));
+    writer->WriteLn("};");
+    writer->WriteLn();
+    writer->WriteLn("void " + function + "()");
+    writer->WriteLn("{");
+    writer->Indent();
+    writer->WriteLn("if (!wxFileSystem::HasHandlerForPath(\"" + location + "\"))");
+    writer->Indent();
+    writer->WriteLn("wxFileSystem::AddHandler(new wxMemoryFSHandler);");
+    writer->Unindent();
+    writer->WriteLn("if (!wxFileSystem::HasHandlerForPath(\"" + location + "#zip:\"))");
+    writer->Indent();
+    writer->WriteLn("wxFileSystem::AddHandler(new wxArchiveFSHandler);");
+    writer->Unindent();
+    writer->WriteLn();
+    writer->WriteLn("wxMemoryFSHandler::AddFile(\"" + name
+                    + "\", xrs_archive, sizeof(xrs_archive));");
+    writer->WriteLn("wxXmlResource::Get()->Load(\"" + location + "\");");
+    writer->Unindent();
+    writer->WriteLn("}");
 }
@@ -22,6 +22,9 @@
 
 #include "codegen/codegen.h"
 
+#include <map>
+#include <string>
+
 namespace ticpp {
 class Element;
 }
@@ -37,8 +40,54 @@ public:
     */
     bool GenerateCode(PObjectBase project) override;
 
+    /** Writes the resources of @a project in the format selected by its
+        xrc_output property, to @a basePath followed by the extension.
+
+        @throw wxWeaverException If a file can't be written.
+    */
+    bool GenerateFiles(PObjectBase project, const wxString& basePath);
+
+    /** Generates a compressed XRC archive (*.xrs), like the one of wxrc,
+        with a XRC document per form and the bitmap files they load.
+
+        The bitmaps are stored under their path relative to the project,
+        or in "bitmaps/" if they are outside of its directory.
+
+        @param data Receives the contents of the archive.
+        @return false if a bitmap file could not be read.
+    */
+    bool GenerateArchive(PObjectBase project, std::string* data);
+
+    /** Writes a C++ source embedding @a archive, with a function loading
+        it through wxMemoryFSHandler as "memory:<name>".
+    */
+    static void GenerateArchiveSource(const std::string& archive, const wxString& name,
+                                      const wxString& function, PCodeWriter writer);
+
 private:
+    class Writer;
+
+    /** Writes the element of @a obj, followed by those of its children,
+        while only the elements of its ancestors are kept in memory.
+
+        @param parent The element of the parent object, if any.
+        @return false if nothing was written in place of the object.
+    */
+    bool WriteElement(Writer* writer, PObjectBase obj, ticpp::Element* parent = nullptr);
+
+    /** Replaces the paths of the bitmap files loaded by @a obj in its
+        @a element with the names of their archive entries.
+    */
+    void LinkArchiveBitmaps(PObjectBase obj, ticpp::Element* element);
+
+    /** Gets the name of the archive entry of the bitmap @a path,
+        relative to the project, adding it to the archive bitmaps.
+    */
+    wxString GetArchiveEntry(const wxString& path);
+
     PCodeWriter m_codeWriter;
-    std::vector<ticpp::Element*> m_contextMenus;
-    ticpp::Element* GetElement(PObjectBase obj, ticpp::Element* parent = nullptr);
+    std::vector<std::string> m_contextMenus;
+
+    // Absolute path of the bitmaps by archive entry, while generating an archive
+    std::map<wxString, wxString>* m_archiveBitmaps = nullptr;
 };
@@ -0,0 +1,233 @@
+/*
+    wxWeaver - A GUI Designer Editor for wxWidgets.
+    Copyright (C) 2021 Andrea Zanellato <redtid3@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include "converter.h"
+
+#include "appdata.h"
+#include "utils/exception.h"
+#include "utils/fileutils.h"
+#include "utils/stringutils.h"
+
+#include <ticpp.h>
+
+#include <wx/dir.h>
+#include <wx/filename.h>
+#include <wx/log.h>
+#include <wx/textfile.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace {
+enum class ConversionStatus {
+    Converted,
+    UpToDate,
+    Failed
+};
+
+struct ConversionResult {
+    ConversionStatus status = ConversionStatus::Failed;
+    int fileMajor = 0;
+    int fileMinor = 0;
+    unsigned long long bytes = 0;
+    double milliseconds = 0;
+    wxString error;
+};
+
+/** Converts a single project file, called from the worker threads.
+*/
+void ConvertFile(const wxString& path, ConversionResult* result)
+{
+    const auto start = std::chrono::steady_clock::now();
+    try {
+        const wxULongLong size = wxFileName::GetSize(path);
+        if (size == wxInvalidSize) {
+            wxWEAVER_THROW_EX("Unable to read the file")
+        }
+        result->bytes = size.GetValue();
+
+        ticpp::Document doc;
+        doc.LoadFile(std::string(path.mb_str(wxConvFile)));
+
+        ticpp::Declaration* declaration;
+        try {
+            ticpp::Node* firstChild = doc.FirstChild();
+            declaration = firstChild->ToDeclaration();
+        } catch (ticpp::Exception&) {
+            declaration = nullptr;
+        }
+        // Without a declaration, or its encoding, XML files are UTF-8.
+        // Other encoding conversions need user input, leave them to the GUI
+        const wxString encoding = declaration ? declaration->Encoding() : std::string();
+        if (!encoding.empty() && !encoding.IsSameAs("UTF-8", false)) {
+            wxWEAVER_THROW_EX("Not UTF-8 encoded, open it in wxWeaver to convert it")
+        }
+        ticpp::Element* root = doc.FirstChildElement();
+        if (root->Value() != std::string("object")) {
+            ticpp::Element* fileVersion = root->FirstChildElement("FileVersion");
+            fileVersion->GetAttributeOrDefault("major", &result->fileMajor, 0);
+            fileVersion->GetAttributeOrDefault("minor", &result->fileMinor, 0);
+        }
+        const int major = AppData()->m_fbpVerMajor;
+        const int minor = AppData()->m_fbpVerMinor;
+        if (result->fileMajor > major
+            || (result->fileMajor == major && result->fileMinor > minor)) {
+            wxWEAVER_THROW_EX("The file is newer than this version of wxWeaver")
+        }
+        if (result->fileMajor == major && result->fileMinor == minor) {
+            result->status = ConversionStatus::UpToDate;
+        } else {
+            if (!AppData()->ConvertProject(doc, path, result->fileMajor,
+                                           result->fileMinor, false)) {
+                wxWEAVER_THROW_EX("Unable to convert the project")
+            }
+            if (!FileUtils::WriteFileAtomically(XMLUtils::PrintDocument(doc), path)) {
+                wxWEAVER_THROW_EX("Unable to replace the file")
+            }
+            result->status = ConversionStatus::Converted;
+        }
+    } catch (ticpp::Exception& ex) {
+        result->error = ex.m_details;
+    } catch (wxWeaverException& ex) {
+        result->error = ex.what();
+    }
+    const std::chrono::duration<double, std::milli> elapsed
+        = std::chrono::steady_clock::now() - start;
+    result->milliseconds = elapsed.count();
+}
+} // namespace
+
+wxArrayString ProjectConverter::ExpandFileList(const wxArrayString& args,
+                                               const wxString& baseDir)
+{
+    wxArrayString files;
+    for (const wxString& arg : args) {
+        if (arg.StartsWith("@")) {
+            wxFileName listFile(arg.Mid(1));
+            listFile.MakeAbsolute(baseDir);
+
+            wxTextFile list;
+            if (!list.Open(listFile.GetFullPath())) {
+                wxLogError("Unable to open the file list %s", listFile.GetFullPath());
+                continue;
+            }
+            wxArrayString entries;
+            for (size_t i = 0; i < list.GetLineCount(); ++i) {
+                wxString entry = list[i];
+                entry.Trim().Trim(false);
+                if (!entry.empty() && !entry.StartsWith("#"))
+                    entries.Add(entry);
+            }
+            WX_APPEND_ARRAY(files, ExpandFileList(entries, listFile.GetPath()));
+            continue;
+        }
+        wxFileName fileName(arg);
+        fileName.MakeAbsolute(baseDir);
+
+        if (wxIsWild(fileName.GetFullName())) {
+            wxArrayString matches;
+            wxDir::GetAllFiles(fileName.GetPath(), &matches,
+                               fileName.GetFullName(), wxDIR_FILES);
+            matches.Sort();
+            WX_APPEND_ARRAY(files, matches);
+        } else {
+            files.Add(fileName.GetFullPath());
+        }
+    }
+    return files;
+}
+
+size_t ProjectConverter::Run(const wxArrayString& files, unsigned jobs)
+{
+    // Global TinyXML setting, set it once before the workers start
+    TiXmlBase::SetCondenseWhiteSpace(false);
+
+    // Each worker only ever touches its own path and result
+    std::vector<wxString> paths;
+    paths.reserve(files.size());
+    for (const wxString& file : files)
+        paths.push_back(file.Clone());
+
+    std::vector<ConversionResult> results(paths.size());
+    std::atomic<size_t> next(0);
+    auto worker = [&paths, &results, &next]() {
+        for (size_t i = next++; i < paths.size(); i = next++)
+            ConvertFile(paths[i], &results[i]);
+    };
+    jobs = std::max(1u, std::min<unsigned>(jobs, static_cast<unsigned>(paths.size())));
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < jobs; ++i)
+        threads.emplace_back(worker);
+
+    worker();
+    for (std::thread& thread : threads)
+        thread.join();
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    // Messages logged by the workers
+    wxLog::FlushActive();
+
+    size_t converted = 0, upToDate = 0, failed = 0;
+    unsigned long long totalBytes = 0;
+    const wxString currentVersion = wxString::Format(
+        "%d.%d", AppData()->m_fbpVerMajor, AppData()->m_fbpVerMinor);
+
+    for (size_t i = 0; i < paths.size(); ++i) {
+        const ConversionResult& result = results[i];
+        const wxString fileVersion
+            = wxString::Format("%d.%d", result.fileMajor, result.fileMinor);
+        wxString line;
+        switch (result.status) {
+        case ConversionStatus::Converted:
+            converted++;
+            line = wxString::Format("converted   %5s -> %-5s", fileVersion, currentVersion);
+            break;
+        case ConversionStatus::UpToDate:
+            upToDate++;
+            line = wxString::Format("up to date           %-5s", currentVersion);
+            break;
+        case ConversionStatus::Failed:
+            failed++;
+            line = wxString::Format("FAILED      %5s         ", fileVersion);
+            break;
+        }
+        totalBytes += result.bytes;
+        line += wxString::Format(" %9.1f ms  %s", result.milliseconds, paths[i]);
+        if (result.status == ConversionStatus::Failed)
+            line += ": " + result.error;
+
+        std::cout << line.utf8_str() << '\n';
+    }
+    const double seconds = std::max(elapsed.count(), 1e-9);
+    std::cout << wxString::Format(
+                     "%zu files: %zu converted, %zu up to date, %zu failed "
+                     "in %.2f s using %u jobs (%.1f files/s, %.2f MB/s)",
+                     paths.size(), converted, upToDate, failed, elapsed.count(), jobs,
+                     paths.size() / seconds, totalBytes / seconds / (1024.0 * 1024.0))
+                     .utf8_str()
+              << std::endl;
+
+    return failed;
+}
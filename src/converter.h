@@ -0,0 +1,44 @@
+/*
+    wxWeaver - A GUI Designer Editor for wxWidgets.
+    Copyright (C) 2021 Andrea Zanellato <redtid3@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#pragma once
+
+#include <wx/arrstr.h>
+
+/** Headless conversion of project files to the current file format.
+*/
+class ProjectConverter {
+public:
+    /** Expands the command line arguments into a list of project files.
+
+        Arguments starting with '@' are files listing one project per line,
+        arguments containing wildcards are matched against the files of
+        their directory. Relative paths are resolved against @a baseDir.
+    */
+    static wxArrayString ExpandFileList(const wxArrayString& args,
+                                        const wxString& baseDir);
+
+    /** Converts @a files using @a jobs worker threads.
+
+        Each converted file is replaced atomically, a line per file and the
+        total throughput are printed to the standard output.
+
+        @return The number of files that could not be converted.
+    */
+    static size_t Run(const wxArrayString& files, unsigned jobs);
+};
@@ -0,0 +1,456 @@
+/*
+    wxWeaver - A GUI Designer Editor for wxWidgets.
+    Copyright (C) 2021 Andrea Zanellato <redtid3@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include "generator.h"
+
+#include "codegen/codewriter.h"
+#include "codegen/cppcg.h"
+#include "codegen/dependencies.h"
+#include "codegen/luacg.h"
+#include "codegen/phpcg.h"
+#include "codegen/pythoncg.h"
+#include "codegen/xrccg.h"
+#include "rtti/objectbase.h"
+#include "utils/exception.h"
+#include "utils/typeconv.h"
+#include "appdata.h"
+
+#include <wx/log.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace {
+/** Project settings shared by the language generators.
+*/
+struct GeneratorOptions {
+    wxString path;
+    wxString file;
+    bool hasFirstID = false;
+    size_t firstID = 1000;
+    bool useRelativePath = false;
+    bool useMicrosoftBOM = false;
+    bool useUtf8 = false;
+    bool useSpaces = false;
+    wxString imagePathWrapperFunctionName;
+    DependencyTracker* dependencies = nullptr;
+};
+
+typedef bool (*GeneratorFunction)(PObjectBase, const GeneratorOptions&);
+
+GeneratorOptions GetOptions(PObjectBase project, const wxString& path)
+{
+    GeneratorOptions options;
+    options.path = path;
+    options.file = project->GetPropertyAsString("file");
+    if (options.file.empty())
+        options.file = "noname";
+
+    PProperty firstID = project->GetProperty("first_id");
+    if (firstID) {
+        options.hasFirstID = true;
+        options.firstID = firstID->GetValueAsInteger();
+    }
+    PProperty relativePath = project->GetProperty("relative_path");
+    if (relativePath)
+        options.useRelativePath = relativePath->GetValueAsInteger();
+
+    PProperty useMicrosoftBOM = project->GetProperty("use_microsoft_bom");
+    if (useMicrosoftBOM)
+        options.useMicrosoftBOM = useMicrosoftBOM->GetValueAsInteger();
+
+    PProperty encoding = project->GetProperty("encoding");
+    if (encoding)
+        options.useUtf8 = (encoding->GetValueAsString() != "ANSI");
+
+    PProperty useSpaces = project->GetProperty("indent_with_spaces");
+    if (useSpaces)
+        options.useSpaces = useSpaces->GetValueAsInteger();
+
+    options.imagePathWrapperFunctionName
+        = project->GetPropertyAsString("image_path_wrapper_function_name");
+
+    return options;
+}
+
+PCodeWriter CreateWriter(const GeneratorOptions& options, const wxString& extension)
+{
+    return PCodeWriter(new FileCodeWriter(options.path + options.file + extension,
+                                          options.useMicrosoftBOM, options.useUtf8));
+}
+
+bool GenerateCpp(PObjectBase project, const GeneratorOptions& options)
+{
+    CppCodeGenerator codegen;
+    codegen.UseRelativePath(options.useRelativePath, options.path);
+    if (options.hasFirstID)
+        codegen.SetFirstID(options.firstID);
+
+    codegen.SetHeaderWriter(CreateWriter(options, ".h"));
+    codegen.SetSourceWriter(CreateWriter(options, ".cpp"));
+    codegen.SetWriterFactory([&options](const wxString& fileName) {
+        return PCodeWriter(new FileCodeWriter(options.path + fileName,
+                                              options.useMicrosoftBOM, options.useUtf8));
+    });
+    return codegen.GenerateCode(project);
+}
+
+bool GeneratePython(PObjectBase project, const GeneratorOptions& options)
+{
+    PythonCodeGenerator codegen;
+    codegen.UseRelativePath(options.useRelativePath, options.path);
+    codegen.SetImagePathWrapperFunctionName(options.imagePathWrapperFunctionName);
+    if (options.hasFirstID)
+        codegen.SetFirstID(options.firstID);
+
+    PCodeWriter writer = CreateWriter(options, ".py");
+    writer->SetIndentWithSpaces(options.useSpaces);
+    codegen.SetSourceWriter(writer);
+    return codegen.GenerateCode(project);
+}
+
+bool GeneratePHP(PObjectBase project, const GeneratorOptions& options)
+{
+    PHPCodeGenerator codegen;
+    codegen.UseRelativePath(options.useRelativePath, options.path);
+    if (options.hasFirstID)
+        codegen.SetFirstID(options.firstID);
+
+    codegen.SetSourceWriter(CreateWriter(options, ".php"));
+    return codegen.GenerateCode(project);
+}
+
+bool GenerateLua(PObjectBase project, const GeneratorOptions& options)
+{
+    LuaCodeGenerator codegen;
+    codegen.UseRelativePath(options.useRelativePath, options.path);
+    if (options.hasFirstID)
+        codegen.SetFirstID(options.firstID);
+
+    codegen.SetSourceWriter(CreateWriter(options, ".lua"));
+    return codegen.GenerateCode(project);
+}
+
+bool GenerateXrc(PObjectBase project, const GeneratorOptions& options)
+{
+    XrcCodeGenerator codegen;
+    return codegen.GenerateFiles(project, options.path + options.file);
+}
+
+/** Gets the generators enabled by the code_generation property of @a project,
+    adding a result for each of them.
+*/
+std::vector<GeneratorFunction> GetGenerators(PObjectBase project,
+                                             std::vector<ProjectGenerator::Result>* results)
+{
+    static const std::pair<const char*, GeneratorFunction> generators[] = {
+        { "C++", GenerateCpp },
+        { "Python", GeneratePython },
+        { "PHP", GeneratePHP },
+        { "Lua", GenerateLua },
+        { "XRC", GenerateXrc },
+    };
+    results->clear();
+
+    const wxString codeGeneration = project->GetPropertyAsString("code_generation");
+    std::vector<GeneratorFunction> functions;
+    for (const auto& generator : generators) {
+        if (TypeConv::FlagSet(generator.first, codeGeneration)) {
+            ProjectGenerator::Result result;
+            result.language = generator.first;
+            results->push_back(result);
+            functions.push_back(generator.second);
+        }
+    }
+    return functions;
+}
+
+/** Runs a generator, the writers flush the files when it returns.
+*/
+void RunGenerator(GeneratorFunction generate, PObjectBase project,
+                  const GeneratorOptions& options, ProjectGenerator::Result* result)
+{
+    DependencyTracker::Scope scope(options.dependencies);
+    const auto start = std::chrono::steady_clock::now();
+    try {
+        result->success = generate(project, options);
+    } catch (wxWeaverException& ex) {
+        wxLogError(ex.what());
+        result->success = false;
+    }
+    const std::chrono::duration<double, std::milli> elapsed
+        = std::chrono::steady_clock::now() - start;
+    result->milliseconds = elapsed.count();
+}
+
+bool AllSucceeded(const std::vector<ProjectGenerator::Result>& results)
+{
+    return std::all_of(results.begin(), results.end(),
+                       [](const ProjectGenerator::Result& result) { return result.success; });
+}
+
+/** Writes the files requested by the ProjectGenerator::DependencyFiles
+    @a flags next to the generated code.
+*/
+bool WriteDependencyFiles(const DependencyTracker& tracker, const GeneratorOptions& options,
+                          const wxString& projectFile, unsigned flags)
+{
+    const wxString base = options.path + options.file;
+    bool success = true;
+    if ((flags & ProjectGenerator::Depfile) && !tracker.WriteDepfile(base + ".d")) {
+        wxLogError("Unable to write the dependency file %s.d", base);
+        success = false;
+    }
+    if ((flags & ProjectGenerator::JsonManifest)
+        && !tracker.WriteManifest(base + ".deps.json", projectFile)) {
+        wxLogError("Unable to write the dependency manifest %s.deps.json", base);
+        success = false;
+    }
+    return success;
+}
+} // namespace
+
+bool ProjectGenerator::Generate(PObjectBase project, std::vector<Result>* results,
+                                unsigned dependencyFiles)
+{
+    const std::vector<GeneratorFunction> functions = GetGenerators(project, results);
+    if (results->empty())
+        return true;
+
+    GeneratorOptions options;
+    try {
+        options = GetOptions(project, AppData()->GetOutputPath(project));
+    } catch (wxWeaverException& ex) {
+        wxLogError(ex.what());
+        return false;
+    }
+    const wxString projectFile = AppData()->GetProjectFileName();
+
+    // The manifests of the output directories are written once at the end
+    FileCodeWriter::Batch batch;
+    DependencyTracker dependencies;
+    if (dependencyFiles != NoDependencyFiles) {
+        options.dependencies = &dependencies;
+        DependencyTracker::Scope scope(&dependencies);
+        DependencyTracker::AddInput(projectFile);
+    }
+    // XRC export goes through the component plugins, which may create
+    // GUI objects, so it stays on the calling thread
+    std::vector<std::thread> threads;
+    size_t local = functions.size();
+    for (size_t i = 0; i < functions.size(); ++i) {
+        if (functions[i] == GenerateXrc) {
+            local = i;
+            continue;
+        }
+        threads.emplace_back(RunGenerator, functions[i], project,
+                             std::cref(options), &(*results)[i]);
+    }
+    if (local < functions.size())
+        RunGenerator(functions[local], project, options, &(*results)[local]);
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    // Keep the previous files after a failure rather than writing
+    // incomplete lists, the build runs the generation again anyway
+    if (options.dependencies && AllSucceeded(*results))
+        WriteDependencyFiles(dependencies, options, projectFile, dependencyFiles);
+
+    // Messages logged by the generators
+    wxLog::FlushActive();
+    return true;
+}
+
+size_t ProjectGenerator::Run(PObjectBase project, unsigned dependencyFiles)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<Result> results;
+    if (!Generate(project, &results, dependencyFiles))
+        return std::max<size_t>(1, results.size());
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    size_t failed = 0;
+    for (const Result& result : results) {
+        if (!result.success)
+            failed++;
+
+        std::cout << wxString::Format("%-8s %-9s %9.1f ms", result.language,
+                                      result.success ? "generated" : "FAILED",
+                                      result.milliseconds)
+                         .utf8_str()
+                  << '\n';
+    }
+    std::cout << wxString::Format("%zu generators run in %.2f s, %zu failed",
+                                  results.size(), elapsed.count(), failed)
+                     .utf8_str()
+              << std::endl;
+
+    return failed;
+}
+
+size_t ProjectGenerator::RunBatch(const wxArrayString& files, const wxString& languages,
+                                  unsigned jobs, unsigned dependencyFiles)
+{
+    struct BatchProject {
+        wxString file;
+        PObjectBase project;
+        GeneratorOptions options;
+        std::vector<Result> results;
+        std::unique_ptr<DependencyTracker> dependencies;
+    };
+    /** A single language generator of a project.
+    */
+    struct Job {
+        size_t project;
+        size_t result;
+        GeneratorFunction function;
+    };
+    const auto start = std::chrono::steady_clock::now();
+
+    // The manifests of the output directories are written once at the end
+    FileCodeWriter::Batch batch;
+
+    // Loading goes through AppData and the shared object database,
+    // keep it on this thread and let the workers only generate
+    std::vector<BatchProject> projects(files.size());
+    std::vector<Job> poolJobs, localJobs;
+    for (size_t i = 0; i < files.size(); ++i) {
+        BatchProject& batchProject = projects[i];
+        batchProject.file = files[i].Clone();
+        if (!AppData()->LoadProject(batchProject.file, true))
+            continue;
+
+        PObjectBase project = AppData()->GetProjectData();
+        if (!languages.empty()) {
+            PProperty codeGen = project->GetProperty("code_generation");
+            if (codeGen)
+                codeGen->SetValue(languages);
+        }
+        const std::vector<GeneratorFunction> functions
+            = GetGenerators(project, &batchProject.results);
+        if (functions.empty()) {
+            batchProject.project = project;
+            continue;
+        }
+        try {
+            batchProject.options = GetOptions(project, AppData()->GetOutputPath(project));
+        } catch (wxWeaverException& ex) {
+            wxLogError("%s: %s", batchProject.file, ex.what());
+            continue;
+        }
+        batchProject.project = project;
+
+        if (dependencyFiles != NoDependencyFiles) {
+            batchProject.dependencies.reset(new DependencyTracker);
+            batchProject.options.dependencies = batchProject.dependencies.get();
+            DependencyTracker::Scope scope(batchProject.dependencies.get());
+            DependencyTracker::AddInput(batchProject.file);
+        }
+        // XRC export goes through the component plugins, keep it on this thread
+        for (size_t j = 0; j < functions.size(); ++j) {
+            const Job job = { i, j, functions[j] };
+            if (functions[j] == GenerateXrc)
+                localJobs.push_back(job);
+            else
+                poolJobs.push_back(job);
+        }
+    }
+    const std::chrono::duration<double> loadElapsed = std::chrono::steady_clock::now() - start;
+
+    // Each job only writes its own result, the generators resolve the
+    // project paths through the project of their thread
+    auto runJob = [&projects](const Job& job) {
+        BatchProject& batchProject = projects[job.project];
+        ApplicationData::SetThreadProject(batchProject.project, batchProject.file);
+        RunGenerator(job.function, batchProject.project, batchProject.options,
+                     &batchProject.results[job.result]);
+        ApplicationData::SetThreadProject(PObjectBase(), wxEmptyString);
+    };
+    std::atomic<size_t> next(0);
+    auto worker = [&poolJobs, &next, &runJob]() {
+        for (size_t i = next++; i < poolJobs.size(); i = next++)
+            runJob(poolJobs[i]);
+    };
+    jobs = std::max(1u, std::min<unsigned>(jobs, static_cast<unsigned>(poolJobs.size())));
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < jobs; ++i)
+        threads.emplace_back(worker);
+
+    for (const Job& job : localJobs)
+        runJob(job);
+
+    worker();
+    for (std::thread& thread : threads)
+        thread.join();
+
+    for (const BatchProject& batchProject : projects) {
+        if (batchProject.dependencies && AllSucceeded(batchProject.results)) {
+            WriteDependencyFiles(*batchProject.dependencies, batchProject.options,
+                                 batchProject.file, dependencyFiles);
+        }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    // Messages logged by the generators
+    wxLog::FlushActive();
+
+    size_t failed = 0;
+    for (const BatchProject& batchProject : projects) {
+        double milliseconds = 0;
+        wxString failedLanguages;
+        for (const Result& result : batchProject.results) {
+            milliseconds += result.milliseconds;
+            if (!result.success)
+                failedLanguages << (failedLanguages.empty() ? "" : ",") << result.language;
+        }
+        const bool success = batchProject.project && failedLanguages.empty();
+        if (!success)
+            failed++;
+
+        wxString line = wxString::Format("%-9s %zu languages %9.1f ms  %s",
+                                         success ? "generated" : "FAILED",
+                                         batchProject.results.size(), milliseconds,
+                                         batchProject.file);
+        if (!batchProject.project)
+            line << ": not generated";
+        else if (!failedLanguages.empty())
+            line << ": " << failedLanguages << " failed";
+
+        std::cout << line.utf8_str() << '\n';
+    }
+    const double seconds = std::max(elapsed.count(), 1e-9);
+    std::cout << wxString::Format(
+                     "%zu projects: %zu generated, %zu failed in %.2f s "
+                     "(%.2f s loading) using %u jobs (%.1f projects/s)",
+                     projects.size(), projects.size() - failed, failed, elapsed.count(),
+                     loadElapsed.count(), jobs, projects.size() / seconds)
+                     .utf8_str()
+              << std::endl;
+
+    return failed;
+}
@@ -0,0 +1,88 @@
+/*
+    wxWeaver - A GUI Designer Editor for wxWidgets.
+    Copyright (C) 2021 Andrea Zanellato <redtid3@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#pragma once
+
+#include "utils/defs.h"
+
+#include <wx/arrstr.h>
+#include <wx/string.h>
+
+#include <vector>
+
+/** Headless generation of the code files of a project.
+*/
+class ProjectGenerator {
+public:
+    /** Outcome of a single language generator.
+    */
+    struct Result {
+        wxString language;
+        bool success = false;
+        double milliseconds = 0;
+    };
+
+    /** Build system files written next to the generated code, listing the
+        files written by the generation and the files it depends on.
+    */
+    enum DependencyFiles {
+        NoDependencyFiles = 0,
+        Depfile = 1,     // <file>.d, a Makefile rule
+        JsonManifest = 2 // <file>.deps.json
+    };
+
+    /** Generates the files of the languages enabled by the code_generation
+        property of @a project, running the generators concurrently.
+
+        The project is only read, each generator has its own writers.
+
+        @param project The project object.
+        @param results Receives the outcome of each enabled language,
+                       in a fixed language order.
+        @param dependencyFiles DependencyFiles flags, the files are only
+                               written if all the generators succeeded.
+        @return false if the output path can't be determined.
+    */
+    static bool Generate(PObjectBase project, std::vector<Result>* results,
+                         unsigned dependencyFiles = NoDependencyFiles);
+
+    /** Generates the files of @a project and prints the time spent by each
+        language generator to the standard output.
+
+        @return The number of generators that failed.
+    */
+    static size_t Run(PObjectBase project, unsigned dependencyFiles = NoDependencyFiles);
+
+    /** Generates the files of several projects in a single process.
+
+        The projects are loaded one after the other on the calling thread,
+        which resets the object counters of the shared ObjectDatabase for
+        each of them, then the generators of all the projects run on
+        @a jobs worker threads. A line per project and the aggregate timing
+        are printed to the standard output.
+
+        @param files The absolute paths of the project files.
+        @param languages Overrides the code_generation property of every
+                         project, if not empty.
+        @param jobs Number of worker threads.
+        @param dependencyFiles DependencyFiles flags.
+        @return The number of projects that failed to load or to generate.
+    */
+    static size_t RunBatch(const wxArrayString& files, const wxString& languages,
+                           unsigned jobs, unsigned dependencyFiles = NoDependencyFiles);
+};
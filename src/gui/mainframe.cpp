@@ -129,6 +129,7 @@ MainFrame::MainFrame(wxWindow* parent, int id, int style, wxPoint pos, wxSize si
     , m_rightSplitterSashPos(300)
     , m_leftSplitterWidth(300)
     , m_rightSplitterWidth(-300)
+    , m_autosaveInterval(60)
     , m_style(style)
 {
     // Setup frame icons, title bar, status bar, menubar and toolbar
@@ -286,10 +287,17 @@ MainFrame::MainFrame(wxWindow* parent, int id, int style, wxPoint pos, wxSize si
     Bind(wxEVT_WVR_PROJECT_SAVED, &MainFrame::OnProjectSaved, this);
     Bind(wxEVT_WVR_PROPERTY_MODIFIED, &MainFrame::OnPropertyModified, this);
     Bind(wxEVT_WVR_EVENT_HANDLER_MODIFIED, &MainFrame::OnEventHandlerModified, this);
+
+    m_autosaveTimer.SetOwner(this);
+    Bind(wxEVT_TIMER, &MainFrame::OnAutosaveTimer, this, m_autosaveTimer.GetId());
+    if (m_autosaveInterval > 0)
+        m_autosaveTimer.Start(m_autosaveInterval * 1000);
 }
 
 MainFrame::~MainFrame()
 {
+    m_autosaveTimer.Stop();
+
     m_notebook->Unbind(
         wxEVT_COMMAND_AUINOTEBOOK_PAGE_CHANGED,
         &MainFrame::OnAuiNotebookPageChanged, this);
@@ -333,6 +341,7 @@ void MainFrame::LoadSettings()
     config->Read("/MainWindow/RecentFile2", &m_recentProjects[2]);
     config->Read("/MainWindow/RecentFile3", &m_recentProjects[3]);
     config->Read("/MainWindow/Style", &m_style, wxWEAVER_GUI_DOCKABLE);
+    config->Read("/MainWindow/AutosaveInterval", &m_autosaveInterval, 60);
     config->Read("/MainWindow/Perspective", &perspective);
     config->Read("/MainWindow/IsMaximized", &maximized, false);
     config->Read("/MainWindow/IsIconized", &iconized, false);
@@ -384,6 +393,7 @@ void MainFrame::SaveSettings()
     config->Write("/MainWindow/RecentFile2", m_recentProjects[2]);
     config->Write("/MainWindow/RecentFile3", m_recentProjects[3]);
     config->Write("/MainWindow/Style", m_style);
+    config->Write("/MainWindow/AutosaveInterval", m_autosaveInterval);
 
     if (m_leftSplitter) {
         int leftSashWidth = m_leftSplitter->GetSashPosition();
@@ -448,6 +458,8 @@ void MainFrame::OnSaveAsProject(wxCommandEvent&)
             this, _("Save Project"), m_currentDir, "",
             _(" wxWeaver Project File")
                 + " (*.fbp)|*.fbp|"
+                + _("wxWeaver Binary Project File")
+                + " (*.fbpb)|*.fbpb|"
                 + _("All files")
                 + " (*.*)|*.*",
             wxFD_SAVE);
@@ -459,7 +471,7 @@ void MainFrame::OnSaveAsProject(wxCommandEvent&)
         // Add the default extension if none was chosen
         wxFileName file(filename);
         if (!file.HasExt()) {
-            file.SetExt("fbp");
+            file.SetExt(dialog->GetFilterIndex() == 1 ? "fbpb" : "fbp");
             filename = file.GetFullPath();
         }
         // Check the file whether exists or not
@@ -494,7 +506,7 @@ void MainFrame::OnOpenProject(wxCommandEvent&)
         = new wxFileDialog(
             this, _("Open Project"), m_currentDir, "",
             _(" wxWeaver Project File")
-                + " (*.fbp)|*.fbp|"
+                + " (*.fbp;*.fbpb)|*.fbp;*.fbpb|"
                 + _("All files")
                 + " (*.*)|*.*",
             wxFD_OPEN);
@@ -594,6 +606,10 @@ void MainFrame::OnClose(wxCloseEvent& event)
     if (!SaveWarning())
         return;
 
+    // Regular exit, whatever has not been saved has been discarded on purpose
+    m_autosaveTimer.Stop();
+    AppData()->DiscardRecoveryFile();
+
     SaveSettings();
 
     if (m_prefsEditor)
@@ -622,6 +638,11 @@ void MainFrame::OnProjectLoaded(wxWeaverEvent&)
     UpdateFrame();
 }
 
+void MainFrame::OnAutosaveTimer(wxTimerEvent&)
+{
+    AppData()->AutosaveProject();
+}
+
 void MainFrame::OnProjectSaved(wxWeaverEvent&)
 {
     GetStatusBar()->SetStatusText(_("Project Saved!"));
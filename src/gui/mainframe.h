@@ -27,6 +27,7 @@
 #include <wx/preferences.h>
 #include <wx/scopedptr.h>
 #include <wx/splitter.h>
+#include <wx/timer.h>
 
 class wxWeaverEvent;
 class wxWeaverObjectEvent;
@@ -139,6 +140,7 @@ private:
 
     void OnOpenRecent(wxCommandEvent& event);
     void OnIdle(wxIdleEvent&); // Used to correctly restore splitter position
+    void OnAutosaveTimer(wxTimerEvent&);
 
     ObjectTree* m_objTree;
     ObjectInspector* m_objInsp;
@@ -163,11 +165,13 @@ private:
     wxString m_recentProjects[4];
 
     wxScopedPtr<wxPreferencesEditor> m_prefsEditor;
+    wxTimer m_autosaveTimer;
 
     bool m_autoSash;            // Automatically update sash in splitter window base on user action
     int m_pageSelection;        // Save which page is selected
     int m_rightSplitterSashPos; // Save right splitter's sash position
     int m_leftSplitterWidth;
     int m_rightSplitterWidth;
+    int m_autosaveInterval; // Seconds between autosaves, 0 disables autosave
     int m_style;
 };
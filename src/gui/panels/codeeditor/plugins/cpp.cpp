@@ -36,14 +36,37 @@
 #include <wx/stc/stc.h>
 #include <wx/aui/auibook.h>
 
+namespace {
+/** Replaces the text of a read only editor keeping its scroll position.
+*/
+void SetEditorText(wxStyledTextCtrl* editor, const wxString& text)
+{
+    int line = editor->GetFirstVisibleLine() + editor->LinesOnScreen() - 1;
+    int xOffset = editor->GetXOffset();
+
+    editor->SetReadOnly(false);
+    editor->SetText(text);
+    editor->SetReadOnly(true);
+
+    editor->GotoLine(line);
+    editor->SetXOffset(xOffset);
+    editor->SetAnchor(0);
+    editor->SetCurrentPos(0);
+}
+} // namespace
+
 CppPanel::CppPanel(wxWindow* parent, int id)
     : wxPanel(parent, id)
     , m_notebook(new wxAuiNotebook(this, wxID_ANY, wxDefaultPosition,
                                    wxDefaultSize, wxAUI_NB_TOP))
     , m_editorCpp(new CodeEditor(m_notebook, wxID_ANY))
     , m_editorH(new CodeEditor(m_notebook, wxID_ANY))
-    , m_codeWriterH(PTCCodeWriter(new TCCodeWriter(m_editorH->GetTextCtrl())))
-    , m_codeWriterCpp(PTCCodeWriter(new TCCodeWriter(m_editorCpp->GetTextCtrl())))
+    , m_formCache(std::make_shared<FormCodeCache>())
+    , m_previewTimer(this)
+    , m_previewGeneration(0)
+    , m_previewRunning(false)
+    , m_previewPending(false)
+    , m_previewProject(false)
 {
     AppData()->AddHandler(this->GetEventHandler());
     wxBoxSizer* topSizer = new wxBoxSizer(wxVERTICAL);
@@ -76,11 +99,18 @@ CppPanel::CppPanel(wxWindow* parent, int id)
     Bind(wxEVT_WVR_OBJECT_REMOVED, &CppPanel::OnObjectChange, this);
     Bind(wxEVT_WVR_OBJECT_SELECTED, &CppPanel::OnObjectChange, this);
     Bind(wxEVT_WVR_EVENT_HANDLER_MODIFIED, &CppPanel::OnEventHandlerModified, this);
+
+    Bind(wxEVT_TIMER, &CppPanel::OnPreviewTimer, this, m_previewTimer.GetId());
 }
 
 CppPanel::~CppPanel()
 {
     AppData()->RemoveHandler(this->GetEventHandler());
+
+    // The result of a running job is dropped along with the pending events
+    m_previewTimer.Stop();
+    if (m_previewThread.joinable())
+        m_previewThread.join();
 }
 
 void CppPanel::InitStyledTextCtrl(wxStyledTextCtrl* stc)
@@ -134,78 +164,155 @@ void CppPanel::OnFind(wxFindDialogEvent& event)
         m_editorH->GetEventHandler()->ProcessEvent(event);
 }
 
-void CppPanel::OnPropertyModified(wxWeaverPropertyEvent& event)
+void CppPanel::OnPropertyModified(wxWeaverPropertyEvent&)
 {
-    event.SetId(1); // Generate code to the panel only
-    OnCodeGeneration(event);
+    SchedulePreview();
 }
 
-void CppPanel::OnProjectRefresh(wxWeaverEvent& event)
+void CppPanel::OnProjectRefresh(wxWeaverEvent&)
 {
-    event.SetId(1); // Generate code to the panel only
-    OnCodeGeneration(event);
+    SchedulePreview();
 }
 
-void CppPanel::OnObjectChange(wxWeaverObjectEvent& event)
+void CppPanel::OnObjectChange(wxWeaverObjectEvent&)
 {
-    event.SetId(1); // Generate code to the panel only
-    OnCodeGeneration(event);
+    SchedulePreview();
 }
 
-void CppPanel::OnEventHandlerModified(wxWeaverEventHandlerEvent& event)
+void CppPanel::OnEventHandlerModified(wxWeaverEventHandlerEvent&)
 {
-    event.SetId(1); // Generate code to the panel only
-    OnCodeGeneration(event);
+    SchedulePreview();
 }
 
-void CppPanel::OnCodeGeneration(wxWeaverEvent& event)
+void CppPanel::SchedulePreview()
 {
-    bool doPanel = IsShown(); // Generate code in the panel if the panel is active
+    if (!IsShown())
+        return;
 
-    // Using the previously unused Id field in the event to carry a boolean
-    bool panelOnly = (event.GetId());
+    // Outdate the running job, if any, and wait for the edits to settle
+    m_previewGeneration++;
+    m_previewProject = false;
+    m_previewTimer.StartOnce(PreviewDelay);
+}
 
-    // Only generate to panel + panel is not shown = do nothing
-    if (panelOnly && !doPanel)
+void CppPanel::OnPreviewTimer(wxTimerEvent&)
+{
+    StartPreview();
+}
+
+void CppPanel::StartPreview()
+{
+    if (m_previewRunning) {
+        m_previewPending = true;
+        return;
+    }
+    PObjectBase project = AppData()->GetProjectData();
+    if (!project)
         return;
 
     // For code preview generate only code relevant to selected form,
     // otherwise generate full project code.
+    PObjectBase form = m_previewProject ? PObjectBase() : AppData()->GetSelectedForm();
+
+    // The job works on its own copy, the project may be edited meanwhile
+    PObjectBase snapshot = project->Clone(!form);
+    if (form) {
+        PObjectBase formCopy = form->Clone();
+        snapshot->AddChild(formCopy);
+        formCopy->SetParent(snapshot);
+    }
+    size_t firstID = 1000; // Get First ID from Project File
+    PProperty pFirstID = project->GetProperty("first_id");
+    if (pFirstID)
+        firstID = pFirstID->GetValueAsInteger();
 
-    // Create copy of the original project due to possible temporary modifications
-    PObjectBase project = PObjectBase(new ObjectBase(*AppData()->GetProjectData()));
-    PObjectBase objectToGenerate;
-
-    if (panelOnly)
-        objectToGenerate = AppData()->GetSelectedForm();
-
-    if (!panelOnly || !objectToGenerate)
-        objectToGenerate = project;
-
-    // If only one project item should be generated then remove the rest items
-    // from the temporary project
-    if (doPanel && panelOnly && (objectToGenerate != project)) {
-        if (project->GetChildCount() > 0) {
-            size_t i = 0;
-            while (project->GetChildCount() > 1) {
-                if (project->GetChild(i) != objectToGenerate)
-                    project->RemoveChild(i);
-                else
-                    i++;
-            }
+    // Determine if the path is absolute or relative
+    bool useRelativePath = false;
+    PProperty pRelPath = project->GetProperty("relative_path");
+    if (pRelPath)
+        useRelativePath = (pRelPath->GetValueAsInteger() ? true : false);
+
+    wxString path; // Get the output path
+    try {
+        path = AppData()->GetOutputPath();
+    } catch (wxWeaverException&) {
+        path = wxEmptyString;
+    }
+    // The project file may change meanwhile, e.g. on Save As
+    const wxString projectFile = AppData()->GetProjectFileName();
+    const unsigned generation = ++m_previewGeneration;
+    m_previewRunning = true;
+    if (m_previewThread.joinable())
+        m_previewThread.join();
+
+    PFormCodeCache formCache = m_formCache;
+    m_previewThread = std::thread([this, snapshot, projectFile, firstID, useRelativePath,
+                                   path, generation, formCache]() {
+        // The templates and relative paths resolve against the copy
+        ApplicationData::SetThreadProject(snapshot, projectFile);
+
+        PStringCodeWriter header = std::make_shared<StringCodeWriter>();
+        PStringCodeWriter source = std::make_shared<StringCodeWriter>();
+
+        // Skip the jobs outdated while waiting
+        if (generation == m_previewGeneration) {
+            CppCodeGenerator codegen;
+            codegen.UseRelativePath(useRelativePath, path);
+            codegen.SetFirstID(firstID);
+            codegen.SetFormCache(formCache);
+            codegen.SetGenerateEmbeddedFiles(false);
+            codegen.SetHeaderWriter(header);
+            codegen.SetSourceWriter(source);
+            codegen.GenerateCode(snapshot);
         }
+        ApplicationData::SetThreadProject(PObjectBase(), wxEmptyString);
+
+        CallAfter([this, generation, header, source]() {
+            OnPreviewGenerated(generation, header->GetString(), source->GetString());
+        });
+    });
+}
+
+void CppPanel::OnPreviewGenerated(unsigned generation, const wxString& header,
+                                  const wxString& source)
+{
+    m_previewRunning = false;
+    if (m_previewPending) {
+        m_previewPending = false;
+        StartPreview();
+        return;
     }
-    if (!project || !objectToGenerate)
+    // A newer job is already scheduled
+    if (generation != m_previewGeneration)
         return;
 
+    Freeze();
+    SetEditorText(m_editorCpp->GetTextCtrl(), source);
+    SetEditorText(m_editorH->GetTextCtrl(), header);
+    Thaw();
+}
+
+void CppPanel::OnCodeGeneration(wxWeaverEvent& event)
+{
+    // Using the previously unused Id field in the event to carry a boolean
+    bool panelOnly = (event.GetId());
+    if (panelOnly) {
+        SchedulePreview();
+        return;
+    }
+    // Show the whole project in the panel while generating the files
+    if (IsShown()) {
+        m_previewTimer.Stop();
+        m_previewProject = true;
+        StartPreview();
+    }
+    // Create copy of the original project due to possible temporary modifications
+    PObjectBase project = PObjectBase(new ObjectBase(*AppData()->GetProjectData()));
+
     // Get C++ properties from the project
     // If C++ generation is not enabled, do not generate the file
-    bool doFile = false;
     PProperty pCodeGen = project->GetProperty("code_generation");
-    if (pCodeGen)
-        doFile = TypeConv::FlagSet("C++", pCodeGen->GetValueAsString()) && !panelOnly;
-
-    if (!(doPanel || doFile))
+    if (!pCodeGen || !TypeConv::FlagSet("C++", pCodeGen->GetValueAsString()))
         return;
 
     size_t firstID = 1000; // Get First ID from Project File
@@ -231,62 +338,22 @@ void CppPanel::OnCodeGeneration(wxWeaverEvent& event)
     try {
         path = AppData()->GetOutputPath();
     } catch (wxWeaverException& ex) {
-        if (doFile) {
-            path = wxEmptyString;
-            wxLogWarning(ex.what());
-            return;
-        }
-    }
-    if (doPanel) { // Generate code in the panel
-        CppCodeGenerator codegen;
-        codegen.UseRelativePath(useRelativePath, path);
-
-        if (pFirstID)
-            codegen.SetFirstID(firstID);
-
-        codegen.SetHeaderWriter(m_codeWriterH);
-        codegen.SetSourceWriter(m_codeWriterCpp);
-
-        Freeze();
-
-        wxStyledTextCtrl* cppEditor = m_editorCpp->GetTextCtrl();
-        wxStyledTextCtrl* hEditor = m_editorH->GetTextCtrl();
-        cppEditor->SetReadOnly(false);
-        int cppLine = cppEditor->GetFirstVisibleLine()
-            + cppEditor->LinesOnScreen() - 1;
-
-        int cppXOffset = cppEditor->GetXOffset();
-
-        hEditor->SetReadOnly(false);
-        int hLine = hEditor->GetFirstVisibleLine() + hEditor->LinesOnScreen() - 1;
-        int hXOffset = hEditor->GetXOffset();
-
-        codegen.GenerateCode(project);
-
-        cppEditor->SetReadOnly(true);
-        cppEditor->GotoLine(cppLine);
-        cppEditor->SetXOffset(cppXOffset);
-        cppEditor->SetAnchor(0);
-        cppEditor->SetCurrentPos(0);
-
-        hEditor->SetReadOnly(true);
-        hEditor->GotoLine(hLine);
-        hEditor->SetXOffset(hXOffset);
-        hEditor->SetAnchor(0);
-        hEditor->SetCurrentPos(0);
-
-        Thaw();
-    }
-    if (!doFile)
+        wxLogWarning(ex.what());
         return;
+    }
 
     try { // Generate code in the file
+        // The manifests of the output directories are written once at the end
+        FileCodeWriter::Batch batch;
         CppCodeGenerator codegen;
         codegen.UseRelativePath(useRelativePath, path);
 
         if (pFirstID)
             codegen.SetFirstID(firstID);
 
+        // Shared with the panel, whose last generation is usually up to date
+        codegen.SetFormCache(m_formCache);
+
         // Determine if Microsoft BOM should be used
         bool useMicrosoftBOM = false;
 
@@ -308,6 +375,9 @@ void CppPanel::OnCodeGeneration(wxWeaverEvent& event)
 
         codegen.SetHeaderWriter(h_cw);
         codegen.SetSourceWriter(cpp_cw);
+        codegen.SetWriterFactory([&](const wxString& fileName) {
+            return PCodeWriter(new FileCodeWriter(path + fileName, useMicrosoftBOM, useUtf8));
+        });
         codegen.GenerateCode(project);
         wxLogStatus("Code generated on \'%s\'.", path.c_str());
     } catch (wxWeaverException& ex) {
@@ -23,6 +23,10 @@
 #include "utils/defs.h"
 
 #include <wx/panel.h>
+#include <wx/timer.h>
+
+#include <atomic>
+#include <thread>
 
 class CodeEditor;
 
@@ -51,9 +55,35 @@ public:
 private:
     void InitStyledTextCtrl(wxStyledTextCtrl*);
 
+    /** Regenerates the preview once the edits stop for a while.
+    */
+    void SchedulePreview();
+
+    /** Generates the preview on a worker thread, using a copy of the project.
+
+        If a job is already running the new one starts when it ends.
+    */
+    void StartPreview();
+
+    void OnPreviewTimer(wxTimerEvent&);
+
+    /** Shows the code generated by a preview job, unless it is outdated.
+    */
+    void OnPreviewGenerated(unsigned generation, const wxString& header,
+                            const wxString& source);
+
+    // Milliseconds without edits before regenerating the preview
+    static const int PreviewDelay = 150;
+
     wxAuiNotebook* m_notebook;
     CodeEditor* m_editorCpp;
     CodeEditor* m_editorH;
-    PTCCodeWriter m_codeWriterH;
-    PTCCodeWriter m_codeWriterCpp;
+    PFormCodeCache m_formCache;
+
+    wxTimer m_previewTimer;
+    std::thread m_previewThread;
+    std::atomic<unsigned> m_previewGeneration;
+    bool m_previewRunning;
+    bool m_previewPending;
+    bool m_previewProject; // Whole project instead of the selected form
 };
@@ -168,13 +168,9 @@ void XrcPanel::OnCodeGeneration(wxWeaverEvent& event)
             if (file.empty())
                 file = "noname";
 
-            wxString filePath;
-            filePath << path << file << ".xrc";
-            PCodeWriter cw(new FileCodeWriter(filePath));
-
+            FileCodeWriter::Batch batch;
             XrcCodeGenerator codegen;
-            codegen.SetWriter(cw);
-            codegen.GenerateCode(project);
+            codegen.GenerateFiles(project, path + file);
             wxLogStatus(_("Code generated on \'%s\'."), path.c_str());
         } catch (wxWeaverException& ex) {
             wxLogError(ex.what());
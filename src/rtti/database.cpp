@@ -26,13 +26,13 @@
 #include "utils/typeconv.h"
 #include "utils/exception.h"
 #include "rtti/objectbase.h"
-#include "wxweaver.h"
 
 #include <ticpp.h>
 
 #include <wx/app.h>
 #include <wx/dir.h>
 #include <wx/filename.h>
+#include <wx/intl.h>
 #include <wx/stdpaths.h>
 
 #define OBJINFO_TAG "objectinfo"
@@ -79,6 +79,7 @@ void ObjectPackage::AppendPackage(PObjectPackage package)
 }
 
 ObjectDatabase::ObjectDatabase()
+    : m_loadIcons(true)
 {
 #if 0
     InitObjectTypes();
@@ -651,7 +652,7 @@ void ObjectDatabase::SetupPackage(const wxString& file,
 #else
     wxStandardPathsBase& stdpaths = wxStandardPaths::Get();
     wxString libPath = stdpaths.GetPluginsDir();
-    libPath.Replace(wxTheApp->GetAppName().c_str(), "wxweaver");
+    libPath.Replace(wxAppConsole::GetInstance()->GetAppName().c_str(), "wxweaver");
 #endif
     // Renamed libraries for convenience in debug using a "-xx" wx version as suffix.
     // This will also prevent loading debug libraries in release and vice versa,
@@ -676,10 +677,11 @@ void ObjectDatabase::SetupPackage(const wxString& file,
             wxString workingDir = ::wxGetCwd();
 #if 1
             // Add locale support the loaded plugin
-            if (!wxGetApp().AddPluginLocaleCatalog(libString))
+            wxLocale* locale = wxGetLocale();
+            if (locale && !locale->AddCatalog(libString))
                 wxLogWarning("Can't load wxLocale catalog %s", libString);
 #endif
-            wxLogTrace(wxTRACE_Messages, "AddPluginLocaleCatalog(): %s", libString);
+            wxLogTrace(wxTRACE_Messages, "AddCatalog(): %s", libString);
 
             // Allows plugin dependency dlls to be next to plugin dll in windows
             wxFileName::SetCwd(libPath);
@@ -899,11 +901,13 @@ PObjectPackage ObjectDatabase::LoadPackage(const wxString& file,
         wxString pkgIconPath = iconPath + wxFILE_SEP_PATH + pkgIconName;
 
         wxBitmap pkgIcon;
-        if (!pkgIconName.empty() && wxFileName::FileExists(pkgIconPath)) {
-            wxImage image(pkgIconPath, wxBITMAP_TYPE_ANY);
-            pkgIcon = wxBitmap(image.Scale(16, 16));
-        } else {
-            pkgIcon = AppBitmaps::GetBitmap("unknown", 16);
+        if (m_loadIcons) {
+            if (!pkgIconName.empty() && wxFileName::FileExists(pkgIconPath)) {
+                wxImage image(pkgIconPath, wxBITMAP_TYPE_ANY);
+                pkgIcon = wxBitmap(image.Scale(16, 16));
+            } else {
+                pkgIcon = AppBitmaps::GetBitmap("unknown", 16);
+            }
         }
 
         package = PObjectPackage(new ObjectPackage(pkgName, pkgDesc, pkgIcon));
@@ -942,20 +946,22 @@ PObjectPackage ObjectDatabase::LoadPackage(const wxString& file,
             PObjectInfo objInfo(
                 new ObjectInfo(className, GetObjectType(type), package, startGroup));
 
-            if (!icon.empty() && wxFileName::FileExists(iconFullPath)) {
-                wxImage img(iconFullPath, wxBITMAP_TYPE_ANY);
-                objInfo->SetIconFile(wxBitmap(img.Scale(ICON_SIZE, ICON_SIZE)));
-            } else {
-                objInfo->SetIconFile(AppBitmaps::GetBitmap("unknown", ICON_SIZE));
-            }
-            if (!smallIcon.empty() && wxFileName::FileExists(smallIconFullPath)) {
-                wxImage img(smallIconFullPath, wxBITMAP_TYPE_ANY);
-                objInfo->SetSmallIconFile(
-                    wxBitmap(img.Scale(SMALL_ICON_SIZE, SMALL_ICON_SIZE)));
-            } else {
-                wxImage img = objInfo->GetIconFile().ConvertToImage();
-                objInfo->SetSmallIconFile(
-                    wxBitmap(img.Scale(SMALL_ICON_SIZE, SMALL_ICON_SIZE)));
+            if (m_loadIcons) {
+                if (!icon.empty() && wxFileName::FileExists(iconFullPath)) {
+                    wxImage img(iconFullPath, wxBITMAP_TYPE_ANY);
+                    objInfo->SetIconFile(wxBitmap(img.Scale(ICON_SIZE, ICON_SIZE)));
+                } else {
+                    objInfo->SetIconFile(AppBitmaps::GetBitmap("unknown", ICON_SIZE));
+                }
+                if (!smallIcon.empty() && wxFileName::FileExists(smallIconFullPath)) {
+                    wxImage img(smallIconFullPath, wxBITMAP_TYPE_ANY);
+                    objInfo->SetSmallIconFile(
+                        wxBitmap(img.Scale(SMALL_ICON_SIZE, SMALL_ICON_SIZE)));
+                } else {
+                    wxImage img = objInfo->GetIconFile().ConvertToImage();
+                    objInfo->SetSmallIconFile(
+                        wxBitmap(img.Scale(SMALL_ICON_SIZE, SMALL_ICON_SIZE)));
+                }
             }
             // Parse the Properties
             std::set<PropertyType> types;
@@ -112,6 +112,11 @@ public:
 
     void SetPluginPath(const wxString& path) { m_pluginPath = path; }
 
+    /** Enables loading the icons of packages and objects,
+        they are not needed (nor loadable) without a display.
+    */
+    void SetLoadIcons(bool load) { m_loadIcons = load; }
+
     /** Obtains the path where the files with the object description are located.
     */
     wxString GetXmlPath() const { return m_xmlPath; }
@@ -242,4 +247,6 @@ private:
 
     // Used so libraries are only imported once, even if multiple libraries use them
     std::set<wxString> m_importedLibraries;
+
+    bool m_loadIcons;
 };
@@ -21,7 +21,9 @@
 #include "rtti/objectbase.h"
 
 #include "appdata.h"
+#include "codegen/codegen.h"
 #include "utils/debug.h"
+#include "utils/fileutils.h"
 #include "utils/stringutils.h"
 #include "utils/typeconv.h"
 
@@ -461,6 +463,54 @@ PObjectBase ObjectBase::GetChild(size_t idx)
     return m_children[idx];
 }
 
+uint64_t ObjectBase::Hash(uint64_t hash, bool recursive) const
+{
+    hash = FileUtils::HashString(GetClassName(), hash);
+    for (const auto& property : m_properties) {
+        hash = FileUtils::HashString(property.first, hash);
+        hash = FileUtils::HashString(property.second->GetValueAsString(), hash);
+    }
+    for (const auto& event : m_events) {
+        hash = FileUtils::HashString(event.first, hash);
+        hash = FileUtils::HashString(event.second->GetValue(), hash);
+    }
+    if (recursive) {
+        const size_t count = m_children.size();
+        hash = FileUtils::Hash(&count, sizeof(count), hash);
+        for (const PObjectBase& child : m_children)
+            hash = child->Hash(hash);
+    }
+    return hash;
+}
+
+PObjectBase ObjectBase::Clone(bool recursive) const
+{
+    PObjectBase copy = std::make_shared<ObjectBase>(m_class);
+    copy->SetObjectTypeName(m_type);
+    copy->SetObjectInfo(m_info);
+    copy->SetExpanded(m_expanded);
+
+    for (const auto& property : m_properties) {
+        PProperty propertyCopy
+            = std::make_shared<Property>(property.second->GetPropertyInfo(), copy);
+        propertyCopy->SetValue(property.second->GetValueAsString());
+        copy->AddProperty(propertyCopy);
+    }
+    for (const auto& event : m_events) {
+        PEvent eventCopy = std::make_shared<Event>(event.second->GetEventInfo(), copy);
+        eventCopy->SetValue(event.second->GetValue());
+        copy->AddEvent(eventCopy);
+    }
+    if (recursive) {
+        for (const PObjectBase& child : m_children) {
+            PObjectBase childCopy = child->Clone();
+            copy->m_children.push_back(childCopy);
+            childCopy->SetParent(copy);
+        }
+    }
+    return copy;
+}
+
 PObjectBase ObjectBase::GetChild(size_t idx, const wxString& type)
 {
 #if 0
@@ -950,6 +1000,11 @@ PCodeInfo ObjectInfo::GetCodeInfo(const wxString& language)
     return result;
 }
 
+CodeInfo::CodeInfo(const CodeInfo& other)
+    : m_templates(other.m_templates)
+{
+}
+
 wxString CodeInfo::GetTemplate(const wxString& name)
 {
     wxString result;
@@ -960,6 +1015,20 @@ wxString CodeInfo::GetTemplate(const wxString& name)
     return result;
 }
 
+PCompiledTemplate CodeInfo::GetCompiledTemplate(const wxString& name)
+{
+    std::lock_guard<std::mutex> lock(m_compiledTemplatesMutex);
+
+    PCompiledTemplate& compiled = m_compiledTemplates[name];
+    if (!compiled) {
+        TemplateMap::const_iterator it = m_templates.find(name);
+        compiled = CompiledTemplate::Compile(it != m_templates.end() ? it->second
+                                                                     : wxString());
+    }
+
+    return compiled;
+}
+
 void CodeInfo::AddTemplate(const wxString& name, const wxString& template_)
 {
     m_templates.insert(TemplateMap::value_type(name, template_));
@@ -976,6 +1045,8 @@ void CodeInfo::Merge(PCodeInfo merger)
         if (!mine.second)
             mine.first->second += mergerTemplate->second;
     }
+    std::lock_guard<std::mutex> lock(m_compiledTemplatesMutex);
+    m_compiledTemplates.clear();
 }
 
 wxString PropertyCategory::GetPropertyName(size_t index) const
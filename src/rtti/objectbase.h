@@ -33,7 +33,9 @@
 
 #include <component.h>
 
+#include <cstdint>
 #include <list>
+#include <mutex>
 
 class OptionList {
 public:
@@ -267,6 +269,21 @@ public:
 
     size_t GetEventCount() const { return m_events.size(); }
 
+    /** Adds the class name, the property and event values and,
+        if @a recursive, the children of the object to @a hash.
+
+        @see FileUtils::Hash()
+    */
+    uint64_t Hash(uint64_t hash, bool recursive = true) const;
+
+    /** Copies the object and, if @a recursive, its children.
+
+        Unlike ObjectDatabase::CopyObject() the names are kept as they are and
+        the instance counters are left untouched, so it can be used to take
+        snapshots of the project, e.g. for generating code in the background.
+    */
+    PObjectBase Clone(bool recursive = true) const;
+
     /** Obtiene una propiedad del objeto.
         @todo esta función deberá lanzar una excepción en caso de no encontrarse
               dicha propiedad, así se simplifica el código al no tener que hacer
@@ -452,13 +469,31 @@ private:
 */
 class CodeInfo {
 public:
+    CodeInfo() = default;
+
+    /** Copies the templates, compiled templates are not shared.
+    */
+    CodeInfo(const CodeInfo& other);
+
     wxString GetTemplate(const wxString& name);
+
+    /** Gets the template @a name compiled for the TemplateParser.
+
+        Templates are compiled on first use and cached, this is safe to call
+        from concurrent code generators. A missing template results in an
+        empty compiled template.
+    */
+    PCompiledTemplate GetCompiledTemplate(const wxString& name);
+
     void AddTemplate(const wxString& name, const wxString& template_);
     void Merge(PCodeInfo merger);
 
 private:
     typedef std::map<wxString, wxString> TemplateMap;
+    typedef std::map<wxString, PCompiledTemplate> CompiledTemplateMap;
     TemplateMap m_templates;
+    CompiledTemplateMap m_compiledTemplates;
+    std::mutex m_compiledTemplatesMutex;
 };
 
 /** Object or MetaObject information.
@@ -0,0 +1,448 @@
+/*
+    wxWeaver - A GUI Designer Editor for wxWidgets.
+    Copyright (C) 2021 Andrea Zanellato <redtid3@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include "rtti/snapshot.h"
+
+#include "appdata.h"
+#include "rtti/objectbase.h"
+#include "utils/debug.h"
+#include "utils/exception.h"
+#include "utils/fileutils.h"
+
+#include <wx/file.h>
+#include <wx/filename.h>
+#include <wx/log.h>
+
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+/*
+    Layout (all integers are little endian):
+
+    header      magic[8] version:u32 fbpMajor:u32 fbpMinor:u32
+                sourceSize:u64 sourceTime:u64
+    strings     count:u32 { length:u32 utf8[length] }
+    classes     count:u32 { name:u32 (string index) }
+    object      class:u32 expanded:u8
+                propCount:u32  { name:u32 value:u32 }
+                eventCount:u32 { name:u32 value:u32 }
+                childCount:u32 { object }
+*/
+namespace {
+const char s_magic[8] = { 'W', 'X', 'W', 'B', 'P', 'R', 'J', '\x1A' };
+const uint32_t s_formatVersion = 1;
+const size_t s_headerSize = sizeof(s_magic) + 3 * 4 + 2 * 8;
+
+void PutU32(std::string& out, uint32_t value)
+{
+    const char bytes[4] = {
+        static_cast<char>(value & 0xFF),
+        static_cast<char>((value >> 8) & 0xFF),
+        static_cast<char>((value >> 16) & 0xFF),
+        static_cast<char>((value >> 24) & 0xFF)
+    };
+    out.append(bytes, 4);
+}
+
+void PutU64(std::string& out, uint64_t value)
+{
+    PutU32(out, static_cast<uint32_t>(value & 0xFFFFFFFF));
+    PutU32(out, static_cast<uint32_t>(value >> 32));
+}
+
+class SnapshotWriter {
+public:
+    void WriteObject(PObjectBase obj)
+    {
+        PutU32(m_objects, AddClass(obj->GetClassName()));
+        m_objects.push_back(obj->GetExpanded() ? 1 : 0);
+
+        const size_t propCount = obj->GetPropertyCount();
+        PutU32(m_objects, static_cast<uint32_t>(propCount));
+        for (size_t i = 0; i < propCount; ++i) {
+            PProperty prop = obj->GetProperty(i);
+            PutU32(m_objects, AddString(prop->GetName()));
+            PutU32(m_objects, AddString(prop->GetValueAsString()));
+        }
+        // Like the XML format, events without a handler are not stored
+        std::vector<PEvent> events;
+        for (size_t i = 0; i < obj->GetEventCount(); ++i) {
+            PEvent event = obj->GetEvent(i);
+            if (!event->GetValue().empty())
+                events.push_back(event);
+        }
+        PutU32(m_objects, static_cast<uint32_t>(events.size()));
+        for (PEvent& event : events) {
+            PutU32(m_objects, AddString(event->GetName()));
+            PutU32(m_objects, AddString(event->GetValue()));
+        }
+        const size_t childCount = obj->GetChildCount();
+        PutU32(m_objects, static_cast<uint32_t>(childCount));
+        for (size_t i = 0; i < childCount; ++i)
+            WriteObject(obj->GetChild(i));
+    }
+
+    std::string Finish(uint64_t sourceSize, int64_t sourceTime)
+    {
+        std::string out;
+        out.reserve(s_headerSize + m_strings.size() + m_objects.size()
+                    + 4 * (m_classes.size() + 2));
+
+        out.append(s_magic, sizeof(s_magic));
+        PutU32(out, s_formatVersion);
+        PutU32(out, static_cast<uint32_t>(AppData()->m_fbpVerMajor));
+        PutU32(out, static_cast<uint32_t>(AppData()->m_fbpVerMinor));
+        PutU64(out, sourceSize);
+        PutU64(out, static_cast<uint64_t>(sourceTime));
+
+        PutU32(out, static_cast<uint32_t>(m_stringIds.size()));
+        out.append(m_strings);
+
+        PutU32(out, static_cast<uint32_t>(m_classes.size()));
+        for (uint32_t classNameId : m_classes)
+            PutU32(out, classNameId);
+
+        out.append(m_objects);
+        return out;
+    }
+
+private:
+    uint32_t AddString(const wxString& str)
+    {
+        const wxScopedCharBuffer utf8 = str.utf8_str();
+        std::string key(utf8.data(), utf8.length());
+
+        auto it = m_stringIds.find(key);
+        if (it != m_stringIds.end())
+            return it->second;
+
+        const uint32_t id = static_cast<uint32_t>(m_stringIds.size());
+        PutU32(m_strings, static_cast<uint32_t>(key.size()));
+        m_strings.append(key);
+        m_stringIds.emplace(std::move(key), id);
+        return id;
+    }
+
+    uint32_t AddClass(const wxString& className)
+    {
+        const uint32_t nameId = AddString(className);
+        auto it = m_classIds.find(nameId);
+        if (it != m_classIds.end())
+            return it->second;
+
+        const uint32_t id = static_cast<uint32_t>(m_classes.size());
+        m_classes.push_back(nameId);
+        m_classIds.emplace(nameId, id);
+        return id;
+    }
+
+    std::unordered_map<std::string, uint32_t> m_stringIds;
+    std::unordered_map<uint32_t, uint32_t> m_classIds;
+    std::vector<uint32_t> m_classes;
+    std::string m_strings;
+    std::string m_objects;
+};
+
+class SnapshotReader {
+public:
+    SnapshotReader(const char* data, size_t size)
+        : m_pos(data)
+        , m_end(data + size)
+    {
+    }
+
+    void ReadHeader(uint64_t* sourceSize, int64_t* sourceTime)
+    {
+        if (static_cast<size_t>(m_end - m_pos) < s_headerSize
+            || memcmp(m_pos, s_magic, sizeof(s_magic)) != 0) {
+            wxWEAVER_THROW_EX("Not a wxWeaver binary project")
+        }
+        m_pos += sizeof(s_magic);
+
+        const uint32_t version = GetU32();
+        const uint32_t fbpMajor = GetU32();
+        const uint32_t fbpMinor = GetU32();
+        if (version != s_formatVersion
+            || fbpMajor != static_cast<uint32_t>(AppData()->m_fbpVerMajor)
+            || fbpMinor != static_cast<uint32_t>(AppData()->m_fbpVerMinor)) {
+            wxWEAVER_THROW_EX("This binary project was written by a different version of wxWeaver")
+        }
+        *sourceSize = GetU64();
+        *sourceTime = static_cast<int64_t>(GetU64());
+    }
+
+    void ReadTables(PObjectDatabase db)
+    {
+        const uint32_t stringCount = GetCount(4);
+        m_strings.reserve(stringCount);
+        for (uint32_t i = 0; i < stringCount; ++i) {
+            const uint32_t length = GetU32();
+            Require(length);
+            m_strings.push_back(wxString::FromUTF8(m_pos, length));
+            m_pos += length;
+        }
+        const uint32_t classCount = GetCount(4);
+        m_classes.reserve(classCount);
+        for (uint32_t i = 0; i < classCount; ++i) {
+            const wxString& className = GetString();
+            if (!db->GetObjectInfo(className)) {
+                wxWEAVER_THROW_EX("Unknown Object Type: " << className)
+            }
+            m_classes.push_back(className.ToStdString());
+        }
+    }
+
+    /** Mirrors ObjectDatabase::CreateObject(ticpp::Element*, PObjectBase)
+    */
+    PObjectBase ReadObject(PObjectDatabase db, PObjectBase parent = PObjectBase())
+    {
+        const uint32_t classId = GetU32();
+        if (classId >= m_classes.size()) {
+            wxWEAVER_THROW_EX("Invalid class index in binary project")
+        }
+        const std::string& className = m_classes[classId];
+        const bool expanded = GetU8() != 0;
+
+        PObjectBase newobject = db->CreateObject(className, parent);
+        PObjectBase object = newobject;
+        if (object && object->GetChildCount())
+            object = object->GetChild(0);
+
+        if (!object) {
+            SkipObjectBody();
+            return newobject;
+        }
+        object->SetExpanded(expanded);
+
+        const uint32_t propCount = GetU32();
+        for (uint32_t i = 0; i < propCount; ++i) {
+            const wxString& name = GetString();
+            const wxString& value = GetString();
+            PProperty prop = object->GetProperty(name);
+            if (prop) {
+                prop->SetValue(value);
+            } else if (!value.empty()) {
+                wxLogError(
+                    "The property named \"%s\" of class \"%s\" is not supported by this version of wxWeaver.\n"
+                    "The property's value is: %s\n"
+                    "If you save this project, YOU WILL LOSE DATA",
+                    name, className.c_str(), value);
+            }
+        }
+        const uint32_t eventCount = GetU32();
+        for (uint32_t i = 0; i < eventCount; ++i) {
+            const wxString& name = GetString();
+            const wxString& value = GetString();
+            PEvent event = object->GetEvent(name);
+            if (event)
+                event->SetValue(value);
+        }
+        if (parent) {
+            parent->AddChild(newobject);
+            newobject->SetParent(parent);
+        }
+        const uint32_t childCount = GetU32();
+        for (uint32_t i = 0; i < childCount; ++i)
+            ReadObject(db, object);
+
+        return newobject;
+    }
+
+    bool AtEnd() const { return m_pos == m_end; }
+
+private:
+    void SkipObjectBody()
+    {
+        m_pos += 8 * static_cast<size_t>(GetCount(8)); // properties
+        m_pos += 8 * static_cast<size_t>(GetCount(8)); // events
+
+        const uint32_t childCount = GetU32();
+        for (uint32_t i = 0; i < childCount; ++i) {
+            GetU32();
+            GetU8();
+            SkipObjectBody();
+        }
+    }
+
+    void Require(size_t bytes) const
+    {
+        if (static_cast<size_t>(m_end - m_pos) < bytes) {
+            wxWEAVER_THROW_EX("Truncated binary project")
+        }
+    }
+
+    /** Reads a record count checking that @a recordSize * count bytes follow.
+    */
+    uint32_t GetCount(size_t recordSize)
+    {
+        const uint32_t count = GetU32();
+        Require(recordSize * count);
+        return count;
+    }
+
+    uint8_t GetU8()
+    {
+        Require(1);
+        return static_cast<uint8_t>(*m_pos++);
+    }
+
+    uint32_t GetU32()
+    {
+        Require(4);
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(m_pos);
+        m_pos += 4;
+        return static_cast<uint32_t>(bytes[0])
+            | (static_cast<uint32_t>(bytes[1]) << 8)
+            | (static_cast<uint32_t>(bytes[2]) << 16)
+            | (static_cast<uint32_t>(bytes[3]) << 24);
+    }
+
+    uint64_t GetU64()
+    {
+        const uint64_t low = GetU32();
+        const uint64_t high = GetU32();
+        return low | (high << 32);
+    }
+
+    const wxString& GetString()
+    {
+        const uint32_t id = GetU32();
+        if (id >= m_strings.size()) {
+            wxWEAVER_THROW_EX("Invalid string index in binary project")
+        }
+        return m_strings[id];
+    }
+
+    const char* m_pos;
+    const char* m_end;
+    std::vector<wxString> m_strings;
+    std::vector<std::string> m_classes;
+};
+} // namespace
+
+const wxString ProjectSnapshot::FileExtension = "fbpb";
+const wxString ProjectSnapshot::CacheExtension = "fbpc";
+
+bool ProjectSnapshot::IsSnapshotFile(const wxString& file)
+{
+    wxFile in;
+    if (!in.Open(file, wxFile::read))
+        return false;
+
+    char magic[sizeof(s_magic)];
+    return in.Read(magic, sizeof(magic)) == static_cast<ssize_t>(sizeof(magic))
+        && memcmp(magic, s_magic, sizeof(magic)) == 0;
+}
+
+bool ProjectSnapshot::HasSnapshotExtension(const wxString& file)
+{
+    return wxFileName(file).GetExt().IsSameAs(FileExtension, false);
+}
+
+std::string ProjectSnapshot::Serialize(PObjectBase project, uint64_t sourceSize,
+                                       int64_t sourceTime)
+{
+    SnapshotWriter writer;
+    writer.WriteObject(project);
+    return writer.Finish(sourceSize, sourceTime);
+}
+
+bool ProjectSnapshot::WriteFile(const std::string& data, const wxString& file)
+{
+    return FileUtils::WriteFileAtomically(data, file);
+}
+
+bool ProjectSnapshot::Save(PObjectBase project, const wxString& file)
+{
+    return WriteFile(Serialize(project), file);
+}
+
+PObjectBase ProjectSnapshot::Load(PObjectDatabase db, const wxString& file)
+{
+    std::vector<char> data;
+    if (!FileUtils::ReadFile(file, &data)) {
+        wxWEAVER_THROW_EX("Unable to read " << file)
+    }
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    SnapshotReader reader(data.data(), data.size());
+    reader.ReadHeader(&sourceSize, &sourceTime);
+    reader.ReadTables(db);
+
+    PObjectBase project = reader.ReadObject(db);
+    if (!reader.AtEnd()) {
+        wxWEAVER_THROW_EX("Unexpected data at the end of " << file)
+    }
+    return project;
+}
+
+wxString ProjectSnapshot::GetCacheFileName(const wxString& projectFile)
+{
+    wxFileName cacheFile(projectFile);
+    cacheFile.SetExt(CacheExtension);
+    return cacheFile.GetFullPath();
+}
+
+bool ProjectSnapshot::SaveCache(PObjectBase project, const wxString& projectFile)
+{
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    if (!FileUtils::GetFileStamp(projectFile, &sourceSize, &sourceTime))
+        return false;
+
+    return WriteFile(Serialize(project, sourceSize, sourceTime),
+                     GetCacheFileName(projectFile));
+}
+
+PObjectBase ProjectSnapshot::LoadCache(PObjectDatabase db, const wxString& projectFile)
+{
+    const wxString cacheFile = GetCacheFileName(projectFile);
+    if (!wxFileName::FileExists(cacheFile))
+        return PObjectBase();
+
+    uint64_t projectSize, cacheSize;
+    int64_t projectTime, cacheTime;
+    if (!FileUtils::GetFileStamp(projectFile, &projectSize, &projectTime)
+        || !FileUtils::GetFileStamp(cacheFile, &cacheSize, &cacheTime)
+        || cacheTime < projectTime)
+        return PObjectBase();
+
+    std::vector<char> data;
+    if (!FileUtils::ReadFile(cacheFile, &data))
+        return PObjectBase();
+
+    try {
+        uint64_t sourceSize;
+        int64_t sourceTime;
+        SnapshotReader reader(data.data(), data.size());
+        reader.ReadHeader(&sourceSize, &sourceTime);
+
+        // The cache must have been written from this very project file
+        if (sourceSize != projectSize || sourceTime != projectTime)
+            return PObjectBase();
+
+        reader.ReadTables(db);
+        PObjectBase project = reader.ReadObject(db);
+        if (reader.AtEnd())
+            return project;
+    } catch (wxWeaverException& ex) {
+        LogDebug("Ignoring project cache %s: %s", cacheFile, ex.what());
+    }
+    return PObjectBase();
+}
@@ -0,0 +1,98 @@
+/*
+    wxWeaver - A GUI Designer Editor for wxWidgets.
+    Copyright (C) 2021 Andrea Zanellato <redtid3@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#pragma once
+
+#include "rtti/database.h"
+
+#include <cstdint>
+#include <string>
+
+/** Compact binary representation of a project object tree.
+
+    The snapshot holds a string table, a table of the object classes used by
+    the project (resolved against the ObjectDatabase once per class) and one
+    record per object with its property and event name/value pairs.
+
+    It is used both as an explicit project format (*.fbpb) and as a sidecar
+    cache of a XML project (*.fbpc) that LoadProject prefers while it is
+    up to date.
+*/
+class ProjectSnapshot {
+public:
+    /** Extension of the explicit binary project format.
+    */
+    static const wxString FileExtension;
+
+    /** Extension of the cache file written next to a XML project.
+    */
+    static const wxString CacheExtension;
+
+    /** Checks the magic number of @a file.
+    */
+    static bool IsSnapshotFile(const wxString& file);
+
+    /** Checks whether @a file should be saved using the binary format,
+        according to its extension.
+    */
+    static bool HasSnapshotExtension(const wxString& file);
+
+    /** Serializes the object tree of @a project into memory.
+
+        This only walks the tree, so it is cheap enough to be called from the
+        main thread while the resulting buffer is written elsewhere.
+
+        @param project The project object.
+        @param sourceSize Size of the XML file this snapshot caches, if any.
+        @param sourceTime Modification time (ms) of the XML file, if any.
+    */
+    static std::string Serialize(PObjectBase project, uint64_t sourceSize = 0,
+                                 int64_t sourceTime = 0);
+
+    /** Writes a serialized snapshot to @a file replacing it atomically.
+    */
+    static bool WriteFile(const std::string& data, const wxString& file);
+
+    /** Saves @a project as an explicit binary project file.
+    */
+    static bool Save(PObjectBase project, const wxString& file);
+
+    /** Loads an object tree from a snapshot file.
+
+        @throw wxWeaverException If the file is not a valid snapshot or it was
+        written by a different project file version.
+    */
+    static PObjectBase Load(PObjectDatabase db, const wxString& file);
+
+    /** Gets the name of the cache file of a XML project.
+    */
+    static wxString GetCacheFileName(const wxString& projectFile);
+
+    /** Writes the cache file of the XML project @a projectFile,
+        which must be already saved to disk.
+    */
+    static bool SaveCache(PObjectBase project, const wxString& projectFile);
+
+    /** Loads the cache of @a projectFile if it is newer than the project
+        and it was written from the current project file contents.
+
+        @return The project object, or an empty pointer if there is no
+        valid cache, so the caller can fall back to the XML file.
+    */
+    static PObjectBase LoadCache(PObjectDatabase db, const wxString& projectFile);
+};
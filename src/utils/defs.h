@@ -38,6 +38,8 @@ class Event;
 class PropertyCategory;
 class wxWeaverManager;
 class CodeWriter;
+class CompiledTemplate;
+class FormCodeCache;
 class TemplateParser;
 class TCCodeWriter;
 class StringCodeWriter;
@@ -70,6 +72,8 @@ typedef std::vector<PEvent> EventVector;
 
 typedef std::shared_ptr<wxWeaverManager> PwxWeaverManager;
 typedef std::shared_ptr<CodeWriter> PCodeWriter;
+typedef std::shared_ptr<const CompiledTemplate> PCompiledTemplate;
+typedef std::shared_ptr<FormCodeCache> PFormCodeCache;
 typedef std::shared_ptr<TemplateParser> PTemplateParser;
 typedef std::shared_ptr<TCCodeWriter> PTCCodeWriter;
 typedef std::shared_ptr<StringCodeWriter> PStringCodeWriter;
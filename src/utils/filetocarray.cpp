@@ -24,12 +24,39 @@
 #include "rtti/objectbase.h"
 #include "codegen/codewriter.h"
 #include "codegen/cppcg.h"
+#include "codegen/dependencies.h"
 #include "utils/typeconv.h"
 #include "utils/exception.h"
+#include "utils/fileutils.h"
 
 #include <wx/filename.h>
+#include <wx/log.h>
+#include <wx/thread.h>
 
-#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+/** What was last written to an embedded file header.
+*/
+struct EmittedFile {
+    uint64_t sourceSize = 0;
+    int64_t sourceTime = 0;
+    uint64_t targetSize = 0;
+    int64_t targetTime = 0;
+    uint64_t settings = 0; // Hash of the output path, array name and encoding
+    uint64_t contents = 0; // Hash of the source file
+};
+
+// Headers are written by several workers
+std::mutex s_emittedFilesMutex;
+std::map<wxString, EmittedFile> s_emittedFiles;
+
+} // namespace
 
 wxString GetBitmapTypeName(long type)
 {
@@ -73,28 +100,104 @@ wxString GetBitmapType(const wxFileName& sourceFileName)
         return "wxBITMAP_TYPE_ANY";
 }
 
-wxString FileToCArray::Generate(const wxString& sourcePath)
+wxString FileToCArray::EncodeBytes(const char* data, size_t size)
+{
+    static const char digits[] = "0123456789ABCDEF";
+    const size_t bytesPerLine = 10;
+
+    // "\t" and "\n" per line plus "0xXX, " per byte
+    const size_t lines = (size + bytesPerLine - 1) / bytesPerLine;
+    std::string text(lines * 2 + size * 6, ' ');
+    char* out = &text[0];
+    for (size_t i = 0; i < size; ++i) {
+        if (i % bytesPerLine == 0)
+            *out++ = '\t';
+
+        const unsigned char byte = static_cast<unsigned char>(data[i]);
+        out[0] = '0';
+        out[1] = 'x';
+        out[2] = digits[byte >> 4];
+        out[3] = digits[byte & 0x0F];
+        out[4] = ',';
+        out += 6; // Keeps the trailing space
+
+        if (i % bytesPerLine == bytesPerLine - 1 || i + 1 == size)
+            *out++ = '\n';
+    }
+    return wxString::FromAscii(text.data(), text.size());
+}
+
+wxString FileToCArray::GetIncludePath(const wxString& sourcePath, PObjectBase project)
+{
+    const wxString targetFullName = wxFileName(sourcePath).GetFullName() + ".h";
+    if (!wxFileName::FileExists(sourcePath))
+        return targetFullName;
+
+    wxString outputPath;
+    wxString embeddedFilesOutputPath;
+    try {
+        outputPath = AppData()->GetOutputPath(project);
+        embeddedFilesOutputPath = AppData()->GetEmbeddedFilesOutputPath(project);
+    } catch (wxWeaverException&) {
+        return targetFullName;
+    }
+    return TypeConv::MakeRelativePath(embeddedFilesOutputPath + targetFullName, outputPath);
+}
+
+void FileToCArray::GenerateAll(const std::set<wxString>& sourcePaths, PObjectBase project)
+{
+    // One header per source file, each written by a single worker
+    const std::vector<wxString> sources(sourcePaths.begin(), sourcePaths.end());
+    std::atomic<size_t> next(0);
+    DependencyTracker* tracker = DependencyTracker::Get();
+    wxString projectFile;
+    PObjectBase threadProject = ApplicationData::GetThreadProject(&projectFile);
+    auto worker = [&sources, &next, project, tracker, threadProject, &projectFile]() {
+        // The output paths are relative to the project of the calling thread
+        ApplicationData::SetThreadProject(threadProject, projectFile);
+        DependencyTracker::Scope scope(tracker);
+        for (size_t i = next++; i < sources.size(); i = next++) {
+            try {
+                Generate(sources[i], project);
+            } catch (wxWeaverException& ex) {
+                wxLogError(ex.what());
+            }
+        }
+    };
+    const size_t jobs = std::max<size_t>(
+        1, std::min<size_t>(std::thread::hardware_concurrency(), sources.size()));
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < jobs; ++i)
+        threads.emplace_back(worker);
+
+    worker();
+    for (std::thread& thread : threads)
+        thread.join();
+
+    // Messages logged by the workers, on a worker thread itself (e.g. the
+    // code preview) they are left to the main thread
+    if (wxThread::IsMain())
+        wxLog::FlushActive();
+}
+
+bool FileToCArray::Generate(const wxString& sourcePath, PObjectBase project)
 {
     wxFileName sourceFileName(sourcePath);
-    const wxString& sourceFullName = sourceFileName.GetFullName();
-    const wxString targetFullName = sourceFullName + ".h";
+    const wxString targetFullName = sourceFileName.GetFullName() + ".h";
     wxString arrayName = CppCodeGenerator::ConvertEmbeddedBitmapName(sourcePath);
 
     if (!sourceFileName.FileExists()) {
         wxLogWarning(sourcePath + " does not exist");
-        return targetFullName;
+        return false;
     }
-    PObjectBase project = AppData()->GetProjectData();
-
     // Get the output path
-    wxString outputPath;
     wxString embeddedFilesOutputPath;
     try {
-        outputPath = AppData()->GetOutputPath();
-        embeddedFilesOutputPath = AppData()->GetEmbeddedFilesOutputPath();
+        embeddedFilesOutputPath = AppData()->GetEmbeddedFilesOutputPath(project);
     } catch (wxWeaverException& ex) {
         wxLogWarning(ex.what());
-        return targetFullName;
+        return false;
     }
     // Determine if Microsoft BOM should be used
     bool useMicrosoftBOM = false;
@@ -109,60 +212,94 @@ wxString FileToCArray::Generate(const wxString& sourcePath)
     if (pUseUtf8)
         useUtf8 = (pUseUtf8->GetValueAsString() != "ANSI");
 
-    // setup output file
-    PCodeWriter arrayCodeWriter(
-        new FileCodeWriter(
-            embeddedFilesOutputPath + targetFullName, useMicrosoftBOM, useUtf8));
-
-    const wxString headerGuardName = arrayName.Upper() + "_H";
-    arrayCodeWriter->WriteLn("#ifndef " + headerGuardName);
-    arrayCodeWriter->WriteLn("#define " + headerGuardName);
-    arrayCodeWriter->WriteLn();
-    arrayCodeWriter->WriteLn("#include <wx/mstream.h>");
-    arrayCodeWriter->WriteLn("#include <wx/image.h>");
-    arrayCodeWriter->WriteLn("#include <wx/bitmap.h>");
-    arrayCodeWriter->WriteLn();
-    arrayCodeWriter->WriteLn("static const unsigned char " + arrayName + "[] = ");
-    arrayCodeWriter->WriteLn("{");
-    arrayCodeWriter->Indent();
-
-    unsigned int count = 1;
-    const unsigned int bytesPerLine = 10;
-    std::ifstream binFile(
-        static_cast<const char*>(sourcePath.mb_str(wxConvFile)), std::ios::binary);
-
-    for (std::istreambuf_iterator<char> byte(binFile), end; byte != end; ++byte, ++count) {
-        arrayCodeWriter->Write(
-            wxString::Format(
-                "0x%02X, ", static_cast<unsigned int>(static_cast<unsigned char>(*byte))));
-
-        if (count >= bytesPerLine) {
-            arrayCodeWriter->WriteLn();
-            count = 0;
-        }
+    const wxString targetPath = embeddedFilesOutputPath + targetFullName;
+    DependencyTracker::AddInput(sourcePath);
+    DependencyTracker::AddOutput(targetPath);
+
+    const wxString bitmapType = GetBitmapType(sourceFileName);
+    uint64_t settings = FileUtils::HashString(targetPath);
+    settings = FileUtils::HashString(arrayName, settings);
+    settings = FileUtils::HashString(bitmapType, settings);
+    settings = FileUtils::HashString(
+        wxString::Format("%d %d", useMicrosoftBOM ? 1 : 0, useUtf8 ? 1 : 0), settings);
+
+    // Skip the source files unchanged since their header was written,
+    // without even reading them while their time stamp is the same
+    EmittedFile emitted;
+    {
+        std::lock_guard<std::mutex> lock(s_emittedFilesMutex);
+        auto it = s_emittedFiles.find(targetPath);
+        if (it != s_emittedFiles.end())
+            emitted = it->second;
+    }
+    EmittedFile current;
+    if (!FileUtils::GetFileStamp(sourcePath, &current.sourceSize, &current.sourceTime)) {
+        wxLogWarning("Unable to read " + sourcePath);
+        return false;
     }
-    if ((count < bytesPerLine) && (count != 1))
+    const bool targetUnchanged
+        = FileUtils::GetFileStamp(targetPath, &current.targetSize, &current.targetTime)
+        && current.targetSize == emitted.targetSize && current.targetTime == emitted.targetTime;
+
+    if (targetUnchanged && emitted.settings == settings
+        && current.sourceSize == emitted.sourceSize
+        && current.sourceTime == emitted.sourceTime) {
+        return true;
+    }
+    std::vector<char> data;
+    if (!FileUtils::ReadFile(sourcePath, &data)) {
+        wxLogWarning("Unable to read " + sourcePath);
+        return false;
+    }
+    current.settings = settings;
+    current.contents = FileUtils::Hash(data.data(), data.size());
+    if (targetUnchanged && emitted.settings == settings
+        && emitted.contents == current.contents) {
+        std::lock_guard<std::mutex> lock(s_emittedFilesMutex);
+        s_emittedFiles[targetPath] = current;
+        return true;
+    }
+    {
+        // setup output file
+        PCodeWriter arrayCodeWriter(new FileCodeWriter(targetPath, useMicrosoftBOM, useUtf8));
+
+        const wxString headerGuardName = arrayName.Upper() + "_H";
+        arrayCodeWriter->WriteLn("#ifndef " + headerGuardName);
+        arrayCodeWriter->WriteLn("#define " + headerGuardName);
+        arrayCodeWriter->WriteLn();
+        arrayCodeWriter->WriteLn("#include <wx/mstream.h>");
+        arrayCodeWriter->WriteLn("#include <wx/image.h>");
+        arrayCodeWriter->WriteLn("#include <wx/bitmap.h>");
         arrayCodeWriter->WriteLn();
+        arrayCodeWriter->WriteLn("static const unsigned char " + arrayName + "[] = ");
+        arrayCodeWriter->WriteLn("{");
+        arrayCodeWriter->WriteFormatted(EncodeBytes(data.data(), data.size()));
+        arrayCodeWriter->WriteLn("};");
+        arrayCodeWriter->WriteLn();
+        arrayCodeWriter->WriteLn("wxBitmap& " + arrayName + "_to_wx_bitmap()");
+        arrayCodeWriter->WriteLn("{");
+        arrayCodeWriter->Indent();
+        arrayCodeWriter->WriteLn("static wxMemoryInputStream memIStream( "
+                                 + arrayName + ", sizeof( "
+                                 + arrayName + " ) );");
+        arrayCodeWriter->WriteLn("static wxImage image( memIStream, " + bitmapType + " );");
+        arrayCodeWriter->WriteLn("static wxBitmap bmp( image );");
+        arrayCodeWriter->WriteLn("return bmp;");
+        arrayCodeWriter->Unindent();
+        arrayCodeWriter->WriteLn("}");
+        arrayCodeWriter->WriteLn();
+        arrayCodeWriter->WriteLn();
+        arrayCodeWriter->WriteLn("#endif //" + headerGuardName);
+    }
+    // Written when the writer is destroyed
+    const bool written
+        = FileUtils::GetFileStamp(targetPath, &current.targetSize, &current.targetTime);
+
+    std::lock_guard<std::mutex> lock(s_emittedFilesMutex);
+    if (written)
+        s_emittedFiles[targetPath] = current;
+    else
+        s_emittedFiles.erase(targetPath);
 
-    arrayCodeWriter->Unindent();
-    arrayCodeWriter->WriteLn("};");
-    arrayCodeWriter->WriteLn();
-    arrayCodeWriter->WriteLn("wxBitmap& " + arrayName + "_to_wx_bitmap()");
-    arrayCodeWriter->WriteLn("{");
-    arrayCodeWriter->Indent();
-    arrayCodeWriter->WriteLn("static wxMemoryInputStream memIStream( "
-                             + arrayName + ", sizeof( "
-                             + arrayName + " ) );");
-    arrayCodeWriter->WriteLn("static wxImage image( memIStream, "
-                             + GetBitmapType(sourceFileName) + " );");
-    arrayCodeWriter->WriteLn("static wxBitmap bmp( image );");
-    arrayCodeWriter->WriteLn("return bmp;");
-    arrayCodeWriter->Unindent();
-    arrayCodeWriter->WriteLn("}");
-    arrayCodeWriter->WriteLn();
-    arrayCodeWriter->WriteLn();
-    arrayCodeWriter->WriteLn("#endif //" + headerGuardName);
-
-    return TypeConv::MakeRelativePath(
-        embeddedFilesOutputPath + targetFullName, outputPath);
+    return written;
 }
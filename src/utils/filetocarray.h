@@ -20,10 +20,33 @@
 */
 #pragma once
 
+#include "utils/defs.h"
+
 #include <wx/string.h>
 
+#include <set>
+
 class FileToCArray
 {
 public:
-    static wxString Generate( const wxString& sourcepath );
+    /** Gets the path to include for the header of @a sourcepath,
+        without writing anything.
+    */
+    static wxString GetIncludePath( const wxString& sourcepath, PObjectBase project );
+
+    /** Writes @a sourcepath as a C array to the embedded files path of
+        @a project, unless the header is up to date.
+
+        @throw wxWeaverException If the header can't be written.
+    */
+    static bool Generate( const wxString& sourcepath, PObjectBase project );
+
+    /** Writes the headers of @a sourcepaths on a pool of worker threads.
+    */
+    static void GenerateAll( const std::set<wxString>& sourcepaths, PObjectBase project );
+
+    /** Formats @a size bytes at @a data as a C array initializer,
+        ten bytes per line.
+    */
+    static wxString EncodeBytes( const char* data, size_t size );
 };
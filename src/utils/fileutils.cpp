@@ -0,0 +1,122 @@
+/*
+    wxWeaver - A GUI Designer Editor for wxWidgets.
+    Copyright (C) 2021 Andrea Zanellato <redtid3@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include "utils/fileutils.h"
+
+#include <wx/file.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+#include <wx/log.h>
+#include <wx/utils.h>
+
+#include <atomic>
+#include <cstdlib>
+
+#ifdef __UNIX__
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+std::atomic<unsigned> s_tempFileCounter(0);
+} // namespace
+
+uint64_t FileUtils::Hash(const void* data, size_t size, uint64_t hash)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+bool FileUtils::ReadFile(const wxString& file, std::vector<char>* data)
+{
+    wxFile in;
+    if (!in.Open(file, wxFile::read))
+        return false;
+
+    const wxFileOffset length = in.Length();
+    if (length == wxInvalidOffset)
+        return false;
+
+    data->resize(static_cast<size_t>(length));
+    return length == 0
+        || in.Read(data->data(), data->size()) == static_cast<ssize_t>(length);
+}
+
+bool FileUtils::GetFileStamp(const wxString& file, uint64_t* size, int64_t* time)
+{
+    wxFileName fileName(file);
+    const wxULongLong fileSize = fileName.GetSize();
+    const wxDateTime modTime = fileName.GetModificationTime();
+    if (fileSize == wxInvalidSize || !modTime.IsValid())
+        return false;
+
+    *size = fileSize.GetValue();
+    *time = modTime.GetValue().GetValue();
+    return true;
+}
+
+bool FileUtils::WriteFileAtomically(const void* data, size_t size, const wxString& path)
+{
+    wxString target = path;
+#ifdef __UNIX__
+    // Replace the file a link points to, not the link
+    if (char* resolved = realpath(path.fn_str(), nullptr)) {
+        target = wxString(resolved, wxConvFile);
+        free(resolved);
+    }
+    struct stat original;
+    const bool exists = (stat(target.fn_str(), &original) == 0);
+#endif
+    // Unique in this process and among processes, so concurrent writers
+    // of the same file never share the temporary file
+    const wxString tempFile = wxString::Format("%s.%lu-%u.tmp", target, wxGetProcessId(),
+                                               s_tempFileCounter++);
+    {
+        wxFile out;
+        if (!out.Create(tempFile, true))
+            return false;
+
+        bool written = (out.Write(data, size) == size);
+#ifdef __UNIX__
+        // The replacement keeps the permissions and, when allowed, the owner:
+        // changing the owner needs privileges, the group a membership of it
+        if (written && exists) {
+            if (fchown(out.fd(), original.st_uid, original.st_gid) != 0
+                && fchown(out.fd(), static_cast<uid_t>(-1), original.st_gid) != 0)
+                wxLogDebug("Unable to keep the owner of %s", target);
+
+            written = (fchmod(out.fd(), original.st_mode & 07777) == 0);
+        }
+#endif
+        // wxFile::Flush() also syncs the file to the disk where supported
+        if (!written || !out.Flush()) {
+            out.Close();
+            wxRemoveFile(tempFile);
+            return false;
+        }
+    }
+    if (!wxRenameFile(tempFile, target, true)) {
+        wxRemoveFile(tempFile);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,80 @@
+/*
+    wxWeaver - A GUI Designer Editor for wxWidgets.
+    Copyright (C) 2021 Andrea Zanellato <redtid3@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#pragma once
+
+#include <wx/string.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace FileUtils {
+/** Initial value of the hashes computed by Hash().
+*/
+const uint64_t HashBasis = 14695981039346656037ULL;
+
+/** Computes a 64-bit FNV-1a hash of @a size bytes at @a data.
+
+    Used to detect unchanged output, it is not meant to be cryptographic.
+    Pass the result of a previous call as @a hash to hash several blocks.
+*/
+uint64_t Hash(const void* data, size_t size, uint64_t hash = HashBasis);
+
+inline uint64_t Hash(const std::string& data, uint64_t hash = HashBasis)
+{
+    return Hash(data.data(), data.size(), hash);
+}
+
+/** Adds the length and the characters of @a str to @a hash,
+    so that consecutive strings can't be mistaken for each other.
+*/
+inline uint64_t HashString(const wxString& str, uint64_t hash = HashBasis)
+{
+    const size_t length = str.length();
+    hash = Hash(&length, sizeof(length), hash);
+    return Hash(str.wc_str(), length * sizeof(wchar_t), hash);
+}
+
+/** Reads the whole contents of @a file into @a data.
+*/
+bool ReadFile(const wxString& file, std::vector<char>* data);
+
+/** Gets the size and the modification time (ms) of @a file.
+
+    @return false if the file does not exist.
+*/
+bool GetFileStamp(const wxString& file, uint64_t* size, int64_t* time);
+
+/** Replaces @a path with @a size bytes at @a data.
+
+    The data is written to a uniquely named temporary file next to @a path,
+    flushed to the disk and then renamed over @a path, so readers and crashes
+    only ever see either the old or the new contents. On Unix the permissions
+    and, as far as allowed, the owner of an existing @a path are kept and
+    links are followed.
+
+    @return false if any of the steps failed, @a path is left untouched.
+*/
+bool WriteFileAtomically(const void* data, size_t size, const wxString& path);
+
+inline bool WriteFileAtomically(const std::string& data, const wxString& path)
+{
+    return WriteFileAtomically(data.data(), data.size(), path);
+}
+} // namespace FileUtils
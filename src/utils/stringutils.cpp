@@ -272,6 +272,20 @@ void XMLUtils::LoadXMLFile(TiXmlDocument& doc, bool condenseWhiteSpace, const wx
     LoadXMLFileImp(doc, condenseWhiteSpace, path, declaration);
 }
 
+std::string XMLUtils::PrintDocument(ticpp::Document& doc)
+{
+    // SaveFile() prints with this indentation to a file opened in text mode
+    TiXmlPrinter printer;
+    printer.SetIndent("    ");
+#ifdef __WXMSW__
+    printer.SetLineBreak("\r\n");
+#else
+    printer.SetLineBreak("\n");
+#endif
+    doc.Accept(&printer);
+    return printer.Str();
+}
+
 void XMLUtils::ConvertAndAddDeclaration(const wxString& path,
                                         wxFontEncoding encoding, bool backup)
 {
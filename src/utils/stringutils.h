@@ -22,6 +22,8 @@
 
 #include <wx/string.h>
 
+#include <string>
+
 namespace ticpp {
 class Document;
 }
@@ -49,6 +51,11 @@ void LoadXMLFile(ticpp::Document& doc, bool condenseWhiteSpace,
 void LoadXMLFile(TiXmlDocument& doc, bool condenseWhiteSpace,
                  const wxString& path = wxEmptyString);
 
+/** Prints @a doc exactly as TiXmlDocument::SaveFile() writes it,
+    including the platform line breaks, without writing a file.
+*/
+std::string PrintDocument(ticpp::Document& doc);
+
 // Converts to UTF-8 and prepends declaration
 void ConvertAndAddDeclaration(const wxString& path,
                               wxFontEncoding encoding = wxFONTENCODING_SYSTEM,
@@ -313,7 +313,35 @@ wxString TypeConv::FontWeightToString(wxFontWeight weight)
 {
     wxString result;
 
+#if wxCHECK_VERSION(3, 1, 2)
+    // Numeric weights are named after the closest weight, as wxFont does
+    if (weight > 0)
+        weight = wxFontInfo::GetWeightClosestToNumericValue(weight);
+#endif
     switch (weight) {
+#if wxCHECK_VERSION(3, 1, 2)
+    case wxFONTWEIGHT_THIN:
+        result = "wxFONTWEIGHT_THIN";
+        break;
+    case wxFONTWEIGHT_EXTRALIGHT:
+        result = "wxFONTWEIGHT_EXTRALIGHT";
+        break;
+    case wxFONTWEIGHT_MEDIUM:
+        result = "wxFONTWEIGHT_MEDIUM";
+        break;
+    case wxFONTWEIGHT_SEMIBOLD:
+        result = "wxFONTWEIGHT_SEMIBOLD";
+        break;
+    case wxFONTWEIGHT_EXTRABOLD:
+        result = "wxFONTWEIGHT_EXTRABOLD";
+        break;
+    case wxFONTWEIGHT_HEAVY:
+        result = "wxFONTWEIGHT_HEAVY";
+        break;
+    case wxFONTWEIGHT_EXTRAHEAVY:
+        result = "wxFONTWEIGHT_EXTRAHEAVY";
+        break;
+#endif
     case wxFONTWEIGHT_LIGHT:
         result = "wxFONTWEIGHT_LIGHT";
         break;
@@ -0,0 +1,139 @@
+/*
+    wxWeaver - A GUI Designer Editor for wxWidgets.
+    Copyright (C) 2021 Andrea Zanellato <redtid3@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include "watcher.h"
+
+#include "generator.h"
+
+#include <wx/app.h>
+#include <wx/datetime.h>
+#include <wx/filename.h>
+#include <wx/fswatcher.h>
+#include <wx/log.h>
+
+#include <iostream>
+
+ProjectWatcher::ProjectWatcher(const wxArrayString& files, const wxString& languages,
+                               unsigned jobs, unsigned dependencyFiles)
+    : m_timer(this)
+    , m_languages(languages)
+    , m_jobs(jobs)
+    , m_dependencyFiles(dependencyFiles)
+{
+    for (const wxString& file : files)
+        m_files.insert(NormalizePath(file));
+
+    Bind(wxEVT_FSWATCHER, &ProjectWatcher::OnFileSystemEvent, this);
+    Bind(wxEVT_TIMER, &ProjectWatcher::OnTimer, this, m_timer.GetId());
+}
+
+ProjectWatcher::~ProjectWatcher()
+{
+    m_timer.Stop();
+}
+
+int ProjectWatcher::Run()
+{
+    // The file system watcher can only be created once the event loop runs
+    CallAfter(&ProjectWatcher::Start);
+    wxAppConsole::GetInstance()->MainLoop();
+
+    return m_watcher ? 0 : 8;
+}
+
+void ProjectWatcher::Start()
+{
+    wxArrayString files;
+    for (const wxString& file : m_files)
+        files.Add(file);
+
+    ProjectGenerator::RunBatch(files, m_languages, m_jobs, m_dependencyFiles);
+
+    /*
+        Watch the directories instead of the files: most editors save
+        by replacing the file, which would end a watch on the file itself.
+    */
+    m_watcher.reset(new wxFileSystemWatcher);
+    m_watcher->SetOwner(this);
+
+    std::set<wxString> directories;
+    for (const wxString& file : m_files) {
+        const wxString directory = wxFileName(file).GetPath();
+        if (!directories.insert(directory).second)
+            continue;
+
+        if (!m_watcher->Add(wxFileName::DirName(directory),
+                            wxFSW_EVENT_CREATE | wxFSW_EVENT_MODIFY | wxFSW_EVENT_RENAME)) {
+            wxLogError("Unable to watch the directory %s", directory);
+            wxLog::FlushActive();
+            m_watcher.reset();
+            wxAppConsole::GetInstance()->ExitMainLoop();
+            return;
+        }
+    }
+    std::cout << wxString::Format("Watching %zu projects, press Ctrl+C to stop",
+                                  m_files.size())
+                     .utf8_str()
+              << std::endl;
+}
+
+void ProjectWatcher::OnFileSystemEvent(wxFileSystemWatcherEvent& event)
+{
+    if (event.GetChangeType() == wxFSW_EVENT_WARNING
+        || event.GetChangeType() == wxFSW_EVENT_ERROR) {
+        wxLogWarning(event.GetErrorDescription());
+        return;
+    }
+    // A renamed file is relevant by its new name, saved through a temporary file
+    const wxFileName& path = event.GetChangeType() == wxFSW_EVENT_RENAME
+        ? event.GetNewPath()
+        : event.GetPath();
+
+    const wxString file = NormalizePath(path.GetFullPath());
+    if (m_files.find(file) == m_files.end())
+        return;
+
+    m_changed.insert(file);
+    m_timer.StartOnce(Delay);
+}
+
+void ProjectWatcher::OnTimer(wxTimerEvent&)
+{
+    wxArrayString files;
+    for (const wxString& file : m_changed) {
+        if (wxFileName::FileExists(file))
+            files.Add(file);
+    }
+    m_changed.clear();
+    if (files.empty())
+        return;
+
+    std::cout << wxString::Format("%s: regenerating %zu changed project(s)",
+                                  wxDateTime::Now().FormatISOTime(), files.size())
+                     .utf8_str()
+              << std::endl;
+
+    ProjectGenerator::RunBatch(files, m_languages, m_jobs, m_dependencyFiles);
+}
+
+wxString ProjectWatcher::NormalizePath(const wxString& path)
+{
+    wxFileName fileName(path);
+    fileName.Normalize(wxPATH_NORM_DOTS | wxPATH_NORM_ABSOLUTE | wxPATH_NORM_LONG);
+    return fileName.GetFullPath();
+}
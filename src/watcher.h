@@ -0,0 +1,67 @@
+/*
+    wxWeaver - A GUI Designer Editor for wxWidgets.
+    Copyright (C) 2021 Andrea Zanellato <redtid3@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#pragma once
+
+#include <wx/arrstr.h>
+#include <wx/event.h>
+#include <wx/timer.h>
+
+#include <memory>
+#include <set>
+
+class wxFileSystemWatcher;
+class wxFileSystemWatcherEvent;
+
+/** Regenerates the code of a set of projects whenever their files change.
+
+    The object database stays loaded between generations and only the
+    changed projects are reloaded, the file writers leave the unchanged
+    outputs untouched.
+*/
+class ProjectWatcher : public wxEvtHandler {
+public:
+    ProjectWatcher(const wxArrayString& files, const wxString& languages, unsigned jobs,
+                   unsigned dependencyFiles);
+    ~ProjectWatcher() override;
+
+    /** Generates all the projects, then runs the event loop regenerating
+        the changed ones until the process is terminated.
+
+        @return A non zero exit code if the files can't be watched.
+    */
+    int Run();
+
+private:
+    void Start();
+    void OnFileSystemEvent(wxFileSystemWatcherEvent& event);
+    void OnTimer(wxTimerEvent& event);
+
+    static wxString NormalizePath(const wxString& path);
+
+    // Editors may write a file in several steps, wait for them to settle
+    static const int Delay = 200;
+
+    std::unique_ptr<wxFileSystemWatcher> m_watcher;
+    wxTimer m_timer;
+    std::set<wxString> m_files;
+    std::set<wxString> m_changed;
+    wxString m_languages;
+    unsigned m_jobs;
+    unsigned m_dependencyFiles;
+};
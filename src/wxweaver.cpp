@@ -25,6 +25,10 @@
 #include "utils/exception.h"
 #include "utils/typeconv.h"
 #include "appdata.h"
+#include "benchmark.h"
+#include "converter.h"
+#include "generator.h"
+#include "watcher.h"
 
 #include <wx/clipbrd.h>
 #include <wx/cmdline.h>
@@ -32,6 +36,10 @@
 #include <wx/stdpaths.h>
 #include <wx/sysopt.h>
 
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
 #if wxVERSION_NUMBER >= 2905 && wxVERSION_NUMBER <= 3100
 #include <wx/xrc/xh_auinotbk.h>
 #elif wxVERSION_NUMBER > 3100
@@ -62,21 +70,254 @@ EXCEPTION_DISPOSITION StructuredExceptionHandler(struct _EXCEPTION_RECORD* Excep
 void LogStack();
 
 static const wxCmdLineEntryDesc s_cmdLineDesc[] = {
-    { wxCMD_LINE_SWITCH, "g", "generate", "Generate code from passed file.", wxCMD_LINE_VAL_STRING,
-      0 },
+    { wxCMD_LINE_SWITCH, "g", "generate",
+      "Generate code from the passed project files. Wildcards and @file arguments, "
+      "listing one project per line, are accepted.",
+      wxCMD_LINE_VAL_STRING, 0 },
+    { wxCMD_LINE_SWITCH, "w", "watch",
+      "Generate code from the passed project files, then keep running and regenerate "
+      "each project whenever its file changes.",
+      wxCMD_LINE_VAL_STRING, 0 },
     { wxCMD_LINE_OPTION, "l", "language",
       "Override the code_generation property from the passed file and generate the passed "
       "languages. Separate multiple languages with commas.",
       wxCMD_LINE_VAL_STRING, 0 },
+    { wxCMD_LINE_SWITCH, "c", "convert",
+      "Convert the passed project files to the current file format and exit. "
+      "Wildcards and @file arguments, listing one project per line, are accepted.",
+      wxCMD_LINE_VAL_STRING, 0 },
+    { wxCMD_LINE_OPTION, "j", "jobs",
+      "Number of parallel jobs used by --convert and by --generate or --watch with "
+      "multiple projects, defaults to the number of CPUs.",
+      wxCMD_LINE_VAL_NUMBER, 0 },
+    { wxCMD_LINE_SWITCH, nullptr, "depfile",
+      "With --generate or --watch, also write a Makefile rule listing the generated "
+      "files and their inputs to <file>.d next to the generated code.",
+      wxCMD_LINE_VAL_STRING, 0 },
+    { wxCMD_LINE_SWITCH, nullptr, "json-manifest",
+      "With --generate or --watch, also write the generated files and their inputs "
+      "to <file>.deps.json next to the generated code.",
+      wxCMD_LINE_VAL_STRING, 0 },
+    { wxCMD_LINE_SWITCH, "b", "benchmark",
+      "Measure the code generators on a project synthesised from the registered components.",
+      wxCMD_LINE_VAL_STRING, 0 },
+    { wxCMD_LINE_OPTION, nullptr, "benchmark-size",
+      "Size of the --benchmark project, e.g. "
+      "\"forms=10,widgets=50,depth=3,bitmaps=20,events=20,iterations=7\".",
+      wxCMD_LINE_VAL_STRING, 0 },
     { wxCMD_LINE_SWITCH, "h", "help", "Show this help message.", wxCMD_LINE_VAL_STRING,
       wxCMD_LINE_OPTION_HELP },
     { wxCMD_LINE_SWITCH, "v", "version", "Print version information.", wxCMD_LINE_VAL_STRING, 0 },
     { wxCMD_LINE_PARAM, nullptr, nullptr, "File to open.", wxCMD_LINE_VAL_STRING,
-      wxCMD_LINE_PARAM_OPTIONAL },
+      wxCMD_LINE_PARAM_OPTIONAL | wxCMD_LINE_PARAM_MULTIPLE },
     { wxCMD_LINE_NONE, nullptr, nullptr, nullptr, wxCMD_LINE_VAL_NONE, 0 }
 };
 
+namespace {
+/** Switches running a command line operation, that doesn't need the GUI.
+*/
+const char* const s_headlessSwitches[] = {
+    "-g", "--generate", "-w", "--watch", "-c", "--convert", "-b", "--benchmark",
+    "-v", "--version", "-h", "--help"
+};
+
+/** Sets up the application name, configuration and log target.
+
+    @return The data directory, which is also made the working directory.
+*/
+wxString SetupApp()
+{
+    wxAppConsole* app = wxAppConsole::GetInstance();
+
+    // Using a space so the initial 'w' will not be capitalized in dialogs
+    app->SetAppName(" wxWeaver");
+
+    // Creating the wxConfig manually so there will be no space
+    // The old config (if any) is returned, delete it
+    delete wxConfigBase::Set(new wxConfig("wxWeaver"));
+
+    // Get the data directory
+    wxStandardPathsBase& stdPaths = wxStandardPaths::Get();
+    wxString dataDir = stdPaths.GetDataDir();
+    dataDir.Replace(app->GetAppName().c_str(), "wxweaver");
+
+    // Log to stderr while working on the command line
+    delete wxLog::SetActiveTarget(new wxLogStderr);
+#if 0
+    // Message output to the same as the log target
+    delete wxMessageOutput::Set(new wxMessageOutputLog);
+#endif
+    // Help to load locale if wxWeaver is not installed in system
+    ::wxSetWorkingDirectory(dataDir);
+
+    return dataDir;
+}
+
+/** Loads the plugins and the object database without bitmaps.
+*/
+bool InitHeadless(const wxString& dataDir)
+{
+    // Not a GUI call: the embedded files name their bitmap type by handler
+    wxInitAllImageHandlers();
+
+    AppDataCreate(dataDir);
+    try {
+        AppDataInitHeadless();
+    } catch (wxWeaverException& ex) {
+        wxLogError("Error loading application: %s\n cannot continue.", ex.what());
+        wxLog::FlushActive();
+        return false;
+    }
+    return true;
+}
+
+bool IsHeadlessRun(const wxCmdLineParser& parser)
+{
+    return parser.Found("v") || parser.Found("c") || parser.Found("g") || parser.Found("w")
+        || parser.Found("b");
+}
+
+/** Runs the command line operations.
+
+    Nothing here may need a display: the object database is loaded without
+    bitmaps and the generators write the files directly, so it also works
+    from wxWeaverConsole.
+*/
+int RunHeadless(const wxCmdLineParser& parser, const wxString& dataDir,
+                const wxString& launchDir)
+{
+    if (parser.Found("v")) {
+        std::cout << "wxWeaver " << VERSION << REVISION << '\n';
+        return EXIT_SUCCESS;
+    }
+
+    if (parser.Found("b")) {
+        CodeGenBenchmark::Settings settings;
+        wxString size;
+        if (parser.Found("benchmark-size", &size)
+            && !CodeGenBenchmark::ParseSettings(size, &settings))
+            return 2;
+
+        if (!InitHeadless(dataDir))
+            return 5;
+
+        return CodeGenBenchmark::Run(settings) ? 0 : 7;
+    }
+    wxArrayString args;
+    for (size_t i = 0; i < parser.GetParamCount(); ++i)
+        args.Add(parser.GetParam(i));
+
+    const wxArrayString files = ProjectConverter::ExpandFileList(args, launchDir);
+    long jobs = 0;
+    if (!parser.Found("j", &jobs) || jobs < 1)
+        jobs = std::max(1u, std::thread::hardware_concurrency());
+
+    if (parser.Found("c")) {
+        if (files.empty()) {
+            wxLogError("You must pass the project files to convert.");
+            return 2;
+        }
+        // Conversion only needs the file version, skip loading plugins and bitmaps
+        AppDataCreate(dataDir);
+        size_t failed = ProjectConverter::Run(files, static_cast<unsigned>(jobs));
+        return failed ? 7 : 0;
+    }
+    if (files.empty()) {
+        wxLogError("You must pass a path to a project file. Nothing to generate.");
+        return 2;
+    }
+    wxString codeLanguage;
+    bool hasLanguage = parser.Found("l", &codeLanguage);
+    if (hasLanguage) {
+        if (codeLanguage.empty()) {
+            wxLogError("Empty language option. Nothing generated.");
+            return 3;
+        }
+        codeLanguage.Replace(",", "|", true);
+    }
+    unsigned dependencyFiles = ProjectGenerator::NoDependencyFiles;
+    if (parser.Found("depfile"))
+        dependencyFiles |= ProjectGenerator::Depfile;
+    if (parser.Found("json-manifest"))
+        dependencyFiles |= ProjectGenerator::JsonManifest;
+
+    // Plugins and the object database are loaded once for all the projects
+    if (!InitHeadless(dataDir))
+        return 5;
+
+    if (parser.Found("w")) {
+        ProjectWatcher watcher(files, codeLanguage, static_cast<unsigned>(jobs),
+                               dependencyFiles);
+        return watcher.Run();
+    }
+    if (files.size() > 1) {
+        size_t failed = ProjectGenerator::RunBatch(files, codeLanguage,
+                                                   static_cast<unsigned>(jobs),
+                                                   dependencyFiles);
+        return failed ? 7 : 0;
+    }
+    const wxString& projectToLoad = files[0];
+    if (!AppData()->LoadProject(projectToLoad, true)) {
+        wxLogError("Unable to load project: %s", projectToLoad);
+        return 6;
+    }
+    PObjectBase project = AppData()->GetProjectData();
+    if (hasLanguage) {
+        PProperty codeGen = project->GetProperty("code_generation");
+        if (codeGen)
+            codeGen->SetValue(codeLanguage);
+    }
+    size_t failed = ProjectGenerator::Run(project, dependencyFiles);
+    return failed ? 7 : 0;
+}
+} // namespace
+
+#ifdef __WXMSW__
 wxIMPLEMENT_APP(wxWeaver);
+#else
+wxIMPLEMENT_WX_THEME_SUPPORT
+wxIMPLEMENT_APP_NO_MAIN(wxWeaver);
+
+int main(int argc, char** argv)
+{
+    // Initializing the GUI needs a display, which the command line
+    // operations don't use: run them from a console application instead.
+    for (int i = 1; i < argc; ++i) {
+        for (const char* headlessSwitch : s_headlessSwitches) {
+            if (std::strcmp(argv[i], headlessSwitch) == 0) {
+                wxApp::SetInstance(new wxWeaverConsole);
+                return wxEntry(argc, argv);
+            }
+        }
+    }
+    return wxEntry(argc, argv);
+}
+#endif
+
+int wxWeaverConsole::OnRun()
+{
+    // Relative paths passed on the command line refer to this directory
+    const wxString launchDir = wxGetCwd();
+    const wxString dataDir = SetupApp();
+
+    wxCmdLineParser parser(s_cmdLineDesc, argc, argv);
+    if (parser.Parse())
+        return 1;
+
+    if (!IsHeadlessRun(parser)) {
+        parser.Usage();
+        return 1;
+    }
+    return RunHeadless(parser, dataDir, launchDir);
+}
+
+int wxWeaverConsole::OnExit()
+{
+    MacroDictionary::Destroy();
+    AppDataDestroy();
+
+    return wxAppConsole::OnExit();
+}
 
 int wxWeaver::OnRun()
 {
@@ -104,26 +345,9 @@ int wxWeaver::OnRun()
                  : "r"(&ex));
 #endif
 #endif
-    // Using a space so the initial 'w' will not be capitalized in dialogs
-    wxApp::SetAppName(" wxWeaver");
-
-    // Creating the wxConfig manually so there will be no space
-    // The old config (if any) is returned, delete it
-    delete wxConfigBase::Set(new wxConfig("wxWeaver"));
-
-    // Get the data directory
-    wxStandardPathsBase& stdPaths = wxStandardPaths::Get();
-    wxString dataDir = stdPaths.GetDataDir();
-    dataDir.Replace(GetAppName().c_str(), "wxweaver");
-
-    // Log to stderr while working on the command line
-    delete wxLog::SetActiveTarget(new wxLogStderr);
-#if 0
-    // Message output to the same as the log target
-    delete wxMessageOutput::Set(new wxMessageOutputLog);
-#endif
-    // Help to load locale if wxWeaver is not installed in system
-    ::wxSetWorkingDirectory(dataDir);
+    // Relative paths passed on the command line refer to this directory
+    const wxString launchDir = wxGetCwd();
+    const wxString dataDir = SetupApp();
 
     bool enabled;
     int selection;
@@ -163,38 +387,16 @@ int wxWeaver::OnRun()
     if (parser.Parse())
         return 1;
 
-    if (parser.Found("v")) {
-        std::cout << "wxWeaver " << VERSION << REVISION << '\n';
-        return EXIT_SUCCESS;
-    }
+    if (IsHeadlessRun(parser))
+        return RunHeadless(parser, dataDir, launchDir);
 
     // Get project to load
     wxString projectToLoad = wxEmptyString;
     if (parser.GetParamCount() > 0)
         projectToLoad = parser.GetParam();
-
-    bool justGenerate = false;
-    wxString codeLanguage;
-    bool hasLanguage = parser.Found("l", &codeLanguage);
-    if (parser.Found("g")) {
-        if (projectToLoad.empty()) {
-            wxLogError("You must pass a path to a project file. Nothing to generate.");
-            return 2;
-        }
-        if (hasLanguage) {
-            if (codeLanguage.empty()) {
-                wxLogError("Empty language option. Nothing generated.");
-                return 3;
-            }
-            codeLanguage.Replace(",", "|", true);
-        }
-        // generate code
-        justGenerate = true;
 #if 0
-    } else {
-        delete wxLog::SetActiveTarget(new wxLogGui);
+    delete wxLog::SetActiveTarget(new wxLogGui);
 #endif
-    }
     // Create singleton AppData, wait to initialize until sure
     // that this is not the second instance of a project file.
     AppDataCreate(dataDir);
@@ -208,7 +410,7 @@ int wxWeaver::OnRun()
             }
 
             if (!projectPath.IsAbsolute()) {
-                if (!projectPath.MakeAbsolute()) {
+                if (!projectPath.MakeAbsolute(launchDir)) {
                     wxWEAVER_THROW_EX("Could not make path absolute: " << projectToLoad);
                 }
             }
@@ -218,7 +420,7 @@ int wxWeaver::OnRun()
         wxLogError(ex.what());
     }
     // If the project is already loaded in another instance, switch to that instance and quit
-    if (!projectToLoad.empty() && !justGenerate) {
+    if (!projectToLoad.empty()) {
         if (::wxFileExists(projectToLoad)) {
             if (!AppData()->VerifySingleInstance(projectToLoad))
                 return 4;
@@ -247,10 +449,8 @@ int wxWeaver::OnRun()
     wxYield();
 
     m_frame = new MainFrame();
-    if (!justGenerate) {
-        m_frame->Show();
-        SetTopWindow(m_frame);
-    }
+    m_frame->Show();
+    SetTopWindow(m_frame);
 /*
     This is not necessary for wxWeaver to work.
     However, Windows sets the Current Working Directory to the directory
@@ -262,27 +462,13 @@ int wxWeaver::OnRun()
     ::wxSetWorkingDirectory(dataDir);
 #endif
     if (!projectToLoad.empty()) {
-        if (AppData()->LoadProject(projectToLoad, justGenerate)) {
-            if (justGenerate) {
-                if (hasLanguage) {
-                    PObjectBase project = AppData()->GetProjectData();
-                    PProperty codeGen = project->GetProperty("code_generation");
-                    if (codeGen)
-                        codeGen->SetValue(language);
-                }
-                AppData()->GenerateCode(false, true);
-                return 0;
-            } else {
-                m_frame->InsertRecentProject(projectToLoad);
-                return wxApp::OnRun();
-            }
+        if (AppData()->LoadProject(projectToLoad)) {
+            m_frame->InsertRecentProject(projectToLoad);
+            return wxApp::OnRun();
         } else {
             wxLogError("Unable to load project: %s", projectToLoad.c_str());
         }
     }
-    if (justGenerate)
-        return 6;
-
     AppData()->NewProject();
 
 #ifdef __WXOSX__
@@ -303,11 +489,6 @@ bool wxWeaver::OnInit()
     return true;
 }
 
-bool wxWeaver::AddPluginLocaleCatalog(const wxString& catalog)
-{
-    return m_locale.AddCatalog(catalog);
-}
-
 int wxWeaver::OnExit()
 {
     MacroDictionary::Destroy();
@@ -36,9 +36,6 @@ public:
     wxString m_mac_file_name;
     void MacOpenFile(const wxString& fileName) override;
 #endif
-    /** Add locale support from a component
-    */
-    bool AddPluginLocaleCatalog(const wxString&);
 
 private:
     void SelectLanguage(int language);
@@ -47,4 +44,13 @@ private:
     wxLocale m_locale;
 };
 
+/** Application running the command line operations (--generate, --convert),
+    it doesn't initialize the GUI toolkit so no display is needed.
+*/
+class wxWeaverConsole : public wxAppConsole {
+public:
+    int OnRun() override;
+    int OnExit() override;
+};
+
 wxDECLARE_APP(wxWeaver);
@@ -24,6 +24,103 @@
 #include "utils/typeconv.h"
 #include "rtti/objectbase.h"
 
+#include <wx/tokenzr.h>
+
+#include <algorithm>
+#include <map>
+
+namespace {
+enum class XrcValue {
+    Integer, // Any integer, stored normalized
+    BitList, // Identifiers separated by '|'
+    Size,    // "width,height" in pixels
+    Text,    // Text without escape sequences or mnemonics
+    Pair     // "first,second" split into two integer properties
+};
+
+struct XrcProperty {
+    const char* xrcName;
+    const char* name;
+    const char* secondName; // Only used by XrcValue::Pair
+    XrcValue type;
+};
+
+/** Properties of the classes imported without the layout plugin,
+    matching what their ImportFromXrc() would produce.
+*/
+const std::map<std::string, std::vector<XrcProperty>>& GetFastPathClasses()
+{
+    static const std::map<std::string, std::vector<XrcProperty>> classes = {
+        { "sizeritem",
+          { { "option", "proportion", nullptr, XrcValue::Integer },
+            { "flag", "flag", nullptr, XrcValue::BitList },
+            { "border", "border", nullptr, XrcValue::Integer } } },
+        { "gbsizeritem",
+          { { "cellpos", "row", "column", XrcValue::Pair },
+            { "cellspan", "rowspan", "colspan", XrcValue::Pair },
+            { "flag", "flag", nullptr, XrcValue::BitList },
+            { "border", "border", nullptr, XrcValue::Integer } } },
+        { "wxBoxSizer",
+          { { "minsize", "minsize", nullptr, XrcValue::Size },
+            { "orient", "orient", nullptr, XrcValue::Text } } },
+        { "wxWrapSizer",
+          { { "minsize", "minsize", nullptr, XrcValue::Size },
+            { "orient", "orient", nullptr, XrcValue::Text },
+            { "flags", "flags", nullptr, XrcValue::BitList } } },
+        { "wxGridSizer",
+          { { "minsize", "minsize", nullptr, XrcValue::Size },
+            { "rows", "rows", nullptr, XrcValue::Integer },
+            { "cols", "cols", nullptr, XrcValue::Integer },
+            { "vgap", "vgap", nullptr, XrcValue::Integer },
+            { "hgap", "hgap", nullptr, XrcValue::Integer } } },
+    };
+    return classes;
+}
+
+bool ParseInteger(wxString text, long* value)
+{
+    text.Trim().Trim(false);
+    return !text.empty() && text.ToLong(value);
+}
+
+bool ParseIntegerPair(const wxString& text, long* first, long* second)
+{
+    return text.Find(',') != wxNOT_FOUND
+        && ParseInteger(text.BeforeFirst(','), first)
+        && ParseInteger(text.AfterFirst(','), second);
+}
+
+/** Normalizes a list of flags as the component import does: the flags are
+    trimmed and the synonyms replaced, e.g. wxGROW by wxEXPAND.
+
+    @return false if a flag is not a known macro, e.g. a synonym only known
+            to its component library, leaving the list to the component import.
+*/
+bool ParseBitList(const wxString& text, wxString* result)
+{
+    PMacroDictionary macros = MacroDictionary::GetInstance();
+    wxStringTokenizer tokens(text, "|");
+    while (tokens.HasMoreTokens()) {
+        wxString token = tokens.GetNextToken();
+        token.Trim().Trim(false);
+
+        wxString synonym;
+        if (macros->SearchSynonymous(token, synonym))
+            token = synonym;
+
+        int value;
+        if (!macros->SearchMacro(token, &value))
+            return false;
+
+        if (!result->empty())
+            *result << '|';
+
+        *result << token;
+    }
+    return !result->empty();
+}
+} // namespace
+
 PObjectBase XrcLoader::GetProject(ticpp::Document* xrcDoc)
 {
     assert(m_objDb);
@@ -112,13 +209,27 @@ PObjectBase XrcLoader::GetObject(ticpp::Element* xrcObj, PObjectBase parent)
                 "No component found for class \"%s\", found on line %i.",
                 className, xrcObj->Row());
         } else {
-            ticpp::Element* fbObj = comp->ImportFromXrc(xrcObj);
-            if (!fbObj) {
+            // Common layout classes skip the intermediate wxWeaver element
+            PropertyValues values, spacerValues;
+            const bool fastPath
+                = GetFastPathValues(xrcObj, className, &values, &spacerValues);
+            ticpp::Element* fbObj = fastPath ? nullptr : comp->ImportFromXrc(xrcObj);
+            auto create = [&](PObjectBase target) -> PObjectBase {
+                if (!fastPath)
+                    return m_objDb->CreateObject(fbObj, target);
+
+                PObjectBase item = CreateFastObject(className, values, target);
+                if (item && !spacerValues.empty())
+                    CreateFastObject("spacer", spacerValues, item);
+
+                return item;
+            };
+            if (!fastPath && !fbObj) {
                 wxLogError(
                     "ImportFromXrc returned nullptr for class \"%s\", found on line %i.",
                     className, xrcObj->Row());
             } else {
-                object = m_objDb->CreateObject(fbObj, parent);
+                object = create(parent);
                 if (!object) {
                     // Unable to create the object and add it to the parent,
                     // probably needs a sizer
@@ -134,7 +245,7 @@ PObjectBase XrcLoader::GetObject(ticpp::Element* xrcObj, PObjectBase parent)
                             sizer = sizer->GetChild(0);
 
                         if (sizer) {
-                            object = m_objDb->CreateObject(fbObj, sizer);
+                            object = create(sizer);
                             if (object) {
                                 parent->AddChild(newsizer);
                                 newsizer->SetParent(parent);
@@ -206,3 +317,110 @@ PObjectBase XrcLoader::GetObject(ticpp::Element* xrcObj, PObjectBase parent)
     }
     return object;
 }
+
+bool XrcLoader::GetFastPathValues(ticpp::Element* xrcObj, const std::string& className,
+                                  PropertyValues* values, PropertyValues* spacerValues)
+{
+    const auto& classes = GetFastPathClasses();
+    const auto entry = classes.find(className);
+    if (entry == classes.end() || !xrcObj->GetAttribute("name").empty())
+        return false;
+
+    const bool isItem = (className == "sizeritem" || className == "gbsizeritem");
+    bool hasObject = false;
+    wxString spacerSize;
+    for (ticpp::Element* child = xrcObj->FirstChildElement(false); child;
+         child = child->NextSiblingElement(false)) {
+        const std::string tag = child->Value();
+        if (tag == "object") {
+            hasObject = true;
+            continue;
+        }
+        const wxString text = child->GetText(false);
+        if (isItem && tag == "size") {
+            spacerSize = text;
+            continue;
+        }
+        const auto property = std::find_if(
+            entry->second.begin(), entry->second.end(),
+            [&tag](const XrcProperty& prop) { return tag == prop.xrcName; });
+        if (property == entry->second.end())
+            return false;
+
+        long first = 0, second = 0;
+        switch (property->type) {
+        case XrcValue::Integer:
+            if (!ParseInteger(text, &first))
+                return false;
+
+            values->emplace_back(property->name, wxString::Format("%ld", first));
+            break;
+        case XrcValue::BitList: {
+            wxString flags;
+            if (!ParseBitList(text, &flags))
+                return false;
+
+            values->emplace_back(property->name, flags);
+            break;
+        }
+        case XrcValue::Size:
+            if (!ParseIntegerPair(text, &first, &second))
+                return false;
+
+            values->emplace_back(property->name, text);
+            break;
+        case XrcValue::Text:
+            if (text.find_first_of("_\\") != wxString::npos)
+                return false;
+
+            values->emplace_back(property->name, text);
+            break;
+        case XrcValue::Pair:
+            if (!ParseIntegerPair(text, &first, &second))
+                return false;
+
+            values->emplace_back(property->name, wxString::Format("%ld", first));
+            values->emplace_back(property->secondName, wxString::Format("%ld", second));
+            break;
+        }
+    }
+    // An item without an object is a spacer
+    if (!spacerSize.empty() && !hasObject) {
+        long width = 0, height = 0;
+        if (!ParseIntegerPair(spacerSize, &width, &height))
+            return false;
+
+        spacerValues->emplace_back("width", wxString::Format("%ld", width));
+        spacerValues->emplace_back("height", wxString::Format("%ld", height));
+    }
+    return true;
+}
+
+PObjectBase XrcLoader::CreateFastObject(const std::string& className,
+                                        const PropertyValues& values,
+                                        PObjectBase parent)
+{
+    PObjectBase newobject = m_objDb->CreateObject(className, parent);
+    if (!newobject)
+        return PObjectBase();
+
+    // CreateObject may have wrapped the object into an item
+    PObjectBase object = newobject;
+    if (object->GetChildCount() > 0)
+        object = object->GetChild(0);
+
+    for (const auto& value : values) {
+        PProperty prop = object->GetProperty(value.first);
+        if (prop) {
+            prop->SetValue(value.second);
+        } else if (!value.second.empty()) {
+            wxLogError(
+                "The property named \"%s\" of class \"%s\" is not supported by this version of wxWeaver.\n"
+                "The property's value is: %s",
+                value.first, className.c_str(), value.second);
+        }
+    }
+    parent->AddChild(newobject);
+    newobject->SetParent(parent);
+    return newobject;
+}
@@ -23,6 +23,9 @@
 #include "rtti/database.h"
 #include <ticpp.h>
 
+#include <utility>
+#include <vector>
+
 /** XRC file import filter.
  */
 class XrcLoader {
@@ -34,6 +37,25 @@ public:
     void SetObjectDatabase(PObjectDatabase db) { m_objDb = db; }
 
 private:
+    typedef std::vector<std::pair<wxString, wxString>> PropertyValues;
+
     PObjectBase GetObject(ticpp::Element* xrcObj, PObjectBase parent);
+
+    /** Collects the property values of the common layout classes
+        straight from the XRC element, without asking the component for
+        an intermediate wxWeaver element.
+
+        @return false if the class is not handled or the element contains
+        anything needing the component import, e.g. escaped text.
+    */
+    bool GetFastPathValues(ticpp::Element* xrcObj, const std::string& className,
+                           PropertyValues* values, PropertyValues* spacerValues);
+
+    /** Creates an object of @a className below @a parent and sets its
+        properties, mirroring ObjectDatabase::CreateObject(ticpp::Element*).
+    */
+    PObjectBase CreateFastObject(const std::string& className,
+                                 const PropertyValues& values, PObjectBase parent);
+
     PObjectDatabase m_objDb;
 };
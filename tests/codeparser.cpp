@@ -0,0 +1,321 @@
+/*
+    wxWeaver - A GUI Designer Editor for wxWidgets.
+    Copyright (C) 2021 Andrea Zanellato <redtid3@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include "testing.h"
+
+#include "codegen/codeparser.h"
+#include "utils/fileutils.h"
+
+#include <wx/filename.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+/** The parser of the inherited class sources as it was before it was made
+    linear, kept to check the results are unchanged.
+
+    It gives up after 100 functions or 100 brackets in a function, the
+    samples stay within these limits.
+*/
+class LegacyParser {
+public:
+    explicit LegacyParser(const wxString& className)
+        : m_className(className)
+    {
+    }
+
+    void ParseCCode(wxString header, wxString source)
+    {
+        ParseCInclude(header);
+        ParseCClass(header);
+        ParseSourceFunctions(source);
+    }
+
+    wxString m_className;
+    wxString m_userInclude;
+    wxString m_userMembers;
+    wxString m_trailingCode;
+    std::map<std::string, Function> m_functions;
+
+private:
+    void ParseCInclude(wxString code)
+    {
+        int userIncludeEnd;
+        m_userInclude = "";
+
+        // find the beginning of the user include
+        int userIncludeStart = code.Find("//// end generated include");
+        if (userIncludeStart != wxNOT_FOUND) {
+            userIncludeStart = code.find('\n', userIncludeStart);
+            if (userIncludeStart != wxNOT_FOUND) {
+                // find the end of the user include
+                userIncludeEnd = code.find("\n/** Implementing ", userIncludeStart);
+
+                if (userIncludeEnd != wxNOT_FOUND) {
+                    userIncludeStart++;
+                    m_userInclude = code.substr(userIncludeStart,
+                                                userIncludeEnd - userIncludeStart);
+                }
+            }
+        }
+    }
+
+    void ParseCClass(wxString code)
+    {
+        int startClass = code.Find("class " + m_className);
+        if (startClass != wxNOT_FOUND) {
+            code = ParseBrackets(code, startClass);
+            if (startClass != wxNOT_FOUND)
+                ParseCUserMembers(code);
+        }
+    }
+
+    void ParseCUserMembers(wxString code)
+    {
+        m_userMembers = "";
+        int userMembersStart = code.Find("//// end generated class members");
+        if (userMembersStart != wxNOT_FOUND) {
+            userMembersStart = code.find('\n', userMembersStart);
+            if (userMembersStart == wxNOT_FOUND) {
+                m_userMembers = "";
+            } else {
+                userMembersStart++;
+                if (userMembersStart < (int)code.Len())
+                    m_userMembers = code.Mid(userMembersStart);
+            }
+        }
+    }
+
+    void ParseSourceFunctions(wxString code)
+    {
+        int functionStart = 0;
+        int functionEnd = 0;
+        int previousFunctionEnd = 0;
+        wxString Str;
+
+        int loop = 0;
+        while (1) {
+            // find the beginning of the function name
+            Str = m_className + "::";
+            functionStart = code.find(Str, previousFunctionEnd);
+            if (functionStart == wxNOT_FOUND) {
+                // Get the last bit of remaining code after the last function in the file
+                m_trailingCode = code.Mid(previousFunctionEnd);
+                m_trailingCode.RemoveLast();
+                return;
+            }
+            // found a function now create a new function class
+            Function func;
+
+            // find the beginning of the line on which the function name resides
+            functionStart = code.rfind('\n', functionStart);
+            func.SetDocumentation(code.Mid(previousFunctionEnd,
+                                           functionStart - previousFunctionEnd));
+            functionStart++;
+
+            functionEnd = code.find('{', functionStart);
+            wxString heading = code.Mid(functionStart, functionEnd - functionStart);
+            if (heading.Right(1) == '\n')
+                heading.RemoveLast();
+
+            func.SetHeading(heading);
+
+            // find the opening brackets of the function
+            func.SetContents(ParseBrackets(code, functionStart));
+            if (functionStart != wxNOT_FOUND) {
+                functionEnd = functionStart;
+            } else {
+                code.insert(functionEnd + 1,
+                            "//The Following Block is missing a closing bracket\n//and has been "
+                            "set aside by wxWeaver\n");
+                func.SetContents("");
+            }
+            m_functions[std::string(RemoveWhiteSpace(heading).ToUTF8())] = func;
+            previousFunctionEnd = functionEnd;
+            if (loop == 100)
+                return;
+
+            loop++;
+        }
+    }
+
+    wxString ParseBrackets(wxString code, int& functionStart)
+    {
+        int openingBrackets = 0;
+        int closingBrackets = 0;
+        int index = 0;
+        wxString Str;
+
+        int functionLength = 0;
+        index = code.find('{', functionStart);
+        if (index != wxNOT_FOUND) {
+            openingBrackets++;
+            index++;
+            functionStart = index;
+            int loop = 0;
+            while (openingBrackets > closingBrackets) {
+                index = code.find_first_of("{}", index);
+                if (index == wxNOT_FOUND) {
+                    Str = code.Mid(functionStart, index);
+                    functionStart = index;
+                    return Str;
+                }
+                if (code.GetChar(index) == '{') {
+                    index++;
+                    openingBrackets++;
+                } else {
+                    index++;
+                    closingBrackets++;
+                }
+                if (loop == 100)
+                    return "";
+
+                loop++;
+            }
+            index--;
+            functionLength = index - functionStart;
+        }
+        Str = code.Mid(functionStart, functionLength);
+        functionStart = functionStart + functionLength + 1;
+        return Str;
+    }
+};
+
+/** Gives access to the functions found by the parser.
+*/
+class TestParser : public CCodeParser {
+public:
+    using CCodeParser::m_functions;
+
+    void SetClassName(const wxString& className) { m_className = className; }
+};
+
+wxString ReadSource(const wxString& file)
+{
+    std::vector<char> data;
+    wxWEAVER_CHECK(FileUtils::ReadFile(file, &data));
+    return wxString::FromUTF8(data.data(), data.size());
+}
+
+void CheckSame(const wxString& name, const wxString& className, const wxString& header,
+               const wxString& source)
+{
+    LegacyParser legacy(className);
+    legacy.ParseCCode(header, source);
+
+    TestParser parser;
+    parser.SetClassName(className);
+    parser.ParseCCode(header, source);
+
+    wxWEAVER_CHECK_EQUAL(name + ": " + parser.GetUserIncludes(), name + ": " + legacy.m_userInclude);
+    wxWEAVER_CHECK_EQUAL(name + ": " + parser.GetUserMembers(), name + ": " + legacy.m_userMembers);
+    wxWEAVER_CHECK_EQUAL(name + ": " + parser.GetTrailingCode(), name + ": " + legacy.m_trailingCode);
+    wxWEAVER_CHECK_EQUAL(parser.m_functions.size(), legacy.m_functions.size());
+    for (auto& function : legacy.m_functions) {
+        const auto found = parser.m_functions.find(function.first);
+        wxWEAVER_CHECK(found != parser.m_functions.end());
+        if (found == parser.m_functions.end())
+            continue;
+
+        Function* parsed = found->second;
+        wxWEAVER_CHECK_EQUAL(parsed->GetHeading(), function.second.GetHeading());
+        wxWEAVER_CHECK_EQUAL(parsed->GetDocumentation(), function.second.GetDocumentation());
+        wxWEAVER_CHECK_EQUAL(parsed->GetContents(), function.second.GetContents());
+    }
+}
+} // namespace
+
+wxWEAVER_TEST(CodeParserMatchesLegacy)
+{
+    const wxString header = "#ifndef __MyFrame__\n"
+                            "#define __MyFrame__\n"
+                            "\n"
+                            "#include \"MyProjectBase.h\"\n"
+                            "\n"
+                            "//// end generated include\n"
+                            "#include <vector>\n"
+                            "\n"
+                            "/** Implementing MyFrameBase */\n"
+                            "class MyFrame : public MyFrameBase\n"
+                            "{\n"
+                            "protected:\n"
+                            "    void OnClose( wxCloseEvent& event );\n"
+                            "public:\n"
+                            "    MyFrame( wxWindow* parent );\n"
+                            "//// end generated class members\n"
+                            "    int Count() const;\n"
+                            "private:\n"
+                            "    std::vector<int> m_values;\n"
+                            "};\n"
+                            "\n"
+                            "#endif // __MyFrame__\n";
+    const wxString source = "#include \"MyFrame.h\"\n"
+                            "\n"
+                            "MyFrame::MyFrame( wxWindow* parent )\n"
+                            ":\n"
+                            "MyFrameBase( parent )\n"
+                            "{\n"
+                            "\n"
+                            "}\n"
+                            "\n"
+                            "void MyFrame::OnClose( wxCloseEvent& event )\n"
+                            "{\n"
+                            "// TODO: Implement OnClose\n"
+                            "    if (event.CanVeto()) {\n"
+                            "        event.Veto();\n"
+                            "    }\n"
+                            "}\n"
+                            "\n"
+                            "/** Counts the values.\n"
+                            "*/\n"
+                            "int MyFrame::Count() const\n"
+                            "{\n"
+                            "    int values[] = { 1, 2, 3 };\n"
+                            "    auto count = [&]() { return sizeof(values) / sizeof(values[0]); };\n"
+                            "    return static_cast<int>(count());\n"
+                            "}\n"
+                            "\n"
+                            "// Code after the last function\n"
+                            "static int s_unused = 0;\n";
+    CheckSame("sample", "MyFrame", header, source);
+    CheckSame("no functions", "MyFrame", header, "#include \"MyFrame.h\"\n\nint f() { return 0; }\n");
+    CheckSame("empty", "MyFrame", wxEmptyString, wxEmptyString);
+
+    // Real sources, read without the line ending conversions of ParseCFiles()
+    const wxString sourceDir = Testing::GetSourceDir() + wxFILE_SEP_PATH;
+    const wxString dialogDir = sourceDir + "src/gui/dialogs/";
+    CheckSame("geninhertclass", "GenInheritedClassDlg",
+              ReadSource(dialogDir + "geninheritclass/geninhertclass.h"),
+              ReadSource(dialogDir + "geninheritclass/geninhertclass.cpp"));
+    CheckSame("annoying", "AnnoyingDialog", ReadSource(dialogDir + "annoying.h"),
+              ReadSource(dialogDir + "annoying.cpp"));
+}
+
+wxWEAVER_TEST(CodeParserProgress)
+{
+    // A bracket before the name on the same line used to restart the search
+    // from before the name, finding the same function forever
+    TestParser parser;
+    parser.SetClassName("Foo");
+    parser.ParseCCode(wxEmptyString, "\nint v{0}; Foo::f()\n{\n    return;\n}\nint w{1}; Foo::g()\n");
+
+    wxWEAVER_CHECK_EQUAL(parser.m_functions.size(), 2u);
+    wxWEAVER_CHECK_EQUAL(parser.GetFunctionContents("int v{0}; Foo::f()"), wxString("    return;"));
+}
@@ -0,0 +1,138 @@
+/*
+    wxWeaver - A GUI Designer Editor for wxWidgets.
+    Copyright (C) 2021 Andrea Zanellato <redtid3@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include "testing.h"
+
+#include "rtti/database.h"
+#include "utils/exception.h"
+#include "utils/stringutils.h"
+#include "utils/typeconv.h"
+#include "appdata.h"
+
+#include <wx/app.h>
+#include <wx/image.h>
+#include <wx/log.h>
+
+#include <ticpp.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+
+namespace {
+wxString s_dataDir;
+wxString s_sourceDir;
+size_t s_failures = 0;
+bool s_initialized = false;
+
+std::map<std::string, Testing::TestFunction>& GetTests()
+{
+    static std::map<std::string, Testing::TestFunction> tests;
+    return tests;
+}
+
+/** Runs the tests without the GUI toolkit, so no display is needed.
+*/
+class TestApp : public wxAppConsole {
+public:
+    int OnRun() override
+    {
+        if (argc < 4) {
+            std::cerr << "Usage: wxweaver_tests <test> <data dir> <source dir>\n";
+            return EXIT_FAILURE;
+        }
+        const auto test = GetTests().find(argv[1].ToStdString());
+        if (test == GetTests().end()) {
+            std::cerr << "Unknown test: " << argv[1] << '\n';
+            return EXIT_FAILURE;
+        }
+        s_dataDir = argv[2];
+        s_sourceDir = argv[3];
+        try {
+            test->second();
+        } catch (wxWeaverException& ex) {
+            Testing::Fail(__FILE__, __LINE__, wxString("Exception: ") << ex.what());
+        }
+        wxLog::FlushActive();
+        return s_failures ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    int OnExit() override
+    {
+        if (s_initialized) {
+            MacroDictionary::Destroy();
+            AppDataDestroy();
+        }
+        return wxAppConsole::OnExit();
+    }
+};
+} // namespace
+
+bool Testing::Register(const char* name, TestFunction test)
+{
+    return GetTests().emplace(name, test).second;
+}
+
+void Testing::Fail(const char* file, int line, const wxString& message)
+{
+    std::cerr << file << ':' << line << ": " << message << '\n';
+    ++s_failures;
+}
+
+wxString Testing::GetDataDir()
+{
+    return s_dataDir;
+}
+
+wxString Testing::GetSourceDir()
+{
+    return s_sourceDir;
+}
+
+bool Testing::InitHeadless()
+{
+    if (s_initialized)
+        return true;
+
+    wxInitAllImageHandlers();
+    AppDataCreate(s_dataDir);
+    s_initialized = true;
+    try {
+        AppDataInitHeadless();
+    } catch (wxWeaverException& ex) {
+        Fail(__FILE__, __LINE__, wxString("Unable to load the plugins: ") << ex.what());
+        return false;
+    }
+    return true;
+}
+
+PObjectBase Testing::LoadXMLProject(const wxString& file)
+{
+    ticpp::Document doc;
+    XMLUtils::LoadXMLFile(doc, false, file);
+
+    ticpp::Element* object = doc.FirstChildElement()->FirstChildElement("object");
+    return AppData()->GetObjectDatabase()->CreateObject(object);
+}
+
+int main(int argc, char** argv)
+{
+    wxApp::SetInstance(new TestApp);
+    return wxEntry(argc, argv);
+}
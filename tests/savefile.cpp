@@ -0,0 +1,113 @@
+/*
+    wxWeaver - A GUI Designer Editor for wxWidgets.
+    Copyright (C) 2021 Andrea Zanellato <redtid3@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include "testing.h"
+
+#include "rtti/objectbase.h"
+#include "utils/fileutils.h"
+#include "utils/stringutils.h"
+
+#include <wx/dir.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+
+#include <ticpp.h>
+
+#include <vector>
+
+#ifdef __UNIX__
+#include <sys/stat.h>
+#endif
+
+namespace {
+std::vector<char> ReadAll(const wxString& file)
+{
+    std::vector<char> data;
+    wxWEAVER_CHECK(FileUtils::ReadFile(file, &data));
+    return data;
+}
+
+/** Saves @a file as SaveProject() does and as ticpp::Document::SaveFile(),
+    used before, did, the bytes must be the same.
+*/
+void CheckSavedFile(const wxString& file)
+{
+    PObjectBase project = Testing::LoadXMLProject(file);
+    wxWEAVER_CHECK(project);
+    if (!project)
+        return;
+
+    ticpp::Document doc;
+    project->Serialize(&doc);
+
+    const wxString baselineFile = wxFileName::CreateTempFileName("wxweaver");
+    doc.SaveFile(std::string(baselineFile.mb_str(wxConvFile)));
+    const std::vector<char> baseline = ReadAll(baselineFile);
+    wxRemoveFile(baselineFile);
+
+    const wxString savedFile = wxFileName::CreateTempFileName("wxweaver");
+    wxWEAVER_CHECK(FileUtils::WriteFileAtomically(XMLUtils::PrintDocument(doc), savedFile));
+    const std::vector<char> saved = ReadAll(savedFile);
+    wxRemoveFile(savedFile);
+
+    wxWEAVER_CHECK_EQUAL(saved.size(), baseline.size());
+    size_t offset = 0;
+    while (offset < saved.size() && offset < baseline.size()
+           && saved[offset] == baseline[offset])
+        ++offset;
+
+    wxWEAVER_CHECK_EQUAL(wxString() << wxFileName(file).GetFullName()
+                                    << ": first difference at " << offset,
+                         wxString() << wxFileName(file).GetFullName()
+                                    << ": first difference at " << baseline.size());
+}
+} // namespace
+
+wxWEAVER_TEST(SaveFileByteIdentical)
+{
+    if (!Testing::InitHeadless())
+        return;
+
+    const wxString sourceDir = Testing::GetSourceDir() + wxFILE_SEP_PATH;
+    CheckSavedFile(sourceDir + "resources/EditorsPrefs.fbp");
+    CheckSavedFile(sourceDir + "src/gui/dialogs/geninheritclass/GenInheritedDlg.fbp");
+}
+
+wxWEAVER_TEST(WriteFileAtomically)
+{
+    const wxString file = wxFileName::CreateTempFileName("wxweaver");
+    wxWEAVER_CHECK(FileUtils::WriteFileAtomically(std::string("old"), file));
+#ifdef __UNIX__
+    wxWEAVER_CHECK(chmod(file.fn_str(), 0640) == 0);
+#endif
+    wxWEAVER_CHECK(FileUtils::WriteFileAtomically(std::string("new contents"), file));
+
+    const std::vector<char> data = ReadAll(file);
+    wxWEAVER_CHECK_EQUAL(std::string(data.begin(), data.end()), std::string("new contents"));
+#ifdef __UNIX__
+    struct stat status;
+    wxWEAVER_CHECK(stat(file.fn_str(), &status) == 0);
+    wxWEAVER_CHECK_EQUAL(status.st_mode & 07777, 0640u);
+#endif
+    // No temporary file is left behind
+    wxArrayString files;
+    wxDir::GetAllFiles(wxPathOnly(file), &files, wxFileName(file).GetFullName() + ".*",
+                       wxDIR_FILES);
+    wxWEAVER_CHECK_EQUAL(files.size(), 0u);
+    wxRemoveFile(file);
+}
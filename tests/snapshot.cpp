@@ -0,0 +1,102 @@
+/*
+    wxWeaver - A GUI Designer Editor for wxWidgets.
+    Copyright (C) 2021 Andrea Zanellato <redtid3@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include "testing.h"
+
+#include "rtti/database.h"
+#include "rtti/objectbase.h"
+#include "rtti/snapshot.h"
+#include "appdata.h"
+
+#include <wx/filefn.h>
+#include <wx/filename.h>
+
+#include <algorithm>
+
+namespace {
+void CompareObjects(PObjectBase expected, PObjectBase actual, const wxString& path)
+{
+    wxWEAVER_CHECK_EQUAL(actual->GetClassName(), expected->GetClassName());
+    if (actual->GetClassName() != expected->GetClassName())
+        return;
+
+    wxWEAVER_CHECK_EQUAL(actual->GetPropertyCount(), expected->GetPropertyCount());
+    for (size_t i = 0; i < expected->GetPropertyCount(); ++i) {
+        PProperty expectedProperty = expected->GetProperty(i);
+        PProperty actualProperty = actual->GetProperty(expectedProperty->GetName());
+        wxWEAVER_CHECK(actualProperty);
+        if (actualProperty) {
+            wxWEAVER_CHECK_EQUAL(path + "/" + actualProperty->GetName() + "="
+                                     + actualProperty->GetValueAsString(),
+                                 path + "/" + expectedProperty->GetName() + "="
+                                     + expectedProperty->GetValueAsString());
+        }
+    }
+    wxWEAVER_CHECK_EQUAL(actual->GetEventCount(), expected->GetEventCount());
+    for (size_t i = 0; i < expected->GetEventCount(); ++i) {
+        PEvent expectedEvent = expected->GetEvent(i);
+        PEvent actualEvent = actual->GetEvent(expectedEvent->GetName());
+        wxWEAVER_CHECK(actualEvent);
+        if (actualEvent) {
+            wxWEAVER_CHECK_EQUAL(path + "/" + actualEvent->GetName() + "="
+                                     + actualEvent->GetValue(),
+                                 path + "/" + expectedEvent->GetName() + "="
+                                     + expectedEvent->GetValue());
+        }
+    }
+    wxWEAVER_CHECK_EQUAL(actual->GetChildCount(), expected->GetChildCount());
+    const size_t childCount = std::min(actual->GetChildCount(), expected->GetChildCount());
+    for (size_t i = 0; i < childCount; ++i) {
+        PObjectBase expectedChild = expected->GetChild(i);
+        CompareObjects(expectedChild, actual->GetChild(i),
+                       wxString(path) << "/" << expectedChild->GetClassName()
+                                       << "[" << i << "]");
+    }
+}
+
+void CheckRoundTrip(const wxString& file)
+{
+    PObjectBase project = Testing::LoadXMLProject(file);
+    wxWEAVER_CHECK(project);
+    if (!project)
+        return;
+
+    const wxString snapshotFile = wxFileName::CreateTempFileName("wxweaver");
+    wxWEAVER_CHECK(ProjectSnapshot::WriteFile(ProjectSnapshot::Serialize(project),
+                                              snapshotFile));
+    wxWEAVER_CHECK(ProjectSnapshot::IsSnapshotFile(snapshotFile));
+
+    PObjectBase loaded
+        = ProjectSnapshot::Load(AppData()->GetObjectDatabase(), snapshotFile);
+    wxRemoveFile(snapshotFile);
+
+    wxWEAVER_CHECK(loaded);
+    if (loaded)
+        CompareObjects(project, loaded, wxFileName(file).GetFullName());
+}
+} // namespace
+
+wxWEAVER_TEST(SnapshotRoundTrip)
+{
+    if (!Testing::InitHeadless())
+        return;
+
+    const wxString sourceDir = Testing::GetSourceDir() + wxFILE_SEP_PATH;
+    CheckRoundTrip(sourceDir + "resources/EditorsPrefs.fbp");
+    CheckRoundTrip(sourceDir + "src/gui/dialogs/geninheritclass/GenInheritedDlg.fbp");
+}
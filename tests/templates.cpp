@@ -0,0 +1,54 @@
+/*
+    wxWeaver - A GUI Designer Editor for wxWidgets.
+    Copyright (C) 2021 Andrea Zanellato <redtid3@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include "testing.h"
+
+#include "codegen/cppcg.h"
+#include "rtti/database.h"
+#include "rtti/objectbase.h"
+#include "appdata.h"
+
+namespace {
+wxString Expand(PObjectBase object, const wxString& text)
+{
+    CppTemplateParser parser(object, text, false, false, wxEmptyString);
+    return parser.ParseTemplate();
+}
+} // namespace
+
+wxWEAVER_TEST(TemplateNested)
+{
+    if (!Testing::InitHeadless())
+        return;
+
+    // The name of a new project is "MyProject", its file is empty
+    PObjectBase project = AppData()->GetObjectDatabase()->CreateObject("Project");
+    wxWEAVER_CHECK(project);
+    if (!project)
+        return;
+
+    // Inner templates are compiled from their own range of the source
+    wxWEAVER_CHECK_EQUAL(Expand(project, "[#ifnotnull $name @{(#ifnotnull $name @{<$name>@})@}]"),
+                         wxString("[(<MyProject>)]"));
+    wxWEAVER_CHECK_EQUAL(
+        Expand(project,
+               "#ifnotnull $name @{#ifnull $file @{#ifnotnull $first_id @{$first_id@}@}@}"),
+        wxString("1000"));
+    wxWEAVER_CHECK_EQUAL(Expand(project, "#ifnull $name @{<#ifnull $file @{$name@}>@}after"),
+                         wxString("after"));
+}
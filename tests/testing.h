@@ -0,0 +1,78 @@
+/*
+    wxWeaver - A GUI Designer Editor for wxWidgets.
+    Copyright (C) 2021 Andrea Zanellato <redtid3@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#pragma once
+
+#include "utils/defs.h"
+
+#include <wx/string.h>
+
+/** Minimal test runner: every test is a function registered by name,
+    tests/main.cpp runs the one named on the command line.
+*/
+namespace Testing {
+typedef void (*TestFunction)();
+
+/** Registers @a test, use the wxWEAVER_TEST macro instead.
+*/
+bool Register(const char* name, TestFunction test);
+
+/** Records a failed check, the test goes on with the next one.
+*/
+void Fail(const char* file, int line, const wxString& message);
+
+/** Gets the application data directory, as the plugins are loaded from it.
+*/
+wxString GetDataDir();
+
+/** Gets the root directory of the sources, for the test data.
+*/
+wxString GetSourceDir();
+
+/** Loads the plugins and the object database without bitmaps,
+    like the command line operations.
+*/
+bool InitHeadless();
+
+/** Loads a project of the current file format as
+    ApplicationData::LoadProject() does, bypassing the binary cache.
+*/
+PObjectBase LoadXMLProject(const wxString& file);
+} // namespace Testing
+
+#define wxWEAVER_TEST(name)                                                    \
+    static void Test##name();                                                  \
+    static const bool s_registered##name = Testing::Register(#name, Test##name); \
+    static void Test##name()
+
+#define wxWEAVER_CHECK(condition)                                              \
+    do {                                                                       \
+        if (!(condition))                                                      \
+            Testing::Fail(__FILE__, __LINE__, #condition);                     \
+    } while (false)
+
+#define wxWEAVER_CHECK_EQUAL(actual, expected)                                 \
+    do {                                                                       \
+        const auto& actualValue = (actual);                                    \
+        const auto& expectedValue = (expected);                                \
+        if (!(actualValue == expectedValue)) {                                 \
+            Testing::Fail(__FILE__, __LINE__,                                  \
+                          wxString() << #actual << " is \"" << actualValue     \
+                                     << "\", expected \"" << expectedValue << "\""); \
+        }                                                                      \
+    } while (false)
@@ -0,0 +1,49 @@
+/*
+    wxWeaver - A GUI Designer Editor for wxWidgets.
+    Copyright (C) 2021 Andrea Zanellato <redtid3@gmail.com>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+#include "testing.h"
+
+#include "utils/typeconv.h"
+
+wxWEAVER_TEST(FontCodeNames)
+{
+    // The names used by the generated code, as wxFont gives them
+    const wxFontContainer font = TypeConv::StringToFont(
+        wxString::Format("Sans,%d,%d,10,%d,1", static_cast<int>(wxFONTSTYLE_ITALIC),
+                         static_cast<int>(wxFONTWEIGHT_BOLD),
+                         static_cast<int>(wxFONTFAMILY_SWISS)));
+    wxWEAVER_CHECK_EQUAL(TypeConv::FontStyleToString(font.GetStyle()),
+                         wxString("wxFONTSTYLE_ITALIC"));
+    wxWEAVER_CHECK_EQUAL(TypeConv::FontWeightToString(font.GetWeight()),
+                         wxString("wxFONTWEIGHT_BOLD"));
+    wxWEAVER_CHECK_EQUAL(TypeConv::FontFamilyToString(font.GetFamily()),
+                         wxString("wxFONTFAMILY_SWISS"));
+
+    wxWEAVER_CHECK_EQUAL(TypeConv::FontStyleToString(wxFONTSTYLE_SLANT),
+                         wxString("wxFONTSTYLE_SLANT"));
+    wxWEAVER_CHECK_EQUAL(TypeConv::FontWeightToString(wxFONTWEIGHT_NORMAL),
+                         wxString("wxFONTWEIGHT_NORMAL"));
+    wxWEAVER_CHECK_EQUAL(TypeConv::FontWeightToString(wxFONTWEIGHT_LIGHT),
+                         wxString("wxFONTWEIGHT_LIGHT"));
+#if wxCHECK_VERSION(3, 1, 2)
+    wxWEAVER_CHECK_EQUAL(TypeConv::FontWeightToString(wxFONTWEIGHT_SEMIBOLD),
+                         wxString("wxFONTWEIGHT_SEMIBOLD"));
+    wxWEAVER_CHECK_EQUAL(TypeConv::FontWeightToString(wxFONTWEIGHT_EXTRAHEAVY),
+                         wxString("wxFONTWEIGHT_EXTRAHEAVY"));
+#endif
+}